@@ -37,6 +37,7 @@
 #include <log4cplus/spi/filter.h>
 #include <log4cplus/helpers/lockfile.h>
 
+#include <chrono>
 #include <memory>
 #include <mutex>
 #include <atomic>
@@ -132,6 +133,19 @@ namespace log4cplus {
      * <dd>Set this property to <tt>true</tt> if you want all appends using
      * this appender to be done asynchronously. Default is <tt>false</tt>.</dd>
      *
+     * <dt><tt>LatencyBudget</tt></dt>
+     * <dd>Longest time in milliseconds an append may take and a thread
+     * may wait for this appender. When it is exceeded, the appender is
+     * degraded: events are passed to the fallback appender, or dropped
+     * if there is none, until the append in progress finishes. The
+     * default value 0 disables this. Ignored in single threaded
+     * builds.</dd>
+     *
+     * <dt><tt>FallbackAppender</tt></dt>
+     * <dd>Name of appender factory of the appender used while this
+     * appender is degraded. Its properties are under the
+     * <tt>FallbackAppender.</tt> subkey.</dd>
+     *
      * </dl>
      */
     class LOG4CPLUS_EXPORT Appender
@@ -190,6 +204,16 @@ namespace log4cplus {
          */
         void doAppend(const log4cplus::spi::InternalLoggingEvent& event);
 
+        /**
+         * Appends <code>count</code> events like doAppend() would, but
+         * checks the closed state and takes the appender's locks only once
+         * for the whole batch. Events accepted by the threshold and the
+         * filters are passed to appendBatch().
+         */
+        void doAppendBatch(
+            log4cplus::spi::InternalLoggingEvent const * const * events,
+            std::size_t count);
+
         /**
          * Get the name of this appender. The name uniquely identifies the
          * appender.
@@ -262,7 +286,7 @@ namespace log4cplus {
          * value of the <b>Threshold</b> option to a LogLevel
          * string, such as "DEBUG", "INFO" and so on.
          */
-        void setThreshold(LogLevel th) { threshold = th; }
+        void setThreshold(LogLevel th);
 
         /**
          * Check whether the message LogLevel is below the appender's
@@ -273,12 +297,75 @@ namespace log4cplus {
             return ((ll != NOT_SET_LOG_LEVEL) && (ll >= threshold));
         }
 
+        /**
+         * Returns the lowest LogLevel this appender might accept, taking
+         * into account its threshold and those of its filters whose
+         * decision depends only on the log level of the event.
+         * Returns the maximum value of LogLevel if this appender does
+         * not accept any event at all.
+         *
+         * The value is computed when the threshold, the filters or the
+         * layout change; this does not wait for an append in progress.
+         */
+        LogLevel getLowestAcceptedLogLevel() const;
+
+        /**
+         * Returns fingerprint of the layout of this appender, empty if it
+         * has none. Like getLowestAcceptedLogLevel(), it does not wait for
+         * an append in progress.
+         * \sa Layout::getFingerprint()
+         */
+        log4cplus::tstring getLayoutFingerprint() const;
+
+        /**
+         * Returns combination of
+         * spi::InternalLoggingEvent::ThreadSpecificData flags selecting
+         * the thread specific data this appender uses. Only those are
+         * captured when the event is appended asynchronously. The
+         * default implementation returns all of them.
+         */
+        virtual unsigned getRequiredThreadSpecificData() const;
+
         /**
          * This method waits for all events that are being asynchronously
          * logged to finish.
          */
         void waitToFinishAsyncLogging();
 
+        /**
+         * Sets the longest time an append may take and a thread may wait
+         * for this appender. When it is exceeded, the appender is degraded
+         * and events are passed to <code>fallback</code>, or dropped if it
+         * is empty, until the append in progress finishes. A watchdog on
+         * the housekeeping thread detects both the degradation and the
+         * recovery. Zero <code>budget</code> disables it. Only the thread
+         * stuck in the slow append waits longer than the budget. The
+         * budget can be changed while appending; appends in progress
+         * finish with the previous one.
+         */
+        void setLatencyBudget (std::chrono::milliseconds budget,
+            helpers::SharedObjectPtr<Appender> fallback
+                = helpers::SharedObjectPtr<Appender> ());
+
+        //! Counters of the latency budget watchdog.
+        struct LatencyStats
+        {
+            //! Appender is degraded now.
+            bool degraded;
+            //! Number of times the appender has been degraded.
+            unsigned long long degradations;
+            //! Events passed to the fallback appender.
+            unsigned long long diverted;
+            //! Events dropped while degraded without fallback appender.
+            unsigned long long dropped;
+        };
+
+        /**
+         * Returns counters of the latency budget watchdog. All of them
+         * are zero when no budget is set.
+         */
+        LatencyStats getLatencyStats() const;
+
     protected:
       // Methods
         /**
@@ -288,9 +375,54 @@ namespace log4cplus {
          */
         virtual void append(const log4cplus::spi::InternalLoggingEvent& event) = 0;
 
+        /**
+         * Appends batch of events which passed the threshold and the
+         * filters. The default implementation calls append() for each of
+         * them.
+         */
+        virtual void appendBatch(
+            log4cplus::spi::InternalLoggingEvent const * const * events,
+            std::size_t count);
+
+        /**
+         * Format the event using this appender's layout into per thread
+         * buffer and return it.
+         */
         tstring & formatEvent (const log4cplus::spi::InternalLoggingEvent& event) const;
 
+        /**
+         * Format the event using this appender's layout into
+         * <code>output</code>. When the event is being dispatched to
+         * multiple appenders, the formatted text is produced only once
+         * for all appenders with layouts with the same fingerprint.
+         * \sa Layout::getFingerprint()
+         */
+        void formatAndAppend (log4cplus::tostream & output,
+            const log4cplus::spi::InternalLoggingEvent& event) const;
+
+        /**
+         * Returns thread specific data required by the layout and the
+         * filter chain of this appender. Appenders which do not use the
+         * event except through them return this from
+         * getRequiredThreadSpecificData(). Like
+         * getLowestAcceptedLogLevel(), it does not wait for an append in
+         * progress.
+         */
+        unsigned getLayoutRequiredThreadSpecificData() const;
+
+#if ! defined (LOG4CPLUS_SINGLE_THREADED)
+        /**
+         * Returns value of getRequiredThreadSpecificData() cached until
+         * appender configuration changes.
+         */
+        unsigned getCachedRequiredThreadSpecificData() const;
+#endif
+
       // Data
+        //
+        // Call publishConfig() after writing layout, threshold or filter
+        // directly.
+
         /** The layout variable does not need to be set if the appender
          *  implementation has its own layout. */
         std::unique_ptr<Layout> layout;
@@ -321,14 +453,65 @@ namespace log4cplus {
         std::atomic<std::size_t> in_flight;
         std::mutex in_flight_mutex;
         std::condition_variable in_flight_condition;
+
+        //! Cached getRequiredThreadSpecificData() in lower half and
+        //! appender configuration generation in upper half.
+        mutable std::atomic<unsigned long long> requiredThreadSpecificData;
 #endif
 
         /** Is this appender closed? */
         bool closed;
 
+        /**
+         * Recomputes values of getLowestAcceptedLogLevel(),
+         * getLayoutRequiredThreadSpecificData() and
+         * getLayoutFingerprint() and bumps appender
+         * configuration generation, so that loggers pick up the change.
+         * setLayout(), setFilter(), addFilter() and setThreshold() call
+         * it. Derived classes which write <code>layout</code>,
+         * <code>filter</code> or <code>threshold</code> directly have to
+         * call it afterwards.
+         */
+        void publishConfig();
+
     private:
+
+        //! Serializes changes of the threshold, the filters and the layout
+        //! with publishConfig(). It is never held while appending; when
+        //! both are needed, it is locked after <code>access_mutex</code>.
+        mutable thread::Mutex config_mutex;
+
+        //! Value of getLowestAcceptedLogLevel().
+        std::atomic<LogLevel> lowestAcceptedLogLevel;
+
+        //! Value of getLayoutRequiredThreadSpecificData().
+        std::atomic<unsigned> layoutRequiredThreadSpecificData;
+
+        //! Value of getLayoutFingerprint(), guarded by
+        //! <code>config_mutex</code>.
+        log4cplus::tstring layoutFingerprint;
+
 #if ! defined (LOG4CPLUS_SINGLE_THREADED)
         void subtract_in_flight();
+
+        struct LatencyWatchdog;
+
+        //! Locks <code>access_mutex</code> into <code>guard</code> for
+        //! appending. With latency budget set, it waits at most the budget
+        //! of <code>wd</code> and fails while the appender is degraded.
+        bool lockForAppend (thread::MutexGuard & guard, LatencyWatchdog * wd);
+
+        //! Passes event to fallback appender or drops it.
+        void divertEvent (const log4cplus::spi::InternalLoggingEvent& event,
+            LatencyWatchdog & wd);
+
+        //! Watchdog task checking the append in progress.
+        void checkLatency (LatencyWatchdog & wd);
+
+        //! Latency budget watchdog, accessed with std::atomic_load() and
+        //! std::atomic_store(). Appends keep the watchdog they started
+        //! with, so setLatencyBudget() can replace it at any time.
+        std::shared_ptr<LatencyWatchdog> watchdog;
 #endif
     };
 
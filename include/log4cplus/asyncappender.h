@@ -48,6 +48,7 @@
 #include <log4cplus/appender.h>
 #include <log4cplus/thread/threads.h>
 #include <log4cplus/helpers/appenderattachableimpl.h>
+#include <atomic>
 
 
 namespace log4cplus
@@ -72,14 +73,25 @@ public:
 
     virtual void close ();
 
+    //! Returns the union of thread specific data required by the
+    //! attached appenders.
+    virtual unsigned getRequiredThreadSpecificData () const;
+
 protected:
     virtual void append (spi::InternalLoggingEvent const &);
 
     void init_queue_thread (unsigned);
 
+    //! Returns memory budget still held by events that have not been
+    //! appended by the queue thread. The thread must not be running.
+    void release_queued_bytes ();
+
     thread::AbstractThreadPtr queue_thread;
     thread::QueuePtr queue;
 
+    //! Bytes of memory budget held by events in the queue.
+    std::atomic<std::size_t> queued_bytes {0};
+
 private:
     AsyncAppender (AsyncAppender const &);
     AsyncAppender & operator = (AsyncAppender const &);
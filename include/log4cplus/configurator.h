@@ -113,6 +113,15 @@ namespace log4cplus
         static void doConfigure(const log4cplus::tstring& configFilename,
             Hierarchy& h = Logger::getDefaultHierarchy(), unsigned flags = 0);
 
+        /**
+         * Replaces configuration of <code>h</code> with configuration read
+         * from <code>configFilename</code>. The configuration is built in
+         * a scratch Hierarchy while logging continues with the old one and
+         * is then published with Hierarchy::publishConfiguration().
+         */
+        static void doStagedConfigure(const log4cplus::tstring& configFilename,
+            Hierarchy& h = Logger::getDefaultHierarchy(), unsigned flags = 0);
+
         /**
          * Read configuration from a file. <b>The existing configuration is
          * not cleared nor reset.</b> If you require a different behavior,
@@ -192,6 +201,13 @@ namespace log4cplus
          * additivity rule</a> in the user manual for the meaning of the
          * <code>additivity</code> flag.
          *
+         * Messages longer than
+         * <code>log4cplus.maxMessageSize.logger_name</code> characters are
+         * truncated when they are logged through the named logger or its
+         * descendants. <code>log4cplus.maxMessageSize</code> sets the limit
+         * of the root logger and thus the global default. See
+         * Logger::setMaxMessageSize().
+         *
          * The user can override any of the {@link
          * Hierarchy#disable} family of methods by setting the a key
          * "log4cplus.disableOverride" to <code>true</code> or any value other
@@ -202,6 +218,18 @@ namespace log4cplus
          * Property <pre>log4cplus.threadPoolSize</pre> can be used to adjust
          * size of log4cplus' internal thread pool.
          *
+         * Property <pre>log4cplus.memoryBudget</pre> limits the number of
+         * bytes held by all queued events and file buffers together (see
+         * helpers::MemoryBudget). Events that do not fit into the budget
+         * are appended synchronously. Setting
+         * <code>log4cplus.memoryBudget.ThreadPoolQueue</code> or
+         * <code>log4cplus.memoryBudget.AsyncAppenderQueue</code> to
+         * <code>Discard</code> makes the respective queue discard them
+         * instead. File buffers that do not fit are not allocated. The
+         * budget is left unchanged by configurations that set none of
+         * these properties; otherwise policies which are not set revert
+         * to <code>Sync</code>.
+         *
          * <h3>Example</h3>
          *
          * An example configuration is given below.
@@ -292,6 +320,8 @@ namespace log4cplus
         void configureLogger(log4cplus::Logger logger, const log4cplus::tstring& config);
         void configureAppenders();
         void configureAdditivity();
+        void configureMaxMessageSize();
+        void configureMemoryBudget();
 
         virtual Logger getLogger(const log4cplus::tstring& name);
         virtual void addAppender(Logger &logger, log4cplus::SharedAppenderPtr& appender);
@@ -62,6 +62,7 @@ namespace log4cplus {
 
       // Methods
         virtual void close();
+        virtual unsigned getRequiredThreadSpecificData() const;
 
         //! This mutex is used by ConsoleAppender and helpers::LogLog
         //! classes to synchronize output to console.
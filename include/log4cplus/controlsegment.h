@@ -0,0 +1,154 @@
+// -*- C++ -*-
+//
+//  Copyright (C) 2026, Vaclav Zeman. All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without modifica-
+//  tion, are permitted provided that the following conditions are met:
+//
+//  1. Redistributions of  source code must  retain the above copyright  notice,
+//     this list of conditions and the following disclaimer.
+//
+//  2. Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//
+//  THIS SOFTWARE IS PROVIDED ``AS IS'' AND ANY EXPRESSED OR IMPLIED WARRANTIES,
+//  INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+//  FITNESS  FOR A PARTICULAR  PURPOSE ARE  DISCLAIMED.  IN NO  EVENT SHALL  THE
+//  APACHE SOFTWARE  FOUNDATION  OR ITS CONTRIBUTORS  BE LIABLE FOR  ANY DIRECT,
+//  INDIRECT, INCIDENTAL, SPECIAL,  EXEMPLARY, OR CONSEQUENTIAL  DAMAGES (INCLU-
+//  DING, BUT NOT LIMITED TO, PROCUREMENT  OF SUBSTITUTE GOODS OR SERVICES; LOSS
+//  OF USE, DATA, OR  PROFITS; OR BUSINESS  INTERRUPTION)  HOWEVER CAUSED AND ON
+//  ANY  THEORY OF LIABILITY,  WHETHER  IN CONTRACT,  STRICT LIABILITY,  OR TORT
+//  (INCLUDING  NEGLIGENCE OR  OTHERWISE) ARISING IN  ANY WAY OUT OF THE  USE OF
+//  THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+/** @file
+ * This header contains declaration of the shared memory control segment
+ * through which logger levels and appender thresholds of a running
+ * process can be changed by the log4cplus-ctl tool.
+ */
+
+#if ! defined (LOG4CPLUS_CONTROLSEGMENT_H)
+#define LOG4CPLUS_CONTROLSEGMENT_H
+
+#include <log4cplus/config.hxx>
+
+#if defined (LOG4CPLUS_HAVE_PRAGMA_ONCE)
+#pragma once
+#endif
+
+#include <log4cplus/tstring.h>
+#include <log4cplus/loglevel.h>
+#include <log4cplus/logger.h>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+
+namespace log4cplus {
+
+
+// Forward Declarations
+class ControlMapping;
+
+
+//! Shared memory control segment of this process.
+//!
+//! The segment is a small file mapped into memory, by default
+//! getDefaultPath() of this process, holding a fixed number of slots,
+//! each of which assigns a LogLevel to a logger or a threshold to the
+//! named appenders, and a generation counter bumped on every change.
+//! When created, the segment is filled with the log levels set on
+//! loggers and thresholds of appenders of the hierarchy. Changes made
+//! by ControlSegmentClient, usually from the log4cplus-ctl tool, are
+//! applied directly to the loggers and appenders by poll(), without
+//! reading any file and without resetting the configuration. poll()
+//! only compares the generation counter when nothing has changed.
+//!
+//! The segment is only supported on POSIX systems.
+class LOG4CPLUS_EXPORT ControlSegment
+{
+public:
+    //! Creates the segment at <code>path</code>, or at getDefaultPath()
+    //! of this process if it is empty, and unless <code>millis</code> is
+    //! zero, schedules poll() to run every <code>millis</code>
+    //! milliseconds on the housekeeping thread.
+    explicit ControlSegment (Hierarchy & h = Logger::getDefaultHierarchy (),
+        log4cplus::tstring const & path = log4cplus::tstring (),
+        unsigned int millis = 50);
+
+    //! Stops polling and removes the segment.
+    ~ControlSegment ();
+
+    //! \return True if the segment has been created successfully.
+    bool isOpen () const;
+
+    //! \return Path of the segment.
+    log4cplus::tstring const & getPath () const;
+
+    //! Applies changes made to the segment since the previous call.
+    //! \return Number of applied changes.
+    std::size_t poll ();
+
+    //! \return Default path of the segment of process <code>pid</code>.
+    static log4cplus::tstring getDefaultPath (unsigned long pid);
+
+private:
+    Hierarchy & hierarchy;
+    log4cplus::tstring path;
+    std::unique_ptr<ControlMapping> mapping;
+    unsigned long long pollTask;
+
+    ControlSegment (ControlSegment const &) = delete;
+    ControlSegment & operator = (ControlSegment const &) = delete;
+};
+
+
+//! Writer side of ControlSegment, used to change levels of another
+//! process.
+class LOG4CPLUS_EXPORT ControlSegmentClient
+{
+public:
+    //! One slot of the segment.
+    struct Entry
+    {
+        //! True for appender threshold, false for logger LogLevel.
+        bool appender;
+        log4cplus::tstring name;
+        LogLevel level;
+    };
+
+    //! Opens existing segment at <code>path</code>.
+    explicit ControlSegmentClient (log4cplus::tstring const & path);
+    ~ControlSegmentClient ();
+
+    //! \return True if the segment has been opened successfully.
+    bool isOpen () const;
+
+    //! Sets LogLevel of logger <code>name</code>. Use "root" for the
+    //! root logger and NOT_SET_LOG_LEVEL to make the logger inherit
+    //! LogLevel of its parent.
+    //! \return False if the segment is full or the name is too long.
+    bool setLoggerLevel (log4cplus::tstring const & name, LogLevel ll);
+
+    //! Sets threshold of all appenders named <code>name</code>.
+    //! \return False if the segment is full or the name is too long.
+    bool setAppenderThreshold (log4cplus::tstring const & name,
+        LogLevel ll);
+
+    //! \return Contents of all used slots.
+    std::vector<Entry> list () const;
+
+private:
+    std::unique_ptr<ControlMapping> mapping;
+
+    ControlSegmentClient (ControlSegmentClient const &) = delete;
+    ControlSegmentClient & operator = (ControlSegmentClient const &)
+        = delete;
+};
+
+
+} // namespace log4cplus
+
+#endif // LOG4CPLUS_CONTROLSEGMENT_H
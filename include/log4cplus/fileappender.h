@@ -118,6 +118,7 @@ namespace log4cplus
     public:
       // Methods
         virtual void close();
+        virtual unsigned getRequiredThreadSpecificData() const;
 
       //! Redefine default locale for output stream. It may be a good idea to
       //! provide UTF-8 locale in case UNICODE macro is defined.
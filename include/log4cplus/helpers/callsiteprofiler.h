@@ -0,0 +1,73 @@
+// -*- C++ -*-
+//
+//  Copyright (C) 2026, Vaclav Zeman. All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without modifica-
+//  tion, are permitted provided that the following conditions are met:
+//
+//  1. Redistributions of  source code must  retain the above copyright  notice,
+//     this list of conditions and the following disclaimer.
+//
+//  2. Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//
+//  THIS SOFTWARE IS PROVIDED ``AS IS'' AND ANY EXPRESSED OR IMPLIED WARRANTIES,
+//  INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+//  FITNESS  FOR A PARTICULAR  PURPOSE ARE  DISCLAIMED.  IN NO  EVENT SHALL  THE
+//  APACHE SOFTWARE  FOUNDATION  OR ITS CONTRIBUTORS  BE LIABLE FOR  ANY DIRECT,
+//  INDIRECT, INCIDENTAL, SPECIAL,  EXEMPLARY, OR CONSEQUENTIAL  DAMAGES (INCLU-
+//  DING, BUT NOT LIMITED TO, PROCUREMENT  OF SUBSTITUTE GOODS OR SERVICES; LOSS
+//  OF USE, DATA, OR  PROFITS; OR BUSINESS  INTERRUPTION)  HOWEVER CAUSED AND ON
+//  ANY  THEORY OF LIABILITY,  WHETHER  IN CONTRACT,  STRICT LIABILITY,  OR TORT
+//  (INCLUDING  NEGLIGENCE OR  OTHERWISE) ARISING IN  ANY WAY OUT OF THE  USE OF
+//  THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+/** @file
+ * This header contains declaration of functions controlling the callsite
+ * profiler, which is compiled in when LOG4CPLUS_ENABLE_CALLSITE_PROFILER
+ * is defined while building log4cplus.
+ */
+
+#if ! defined (LOG4CPLUS_HELPERS_CALLSITEPROFILER_H)
+#define LOG4CPLUS_HELPERS_CALLSITEPROFILER_H
+
+#include <log4cplus/config.hxx>
+
+#if defined (LOG4CPLUS_HAVE_PRAGMA_ONCE)
+#pragma once
+#endif
+
+#include <log4cplus/streams.h>
+#include <cstddef>
+
+
+namespace log4cplus::helpers {
+
+
+//! \return True if log4cplus has been built with the callsite profiler.
+LOG4CPLUS_EXPORT bool isCallsiteProfilerEnabled ();
+
+//! Discards all counters collected so far.
+LOG4CPLUS_EXPORT void resetCallsiteProfile ();
+
+//! Writes table of callsites of the logging macros into <code>os</code>,
+//! the most expensive first, limited to <code>max_rows</code> rows unless
+//! it is zero. Each row shows the number of events, bytes of their
+//! messages and ticks spent formatting them, i.e., building the message
+//! in the macro and formatting it by layouts of synchronous appenders.
+//! Callsites are identified by file and line, or by function and line
+//! if LOG4CPLUS_DISABLE_FILE_MACRO is defined.
+LOG4CPLUS_EXPORT void dumpCallsiteProfile (tostream & os,
+    std::size_t max_rows = 0);
+
+//! Makes signal <code>signum</code> write the callsite profile into
+//! std::cerr. The profile is written by the housekeeping thread shortly
+//! after the signal arrives.
+//! \return False if not supported by this build.
+LOG4CPLUS_EXPORT bool setCallsiteProfileSignal (int signum);
+
+
+} // namespace log4cplus::helpers
+
+#endif // LOG4CPLUS_HELPERS_CALLSITEPROFILER_H
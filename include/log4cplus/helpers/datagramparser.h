@@ -0,0 +1,95 @@
+// -*- C++ -*-
+//
+//  Copyright (C) 2026, Vaclav Zeman. All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without modifica-
+//  tion, are permitted provided that the following conditions are met:
+//
+//  1. Redistributions of  source code must  retain the above copyright  notice,
+//     this list of conditions and the following disclaimer.
+//
+//  2. Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//
+//  THIS SOFTWARE IS PROVIDED ``AS IS'' AND ANY EXPRESSED OR IMPLIED WARRANTIES,
+//  INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+//  FITNESS  FOR A PARTICULAR  PURPOSE ARE  DISCLAIMED.  IN NO  EVENT SHALL  THE
+//  APACHE SOFTWARE  FOUNDATION  OR ITS CONTRIBUTORS  BE LIABLE FOR  ANY DIRECT,
+//  INDIRECT, INCIDENTAL, SPECIAL,  EXEMPLARY, OR CONSEQUENTIAL  DAMAGES (INCLU-
+//  DING, BUT NOT LIMITED TO, PROCUREMENT  OF SUBSTITUTE GOODS OR SERVICES; LOSS
+//  OF USE, DATA, OR  PROFITS; OR BUSINESS  INTERRUPTION)  HOWEVER CAUSED AND ON
+//  ANY  THEORY OF LIABILITY,  WHETHER  IN CONTRACT,  STRICT LIABILITY,  OR TORT
+//  (INCLUDING  NEGLIGENCE OR  OTHERWISE) ARISING IN  ANY WAY OUT OF THE  USE OF
+//  THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+/** @file
+ * This header contains declarations of parsers of log event datagrams
+ * received by log servers.
+ */
+
+#if ! defined (LOG4CPLUS_HELPERS_DATAGRAMPARSER_H)
+#define LOG4CPLUS_HELPERS_DATAGRAMPARSER_H
+
+#include <log4cplus/config.hxx>
+
+#if defined (LOG4CPLUS_HAVE_PRAGMA_ONCE)
+#pragma once
+#endif
+
+#include <log4cplus/loglevel.h>
+#include <log4cplus/spi/loggingevent.h>
+#include <string_view>
+
+
+namespace log4cplus::helpers {
+
+
+//! Formats of datagrams recognized by parseDatagram().
+enum DatagramFormat
+{
+    DATAGRAM_UNKNOWN,
+    //! Binary format written by convertToBuffer(), optionally preceded by
+    //! its size like in the stream of SocketAppender.
+    DATAGRAM_SOCKET,
+    //! XML format written by Log4jUdpAppender.
+    DATAGRAM_LOG4J_XML,
+    //! Syslog message as per RFC 5424 or RFC 3164.
+    DATAGRAM_SYSLOG
+};
+
+
+//! \return Format of <code>data</code> guessed from its first bytes.
+LOG4CPLUS_EXPORT DatagramFormat detectDatagramFormat (std::string_view data);
+
+//! \return Log level corresponding to syslog <code>severity</code>.
+LOG4CPLUS_EXPORT LogLevel syslogSeverityToLogLevel (int severity);
+
+//! Parses syslog message. Application name or tag becomes logger name,
+//! host name becomes NDC and process ID becomes thread name. Messages
+//! without application name are logged by logger <tt>syslog</tt>.
+//! \return False if <code>data</code> is not a syslog message.
+LOG4CPLUS_EXPORT bool parseSyslogMessage (spi::InternalLoggingEvent & event,
+    std::string_view data);
+
+//! Parses log4j XML event. Properties become MDC.
+//! \return False if <code>data</code> is not a log4j XML event.
+LOG4CPLUS_EXPORT bool parseLog4jXmlEvent (spi::InternalLoggingEvent & event,
+    std::string_view data);
+
+//! Parses message written by convertToBuffer().
+//! \return False if <code>data</code> is not such message.
+LOG4CPLUS_EXPORT bool parseSocketMessage (spi::InternalLoggingEvent & event,
+    std::string_view data);
+
+//! Detects format of <code>data</code> and parses it into
+//! <code>event</code>.
+//! \return Format of the parsed datagram or DATAGRAM_UNKNOWN if
+//! <code>data</code> could not be parsed.
+LOG4CPLUS_EXPORT DatagramFormat parseDatagram (
+    spi::InternalLoggingEvent & event, std::string_view data);
+
+
+} // namespace log4cplus::helpers
+
+#endif // LOG4CPLUS_HELPERS_DATAGRAMPARSER_H
@@ -0,0 +1,75 @@
+// -*- C++ -*-
+//
+//  Copyright (C) 2026, Vaclav Zeman. All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without modifica-
+//  tion, are permitted provided that the following conditions are met:
+//
+//  1. Redistributions of  source code must  retain the above copyright  notice,
+//     this list of conditions and the following disclaimer.
+//
+//  2. Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//
+//  THIS SOFTWARE IS PROVIDED ``AS IS'' AND ANY EXPRESSED OR IMPLIED WARRANTIES,
+//  INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+//  FITNESS  FOR A PARTICULAR  PURPOSE ARE  DISCLAIMED.  IN NO  EVENT SHALL  THE
+//  APACHE SOFTWARE  FOUNDATION  OR ITS CONTRIBUTORS  BE LIABLE FOR  ANY DIRECT,
+//  INDIRECT, INCIDENTAL, SPECIAL,  EXEMPLARY, OR CONSEQUENTIAL  DAMAGES (INCLU-
+//  DING, BUT NOT LIMITED TO, PROCUREMENT  OF SUBSTITUTE GOODS OR SERVICES; LOSS
+//  OF USE, DATA, OR  PROFITS; OR BUSINESS  INTERRUPTION)  HOWEVER CAUSED AND ON
+//  ANY  THEORY OF LIABILITY,  WHETHER  IN CONTRACT,  STRICT LIABILITY,  OR TORT
+//  (INCLUDING  NEGLIGENCE OR  OTHERWISE) ARISING IN  ANY WAY OUT OF THE  USE OF
+//  THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+/** @file
+ * This header contains declarations of functions that schedule periodic
+ * tasks on log4cplus' housekeeping thread.
+ */
+
+#if ! defined (LOG4CPLUS_HELPERS_HOUSEKEEPING_H)
+#define LOG4CPLUS_HELPERS_HOUSEKEEPING_H
+
+#include <log4cplus/config.hxx>
+
+#if defined (LOG4CPLUS_HAVE_PRAGMA_ONCE)
+#pragma once
+#endif
+
+#if ! defined (LOG4CPLUS_SINGLE_THREADED)
+
+#include <chrono>
+#include <functional>
+
+
+namespace log4cplus { namespace helpers {
+
+
+//! Identifies task scheduled by scheduleHousekeepingTask().
+typedef unsigned long long HousekeepingTaskId;
+
+
+//! Schedules <code>task</code> to be called every <code>period</code> on
+//! the housekeeping thread shared by the whole library. The first call
+//! happens one <code>period</code> from now. Tasks run one at a time, so
+//! they should not block for long. Exceptions thrown by tasks are
+//! reported through LogLog.
+//!
+//! \return Identifier to pass to cancelHousekeepingTask().
+LOG4CPLUS_EXPORT HousekeepingTaskId scheduleHousekeepingTask (
+    std::chrono::milliseconds period, std::function<void ()> task);
+
+
+//! Cancels task scheduled by scheduleHousekeepingTask(). If the task is
+//! running on another thread, this function waits for it to finish, so
+//! that the task's resources can be released right after it returns.
+//! It can also be called from the task itself.
+LOG4CPLUS_EXPORT void cancelHousekeepingTask (HousekeepingTaskId id);
+
+
+} } // namespace log4cplus { namespace helpers {
+
+#endif // ! defined (LOG4CPLUS_SINGLE_THREADED)
+
+#endif // LOG4CPLUS_HELPERS_HOUSEKEEPING_H
@@ -0,0 +1,178 @@
+// -*- C++ -*-
+//
+//  Copyright (C) 2026, Vaclav Zeman. All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without modifica-
+//  tion, are permitted provided that the following conditions are met:
+//
+//  1. Redistributions of  source code must  retain the above copyright  notice,
+//     this list of conditions and the following disclaimer.
+//
+//  2. Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//
+//  THIS SOFTWARE IS PROVIDED ``AS IS'' AND ANY EXPRESSED OR IMPLIED WARRANTIES,
+//  INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+//  FITNESS  FOR A PARTICULAR  PURPOSE ARE  DISCLAIMED.  IN NO  EVENT SHALL  THE
+//  APACHE SOFTWARE  FOUNDATION  OR ITS CONTRIBUTORS  BE LIABLE FOR  ANY DIRECT,
+//  INDIRECT, INCIDENTAL, SPECIAL,  EXEMPLARY, OR CONSEQUENTIAL  DAMAGES (INCLU-
+//  DING, BUT NOT LIMITED TO, PROCUREMENT  OF SUBSTITUTE GOODS OR SERVICES; LOSS
+//  OF USE, DATA, OR  PROFITS; OR BUSINESS  INTERRUPTION)  HOWEVER CAUSED AND ON
+//  ANY  THEORY OF LIABILITY,  WHETHER  IN CONTRACT,  STRICT LIABILITY,  OR TORT
+//  (INCLUDING  NEGLIGENCE OR  OTHERWISE) ARISING IN  ANY WAY OUT OF THE  USE OF
+//  THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+/** @file
+ * This header contains declaration of process-wide memory budget shared
+ * by log4cplus' buffers and queues.
+ */
+
+#if ! defined (LOG4CPLUS_HELPERS_MEMORYBUDGET_H)
+#define LOG4CPLUS_HELPERS_MEMORYBUDGET_H
+
+#include <log4cplus/config.hxx>
+
+#if defined (LOG4CPLUS_HAVE_PRAGMA_ONCE)
+#pragma once
+#endif
+
+#include <log4cplus/tstring.h>
+#include <atomic>
+#include <cstddef>
+
+#if defined (__has_include)
+#  if __has_include (<memory_resource>)
+#    include <memory_resource>
+#  endif
+#endif
+
+#if defined (__cpp_lib_memory_resource)
+//! Defined when std::pmr::memory_resource is available.
+#  define LOG4CPLUS_HAVE_MEMORY_RESOURCE
+#endif
+
+
+namespace log4cplus {
+
+namespace spi {
+
+class InternalLoggingEvent;
+
+} // namespace spi
+
+
+namespace helpers {
+
+
+//! Process-wide accounting of bytes held by log4cplus' buffers and
+//! queues. Each component reserves bytes before it allocates or queues
+//! anything and releases them when the memory is freed. When a limit is
+//! set and a reservation would exceed it, the reservation fails and the
+//! component applies its overflow policy instead.
+class LOG4CPLUS_EXPORT MemoryBudget
+{
+public:
+    //! Components that draw from the budget.
+    enum Component
+    {
+        //! Events waiting in the internal thread pool for appenders
+        //! with <code>AsyncAppend</code> property set.
+        THREAD_POOL_QUEUE,
+
+        //! Events waiting in AsyncAppender queues.
+        ASYNC_APPENDER_QUEUE,
+
+        //! Output buffers of file appenders with <code>BufferSize</code>
+        //! property set.
+        FILE_BUFFER,
+
+        COMPONENT_COUNT
+    };
+
+    //! What a queue does with an event that does not fit into the budget.
+    enum OverflowPolicy
+    {
+        //! Append the event synchronously in the logging thread.
+        OVERFLOW_SYNC,
+
+        //! Discard the event.
+        OVERFLOW_DISCARD
+    };
+
+    MemoryBudget ();
+    ~MemoryBudget ();
+
+    //! Sets the limit in bytes. Zero means no limit.
+    void setLimit (std::size_t bytes);
+    std::size_t getLimit () const;
+
+    //! Sets overflow policy of queue components. File buffers always
+    //! fall back to unbuffered output.
+    void setOverflowPolicy (Component, OverflowPolicy);
+    OverflowPolicy getOverflowPolicy (Component) const;
+
+    //! Reserves <code>bytes</code> for component <code>c</code>.
+    //! \return false if the reservation would exceed the limit.
+    bool tryAcquire (Component c, std::size_t bytes);
+
+    //! Returns bytes previously reserved using tryAcquire().
+    void release (Component c, std::size_t bytes);
+
+    //! \return Bytes currently reserved by component <code>c</code>.
+    std::size_t getUsage (Component c) const;
+
+    //! \return Bytes currently reserved by all components.
+    std::size_t getTotalUsage () const;
+
+    //! \return Number of failed reservations of component <code>c</code>.
+    std::size_t getOverflowCount (Component c) const;
+
+    //! \return Name of component used in configuration properties.
+    static tchar const * getComponentName (Component c);
+
+    //! \return Estimate of heap and object memory held by a copy of
+    //! <code>ev</code> which keeps only thread specific data selected
+    //! by <code>fields</code>, a combination of
+    //! spi::InternalLoggingEvent::ThreadSpecificData flags. The selected
+    //! thread specific data should be gathered first.
+    static std::size_t estimateEventSize (spi::InternalLoggingEvent const & ev,
+        unsigned fields = ~0u);
+
+private:
+    std::atomic<std::size_t> limit;
+    std::atomic<std::size_t> total;
+    std::atomic<std::size_t> usage[COMPONENT_COUNT];
+    std::atomic<std::size_t> overflows[COMPONENT_COUNT];
+    std::atomic<OverflowPolicy> policies[COMPONENT_COUNT];
+
+    MemoryBudget (MemoryBudget const &);
+    MemoryBudget & operator = (MemoryBudget const &);
+};
+
+
+//! \return Process-wide memory budget.
+LOG4CPLUS_EXPORT MemoryBudget & getMemoryBudget ();
+
+
+#if defined (LOG4CPLUS_HAVE_MEMORY_RESOURCE)
+//! Sets memory resource from which copies of events queued for
+//! asynchronous appenders (<code>AsyncAppend</code> property) are
+//! allocated, e.g., a synchronized pool resource dedicated to logging.
+//! Only the event objects and the control blocks of the shared pointers
+//! owning them come from the resource; the strings, the MDC and the
+//! payload owned by the copies are still allocated from the global heap.
+//! The resource has to be thread safe and it has to outlive all queued
+//! events, i.e., log4cplus shutdown. NULL restores the default, the
+//! global heap.
+LOG4CPLUS_EXPORT void setAsyncEventMemoryResource (
+    std::pmr::memory_resource * resource);
+
+//! \return Memory resource set by setAsyncEventMemoryResource().
+LOG4CPLUS_EXPORT std::pmr::memory_resource * getAsyncEventMemoryResource ();
+#endif
+
+
+} } // namespace log4cplus { namespace helpers {
+
+#endif // LOG4CPLUS_HELPERS_MEMORYBUDGET_H
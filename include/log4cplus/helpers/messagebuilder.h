@@ -0,0 +1,184 @@
+// -*- C++ -*-
+//
+//  Copyright (C) 2026, Vaclav Zeman. All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without modifica-
+//  tion, are permitted provided that the following conditions are met:
+//
+//  1. Redistributions of  source code must  retain the above copyright  notice,
+//     this list of conditions and the following disclaimer.
+//
+//  2. Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//
+//  THIS SOFTWARE IS PROVIDED ``AS IS'' AND ANY EXPRESSED OR IMPLIED WARRANTIES,
+//  INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+//  FITNESS  FOR A PARTICULAR  PURPOSE ARE  DISCLAIMED.  IN NO  EVENT SHALL  THE
+//  APACHE SOFTWARE  FOUNDATION  OR ITS CONTRIBUTORS  BE LIABLE FOR  ANY DIRECT,
+//  INDIRECT, INCIDENTAL, SPECIAL,  EXEMPLARY, OR CONSEQUENTIAL  DAMAGES (INCLU-
+//  DING, BUT NOT LIMITED TO, PROCUREMENT  OF SUBSTITUTE GOODS OR SERVICES; LOSS
+//  OF USE, DATA, OR  PROFITS; OR BUSINESS  INTERRUPTION)  HOWEVER CAUSED AND ON
+//  ANY  THEORY OF LIABILITY,  WHETHER  IN CONTRACT,  STRICT LIABILITY,  OR TORT
+//  (INCLUDING  NEGLIGENCE OR  OTHERWISE) ARISING IN  ANY WAY OUT OF THE  USE OF
+//  THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+/** @file
+ * This header contains declaration of the message builder used by
+ * LOG4CPLUS_* stream macros when LOG4CPLUS_MACRO_ENABLE_MESSAGE_BUILDER
+ * is defined.
+ */
+
+#if ! defined (LOG4CPLUS_HELPERS_MESSAGEBUILDER_H)
+#define LOG4CPLUS_HELPERS_MESSAGEBUILDER_H
+
+#include <log4cplus/config.hxx>
+
+#if defined (LOG4CPLUS_HAVE_PRAGMA_ONCE)
+#pragma once
+#endif
+
+#include <log4cplus/tstring.h>
+#include <log4cplus/streams.h>
+#include <charconv>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <ostream>
+#include <type_traits>
+
+
+namespace log4cplus::helpers {
+
+
+namespace detail {
+
+//! True for integer types printed as numbers by output streams.
+template <typename T>
+inline constexpr bool is_number_integral_v = std::is_integral_v<T>
+    && ! std::is_same_v<T, bool>
+    && ! std::is_same_v<T, char>
+    && ! std::is_same_v<T, signed char>
+    && ! std::is_same_v<T, unsigned char>
+    && ! std::is_same_v<T, wchar_t>
+    && ! std::is_same_v<T, char16_t>
+    && ! std::is_same_v<T, char32_t>;
+
+//! True if std::to_chars() supports floating point types.
+#if defined (__cpp_lib_to_chars)
+inline constexpr bool have_floating_to_chars = true;
+#else
+inline constexpr bool have_floating_to_chars = false;
+#endif
+
+} // namespace detail
+
+
+//! Lightweight replacement of tostringstream for building log messages.
+//!
+//! Numbers are formatted with std::to_chars() and strings and characters
+//! are copied directly into the message, without going through locale
+//! facets. The output is the same as that of a default constructed
+//! stream in the classic locale. Any other type, as well as any
+//! manipulator, is passed to a fallback tostringstream; from then on the
+//! rest of the message is streamed into it as well so that formatting
+//! flags set by manipulators are honoured.
+class LOG4CPLUS_EXPORT MessageBuilder
+{
+public:
+    MessageBuilder ();
+    ~MessageBuilder ();
+
+    //! Clears the message and the state of the fallback stream.
+    void reset ();
+
+    //! \return The message built so far.
+    tstring const & str ();
+
+    template <typename T>
+    MessageBuilder &
+    operator << (T const & value)
+    {
+        using type = std::decay_t<T>;
+
+        if (! streaming)
+        {
+            if constexpr (std::is_same_v<type, tchar>)
+            {
+                buf.push_back (value);
+                return *this;
+            }
+            else if constexpr (std::is_same_v<type, bool>)
+            {
+                buf.push_back (value ? LOG4CPLUS_TEXT ('1')
+                    : LOG4CPLUS_TEXT ('0'));
+                return *this;
+            }
+            else if constexpr (detail::is_number_integral_v<type>)
+            {
+                char digits[std::numeric_limits<type>::digits10 + 3];
+                append_chars (digits,
+                    std::to_chars (std::begin (digits), std::end (digits),
+                        value).ptr);
+                return *this;
+            }
+            else if constexpr (std::is_floating_point_v<type>
+                && detail::have_floating_to_chars)
+            {
+                // Default stream formatting is that of %g with
+                // precision 6.
+                char digits[32];
+                append_chars (digits,
+                    std::to_chars (std::begin (digits), std::end (digits),
+                        value, std::chars_format::general, 6).ptr);
+                return *this;
+            }
+            else if constexpr (std::is_pointer_v<T>
+                && std::is_convertible_v<type, tchar const *>)
+            {
+                // Only real pointers can be null. Arrays, including
+                // string literals, are handled by the tstring_view
+                // branch below.
+                if (value)
+                    buf.append (value);
+                return *this;
+            }
+            else if constexpr (std::is_convertible_v<T const &, tstring_view>)
+            {
+                buf.append (tstring_view (value));
+                return *this;
+            }
+        }
+
+        stream () << value;
+        return *this;
+    }
+
+    MessageBuilder & operator << (tostream & (* manip) (tostream &));
+    MessageBuilder & operator << (
+        std::basic_ios<tchar> & (* manip) (std::basic_ios<tchar> &));
+    MessageBuilder & operator << (std::ios_base & (* manip) (std::ios_base &));
+
+private:
+    //! Switches to the fallback stream, moving the message built so far
+    //! into it.
+    tostream & stream ();
+
+    void
+    append_chars (char const * first, char const * last)
+    {
+        buf.append (first, last);
+    }
+
+    tstring buf;
+    std::unique_ptr<tostringstream> oss;
+    bool streaming;
+
+    MessageBuilder (MessageBuilder const &) = delete;
+    MessageBuilder & operator = (MessageBuilder const &) = delete;
+};
+
+
+} // namespace log4cplus::helpers
+
+#endif // LOG4CPLUS_HELPERS_MESSAGEBUILDER_H
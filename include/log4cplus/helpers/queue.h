@@ -50,8 +50,24 @@ public:
     //! Type of the state flags field.
     typedef unsigned flags_type;
 
+    //! Queued copy of an event.
+    struct Item
+    {
+        Item (spi::InternalLoggingEvent const & ev, unsigned fields,
+            std::size_t bytes)
+            : event (ev, fields)
+            , reserved (bytes)
+        { }
+
+        spi::InternalLoggingEvent event;
+
+        //! Bytes of helpers::MemoryBudget the producer reserved for
+        //! the event.
+        std::size_t reserved;
+    };
+
     //! Queue storage type.
-    typedef std::deque<spi::InternalLoggingEvent> queue_storage_type;
+    typedef std::deque<Item> queue_storage_type;
 
     explicit Queue (unsigned len = 100);
     virtual ~Queue ();
@@ -68,8 +84,14 @@ public:
     //! signal_exit().
     //!
     //! \param ev spi::InternalLoggingEvent to be put into the queue.
+    //! \param fields Combination of
+    //! spi::InternalLoggingEvent::ThreadSpecificData flags selecting
+    //! thread specific data kept in the queued copy of the event.
+    //! \param reserved Bytes of memory budget reserved for the event,
+    //! returned to the consumer in Item::reserved.
     //! \return Flags.
-    flags_type put_event (spi::InternalLoggingEvent const & ev);
+    flags_type put_event (spi::InternalLoggingEvent const & ev,
+        unsigned fields = ~0u, std::size_t reserved = 0);
 
     //! Sets EXIT flag and DRAIN flag and sets internal event object
     //! into signaled state.
@@ -93,8 +115,8 @@ public:
     //!
     //! Upon error, return value has one of the error flags set.
     //!
-    //! \param buf Pointer to storage of spi::InternalLoggingEvent
-    //! instances to be filled from queue.
+    //! \param buf Pointer to storage of Item instances to be filled
+    //! from queue.
     //! \return Flags.
     flags_type get_events (queue_storage_type * buf);
 
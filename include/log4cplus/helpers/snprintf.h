@@ -50,6 +50,16 @@ public:
     int print_va_list (tchar const * & str, tchar const * fmt, std::va_list)
         LOG4CPLUS_FORMAT_ATTRIBUTE (__printf__, 3, 0);
 
+    //! Like print() but it stops formatting after <code>max_len</code> + 1
+    //! characters, enough to tell that the output is longer than
+    //! <code>max_len</code>. Zero <code>max_len</code> means no limit.
+    tchar const * print_capped (std::size_t max_len, tchar const * fmt, ...)
+        LOG4CPLUS_FORMAT_ATTRIBUTE (__printf__, 3, 4);
+
+    int print_va_list (std::size_t max_len, tchar const * & str,
+        tchar const * fmt, std::va_list)
+        LOG4CPLUS_FORMAT_ATTRIBUTE (__printf__, 4, 0);
+
 private:
     std::vector<tchar> buf;
 };
@@ -100,6 +100,16 @@ namespace log4cplus {
             virtual bool write(std::size_t bufferCount,
                 SocketBuffer const * const * buffers);
 
+            //! \return true if read() would not block, that is if input
+            //! is available or the peer has closed the connection.
+            virtual bool hasPendingInput();
+
+            //! Reads into <code>buffer</code> whatever input is
+            //! available, at most its maximal size, and sets its size.
+            //! Unlike read(), it does not wait for the buffer to fill; it
+            //! does not block if hasPendingInput() returned true.
+            virtual bool readAvailable(SocketBuffer& buffer);
+
             template <typename... Args>
             static bool write(Socket & socket, Args &&... args)
             {
@@ -130,6 +140,10 @@ namespace log4cplus {
             void interruptAccept ();
             void swap (ServerSocket &);
 
+            //! \return Local port of the socket, e.g., the port chosen by
+            //! the system when port 0 was requested, or 0 on error.
+            unsigned short getLocalPort () const;
+
         protected:
             std::array<std::ptrdiff_t, 2> interruptHandles;
         };
@@ -147,12 +161,15 @@ namespace log4cplus {
         LOG4CPLUS_EXPORT int shutdownSocket(SOCKET_TYPE sock);
 
         LOG4CPLUS_EXPORT long read(SOCKET_TYPE sock, SocketBuffer& buffer);
+        LOG4CPLUS_EXPORT long readAvailable(SOCKET_TYPE sock,
+            SocketBuffer& buffer);
         LOG4CPLUS_EXPORT long write(SOCKET_TYPE sock,
             const SocketBuffer& buffer);
         LOG4CPLUS_EXPORT long write(SOCKET_TYPE sock, std::size_t bufferCount,
             SocketBuffer const * const * buffers);
         LOG4CPLUS_EXPORT long write(SOCKET_TYPE sock,
             const std::string & buffer);
+        LOG4CPLUS_EXPORT bool hasPendingInput(SOCKET_TYPE sock);
 
         LOG4CPLUS_EXPORT tstring getHostname (bool fqdn);
         LOG4CPLUS_EXPORT int setTCPNoDelay (SOCKET_TYPE, bool);
@@ -31,6 +31,8 @@
 #endif
 
 #include <log4cplus/tstring.h>
+#include <string>
+#include <string_view>
 
 
 namespace log4cplus {
@@ -55,6 +57,7 @@ public:
     unsigned short readShort();
     unsigned int readInt();
     tstring readString(unsigned char sizeOfChar);
+    std::string readBytes();
 
     void appendByte(unsigned char val);
     void appendShort(unsigned short val);
@@ -62,6 +65,9 @@ public:
     void appendString(const tstring& str);
     void appendBuffer(const SocketBuffer& buffer);
 
+    //! Appends length of <code>bytes</code> followed by the raw bytes.
+    void appendBytes(std::string_view bytes);
+
 private:
     // Data
     std::size_t maxsize;
@@ -0,0 +1,77 @@
+// -*- C++ -*-
+//
+//  Copyright (C) 2026, Vaclav Zeman. All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without modifica-
+//  tion, are permitted provided that the following conditions are met:
+//
+//  1. Redistributions of  source code must  retain the above copyright  notice,
+//     this list of conditions and the following disclaimer.
+//
+//  2. Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//
+//  THIS SOFTWARE IS PROVIDED ``AS IS'' AND ANY EXPRESSED OR IMPLIED WARRANTIES,
+//  INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+//  FITNESS  FOR A PARTICULAR  PURPOSE ARE  DISCLAIMED.  IN NO  EVENT SHALL  THE
+//  APACHE SOFTWARE  FOUNDATION  OR ITS CONTRIBUTORS  BE LIABLE FOR  ANY DIRECT,
+//  INDIRECT, INCIDENTAL, SPECIAL,  EXEMPLARY, OR CONSEQUENTIAL  DAMAGES (INCLU-
+//  DING, BUT NOT LIMITED TO, PROCUREMENT  OF SUBSTITUTE GOODS OR SERVICES; LOSS
+//  OF USE, DATA, OR  PROFITS; OR BUSINESS  INTERRUPTION)  HOWEVER CAUSED AND ON
+//  ANY  THEORY OF LIABILITY,  WHETHER  IN CONTRACT,  STRICT LIABILITY,  OR TORT
+//  (INCLUDING  NEGLIGENCE OR  OTHERWISE) ARISING IN  ANY WAY OUT OF THE  USE OF
+//  THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+/** @file
+ * This header contains declaration of functions controlling the logging
+ * pipeline stage profiler, which is compiled in when
+ * LOG4CPLUS_ENABLE_STAGE_PROFILER is defined while building log4cplus.
+ */
+
+#if ! defined (LOG4CPLUS_HELPERS_STAGEPROFILER_H)
+#define LOG4CPLUS_HELPERS_STAGEPROFILER_H
+
+#include <log4cplus/config.hxx>
+
+#if defined (LOG4CPLUS_HAVE_PRAGMA_ONCE)
+#pragma once
+#endif
+
+#include <log4cplus/streams.h>
+
+
+namespace log4cplus::helpers {
+
+
+//! \return True if log4cplus has been built with the stage profiler.
+LOG4CPLUS_EXPORT bool isStageProfilerEnabled ();
+
+//! Sets how often events are sampled by the stage profiler; one in
+//! <code>interval</code> enabled checks is timed together with the rest
+//! of the pipeline of its event. The default is 64.
+LOG4CPLUS_EXPORT void setStageProfilerSampleInterval (unsigned interval);
+
+//! Discards all samples collected so far.
+LOG4CPLUS_EXPORT void resetStageProfile ();
+
+//! Writes table of samples collected so far by all threads into
+//! <code>os</code>. Times are in ticks of the CPU cycle counter where
+//! one is available and in ticks of std::chrono::steady_clock otherwise.
+//! Each row shows number of samples, average and share of the total
+//! of one stage of one logger or appender. Logger stages are the
+//! enabled check, building of the message by the logging macro and
+//! construction of the event; appender stages are threshold and filter
+//! evaluation, wait for the appender lock, layout formatting and the
+//! rest of the append, i.e., sink I/O. Events appended by thread pool
+//! (AsyncAppend=true) and by batches are not sampled past the event
+//! construction.
+//!
+//! The table is also written into std::cerr by log4cplus::deinitialize()
+//! if there are any samples.
+LOG4CPLUS_EXPORT void dumpStageProfile (tostream & os);
+
+
+} // namespace log4cplus::helpers
+
+#endif // LOG4CPLUS_HELPERS_STAGEPROFILER_H
@@ -53,6 +53,24 @@ namespace log4cplus {
         LOG4CPLUS_EXPORT tchar toLower(tchar);
 
 
+        /**
+         * Appends lower case hexadecimal representation of
+         * <code>size</code> bytes at <code>data</code> to
+         * <code>result</code>.
+         */
+        LOG4CPLUS_EXPORT void appendHex(log4cplus::tstring & result,
+            void const * data, std::size_t size);
+
+
+        /**
+         * Appends padded Base64 (RFC 4648) representation of
+         * <code>size</code> bytes at <code>data</code> to
+         * <code>result</code>.
+         */
+        LOG4CPLUS_EXPORT void appendBase64(log4cplus::tstring & result,
+            void const * data, std::size_t size);
+
+
         /**
          * Tokenize <code>s</code> using <code>c</code> as the delimiter and
          * put the resulting tokens in <code>_result</code>.  If
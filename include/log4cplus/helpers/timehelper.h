@@ -38,6 +38,7 @@
 
 #include <ctime>
 #include <chrono>
+#include <vector>
 
 
 namespace log4cplus {
@@ -161,6 +162,65 @@ log4cplus::tstring getFormattedTime (log4cplus::tstring const & fmt,
     Time const & the_time, bool use_gmtime = false);
 
 
+/**
+ * Time format compiled into a list of operations.
+ *
+ * The format uses the same syntax as getFormattedTime(). The common
+ * conversion specifiers are formatted directly, the rest (and those
+ * that depend on locale, unless <code>LC_TIME</code> is the "C" locale
+ * at the time of formatting) are passed to <code>strftime()</code> one
+ * by one. The output is identical to that of getFormattedTime().
+ *
+ * Formatting does not modify the instance, so one instance can be used
+ * from several threads at once.
+ */
+class LOG4CPLUS_EXPORT TimeFormatter
+{
+public:
+    TimeFormatter ();
+    explicit TimeFormatter (log4cplus::tstring const & fmt);
+    ~TimeFormatter ();
+
+    //! Compiles format <code>fmt</code>.
+    void setFormat (log4cplus::tstring const & fmt);
+
+    //! \return Format string this instance was compiled from.
+    log4cplus::tstring const & getFormat () const
+    { return fmt; }
+
+    //! Appends <code>the_time</code> formatted according to the format
+    //! to <code>result</code>.
+    void append (log4cplus::tstring & result, Time const & the_time,
+        bool use_gmtime = false) const;
+
+    //! \return <code>the_time</code> formatted according to the format.
+    log4cplus::tstring format (Time const & the_time,
+        bool use_gmtime = false) const;
+
+private:
+    struct Operation
+    {
+        int code;
+        //! Start and length of text in <code>literals</code> used by
+        //! literal text and by specifiers formatted by strftime().
+        std::size_t offset;
+        std::size_t length;
+    };
+
+    void compile (log4cplus::tstring const & format);
+    void addLiteral (tchar ch);
+    void addOperation (int code, log4cplus::tstring const & spec);
+
+    log4cplus::tstring fmt;
+    log4cplus::tstring literals;
+    std::vector<Operation> ops;
+    //! False if the format does not need broken-down time.
+    bool needs_tm;
+    //! True if the format has names which depend on locale.
+    bool needs_locale;
+};
+
+
 } // namespace helpers
 
 } // namespace log4cplus
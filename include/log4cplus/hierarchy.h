@@ -32,6 +32,7 @@
 
 #include <log4cplus/logger.h>
 #include <log4cplus/thread/syncprims.h>
+#include <atomic>
 #include <map>
 #include <memory>
 #include <vector>
@@ -178,6 +179,19 @@ namespace log4cplus {
         virtual Logger getInstance(const log4cplus::tstring_view& name,
             spi::LoggerFactory& factory);
 
+        /**
+         * Dispatch <code>count</code> pre-built events, each to the
+         * appenders of the logger named by its logger name, without
+         * checking levels. Every distinct logger is looked up only once
+         * and every appender receives a single batch, through
+         * Appender::doAppendBatch(), of the events it should append, in
+         * their original order.
+         *
+         * @see Logger::logBatch()
+         */
+        virtual void logBatch(spi::InternalLoggingEvent const * events,
+            std::size_t count);
+
         /**
          * Returns all the currently defined loggers in this hierarchy.
          *
@@ -210,6 +224,26 @@ namespace log4cplus {
          */
         virtual void resetConfiguration();
 
+        /**
+         * Replace the configuration of this hierarchy with configuration
+         * of <code>staged</code>. Unlike resetConfiguration() followed by
+         * reconfiguration, this does not block logging while the new
+         * configuration is built: the caller configures a scratch
+         * hierarchy first and this method then moves its log levels,
+         * additivity flags, maximal message sizes and appenders into
+         * this hierarchy's loggers and publishes them with a single
+         * configuration generation change. Loggers which are not
+         * configured in <code>staged</code> are reset to their defaults.
+         *
+         * Appenders dropped by the new configuration are closed
+         * asynchronously once no logging call uses them any more, i.e.,
+         * when the last appender list built for the old configuration
+         * is dropped.
+         *
+         * <code>staged</code> is left without appenders.
+         */
+        void publishConfiguration(Hierarchy& staged);
+
         /**
          * Set the default LoggerFactory instance.
          */
@@ -235,12 +269,51 @@ namespace log4cplus {
          */
         virtual void shutdown();
 
+        /**
+         * Returns the configuration generation of this hierarchy. It
+         * changes every time the shape of the hierarchy or the set of
+         * appenders attached to its loggers changes. Loggers use it to
+         * tell when their cached, flattened appender lists are stale.
+         */
+        unsigned getConfigurationGeneration() const
+        {
+            return configGeneration.load(std::memory_order_acquire);
+        }
+
+        /**
+         * Invalidate all cached per logger configuration derived from
+         * this hierarchy.
+         */
+        void bumpConfigurationGeneration()
+        {
+            configGeneration.fetch_add(1, std::memory_order_acq_rel);
+        }
+
+        /**
+         * Returns the number of messages truncated because they exceeded
+         * maximal message size of their logger.
+         *
+         * @see Logger::setMaxMessageSize()
+         */
+        std::size_t getTruncatedMessageCount() const
+        {
+            return truncatedMessages.load(std::memory_order_relaxed);
+        }
+
     private:
       // Types
         typedef std::vector<Logger> ProvisionNode;
         typedef std::map<log4cplus::tstring, ProvisionNode, std::less<>> ProvisionNodeMap;
         typedef std::map<log4cplus::tstring, Logger, std::less<>> LoggerMap;
 
+        /**
+         * Configuration published by publishConfiguration(). Flattened
+         * appender lists of loggers keep the epoch they were built in
+         * alive. Appenders replaced when the epoch ends are closed when
+         * the last such list is dropped.
+         */
+        struct ConfigurationEpoch;
+
       // Methods
         /**
          * This is the implementation of the <code>getInstance()</code> method.
@@ -296,6 +369,59 @@ namespace log4cplus {
         LOG4CPLUS_PRIVATE void updateChildren(ProvisionNode& pn,
             Logger const & logger);
 
+        /**
+         * Returns the current configuration epoch.
+         */
+        LOG4CPLUS_PRIVATE
+        std::shared_ptr<ConfigurationEpoch> getConfigurationEpoch() const;
+
+        /**
+         * Marks the calling thread as dispatching an event to appenders
+         * of the hierarchy for its lifetime. Appender lists taken by the
+         * thread meanwhile, i.e., by nested dispatches, are not held back
+         * by holdDispatch(). The mark is thread local; in-flight
+         * dispatches are tracked by the configuration epoch references of
+         * their appender lists.
+         */
+        class DispatchGuard
+        {
+        public:
+            LOG4CPLUS_PRIVATE explicit DispatchGuard(Hierarchy& h);
+            LOG4CPLUS_PRIVATE ~DispatchGuard();
+
+        private:
+            Hierarchy* registered;
+            Hierarchy* previous;
+
+            DispatchGuard(const DispatchGuard&) = delete;
+            DispatchGuard& operator=(const DispatchGuard&) = delete;
+        };
+
+        /**
+         * Starts a new configuration epoch, drops cached appender lists
+         * of all loggers and waits until the appender lists of the old
+         * epoch, i.e., dispatches in flight, are released. Until
+         * releaseDispatch() is called, loggers do not build new appender
+         * lists, except for threads marked by DispatchGuard and for the
+         * calling thread, so new dispatches wait.
+         *
+         * @return false if the calling thread is dispatching an event in
+         * this hierarchy or holds it already. Nothing is held then.
+         */
+        LOG4CPLUS_PRIVATE bool holdDispatch();
+
+        /**
+         * Releases dispatches held back by holdDispatch().
+         */
+        LOG4CPLUS_PRIVATE void releaseDispatch();
+
+        /**
+         * @return true if the calling thread may take appender lists of
+         * this hierarchy while dispatch is held, i.e., if it holds the
+         * dispatch or dispatches an event in the hierarchy already.
+         */
+        LOG4CPLUS_PRIVATE bool isDispatchingThread() const;
+
      // Data
         thread::Mutex hashtable_mutex;
         std::unique_ptr<spi::LoggerFactory> defaultFactory;
@@ -307,6 +433,28 @@ namespace log4cplus {
 
         bool emittedNoAppenderWarning;
 
+        std::atomic<unsigned> configGeneration;
+
+        /** Current configuration epoch. Accessed atomically. */
+        std::shared_ptr<ConfigurationEpoch> configurationEpoch;
+
+        std::atomic<std::size_t> truncatedMessages;
+
+        /** Set while holdDispatch() holds back dispatches. */
+        std::atomic<bool> dispatchHeld;
+
+        /** Serializes holders of the dispatch. */
+        thread::Mutex dispatchHoldMutex;
+
+        /** Signaled when the epoch ended by holdDispatch() is released. */
+        thread::ManualResetEvent dispatchDrained;
+
+        /** Signaled when held back dispatches are released. */
+        thread::ManualResetEvent dispatchReleased;
+
+        /** Hierarchy the holding thread was dispatching in before. */
+        Hierarchy* dispatchHolderPrevious;
+
         // Disallow copying of instances of this class
         Hierarchy(const Hierarchy&);
         Hierarchy& operator=(const Hierarchy&);
@@ -43,6 +43,10 @@ namespace log4cplus
 
     /**
      * This is used to lock a Hierarchy.  The dtor unlocks the Hierarchy.
+     *
+     * The ctor waits for events being dispatched to appenders of the
+     * Hierarchy to finish. While the Hierarchy is locked, only the thread
+     * holding the lock dispatches events; other threads wait.
      */
     class LOG4CPLUS_EXPORT HierarchyLocker {
     public:
@@ -70,6 +74,7 @@ namespace log4cplus
     private:
       // Data
         Hierarchy& h;
+        bool dispatchHeld;
         log4cplus::thread::MutexGuard hierarchyLocker;
         LoggerList loggerList;
     };
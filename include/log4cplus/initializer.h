@@ -30,6 +30,7 @@
 #pragma once
 #endif
 
+#include <log4cplus/helpers/memorybudget.h>
 #include <memory>
 
 
@@ -48,6 +49,16 @@ class LOG4CPLUS_EXPORT Initializer
 {
 public:
     Initializer ();
+
+#if defined (LOG4CPLUS_HAVE_MEMORY_RESOURCE)
+    //! Like the default constructor. In addition, copies of events queued
+    //! for asynchronous appenders, without the strings they own, are
+    //! allocated from `async_event_resource` until the last `Initializer`
+    //! is destroyed.
+    //! @see helpers::setAsyncEventMemoryResource()
+    explicit Initializer (std::pmr::memory_resource * async_event_resource);
+#endif
+
     ~Initializer ();
 
     Initializer (Initializer const &) = delete;
@@ -0,0 +1,144 @@
+// -*- C++ -*-
+//
+//  Copyright (C) 2026, Vaclav Zeman. All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without modifica-
+//  tion, are permitted provided that the following conditions are met:
+//
+//  1. Redistributions of  source code must  retain the above copyright  notice,
+//     this list of conditions and the following disclaimer.
+//
+//  2. Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//
+//  THIS SOFTWARE IS PROVIDED ``AS IS'' AND ANY EXPRESSED OR IMPLIED WARRANTIES,
+//  INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+//  FITNESS  FOR A PARTICULAR  PURPOSE ARE  DISCLAIMED.  IN NO  EVENT SHALL  THE
+//  APACHE SOFTWARE  FOUNDATION  OR ITS CONTRIBUTORS  BE LIABLE FOR  ANY DIRECT,
+//  INDIRECT, INCIDENTAL, SPECIAL,  EXEMPLARY, OR CONSEQUENTIAL  DAMAGES (INCLU-
+//  DING, BUT NOT LIMITED TO, PROCUREMENT  OF SUBSTITUTE GOODS OR SERVICES; LOSS
+//  OF USE, DATA, OR  PROFITS; OR BUSINESS  INTERRUPTION)  HOWEVER CAUSED AND ON
+//  ANY  THEORY OF LIABILITY,  WHETHER  IN CONTRACT,  STRICT LIABILITY,  OR TORT
+//  (INCLUDING  NEGLIGENCE OR  OTHERWISE) ARISING IN  ANY WAY OUT OF THE  USE OF
+//  THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+/** @file
+ * This header contains declaration of per-thread data of the callsite
+ * profiler. This header is internal to log4cplus and is included only
+ * when LOG4CPLUS_ENABLE_CALLSITE_PROFILER is defined.
+ */
+
+#ifndef LOG4CPLUS_INTERNAL_CALLSITEPROFILER_H
+#define LOG4CPLUS_INTERNAL_CALLSITEPROFILER_H
+
+#include <log4cplus/config.hxx>
+
+#if defined (LOG4CPLUS_HAVE_PRAGMA_ONCE)
+#pragma once
+#endif
+
+#if ! defined (INSIDE_LOG4CPLUS)
+#  error "This header must not be be used outside log4cplus' implementation files."
+#endif
+
+#include <log4cplus/thread/syncprims.h>
+#include <log4cplus/internal/stageprofiler.h>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <unordered_map>
+#include <utility>
+
+
+namespace log4cplus::internal {
+
+
+//! Identifies callsite by <code>__FILE__</code> literal, or function name
+//! if file names are disabled, and line.
+typedef std::pair<char const *, int> callsite_key;
+
+
+struct callsite_key_hash
+{
+    std::size_t
+    operator () (callsite_key const & key) const
+    {
+        return std::hash<char const *> () (key.first)
+            ^ static_cast<std::size_t>(key.second);
+    }
+};
+
+
+//! Counters of one callsite. They are only written by the owning thread
+//! and read by the report, so no read-modify-write operations are needed.
+struct callsite_counters
+{
+    std::atomic<std::uint64_t> count {0};
+    std::atomic<std::uint64_t> bytes {0};
+    std::atomic<std::uint64_t> ticks {0};
+
+    void
+    add (std::uint64_t bytes_, std::uint64_t ticks_)
+    {
+        count.store (count.load (std::memory_order_relaxed) + 1,
+            std::memory_order_relaxed);
+        bytes.store (bytes.load (std::memory_order_relaxed) + bytes_,
+            std::memory_order_relaxed);
+        ticks.store (ticks.load (std::memory_order_relaxed) + ticks_,
+            std::memory_order_relaxed);
+    }
+};
+
+
+typedef std::unordered_map<callsite_key, callsite_counters,
+    callsite_key_hash> callsite_table;
+
+
+//! Per-thread counters of the callsite profiler. They are registered
+//! globally so that helpers::dumpCallsiteProfile() can sum them and are
+//! merged into global totals when the thread ends.
+struct callsite_profiler_data
+{
+    callsite_profiler_data ();
+    ~callsite_profiler_data ();
+
+    //! Adds event of <code>bytes</code> bytes that took <code>ticks</code>
+    //! to format to callsite <code>key</code>.
+    void
+    record (callsite_key const & key, std::uint64_t bytes,
+        std::uint64_t ticks)
+    {
+        auto it = sites.find (key);
+        if (LOG4CPLUS_UNLIKELY (it == sites.end ()))
+            it = insert (key);
+
+        it->second.add (bytes, ticks);
+    }
+
+    callsite_table::iterator insert (callsite_key const & key);
+
+    //! Ticks at the end of the last successful enabled check, zero if
+    //! it has been consumed by forcedLog().
+    std::uint64_t mark;
+
+    //! Ticks spent in layouts for the current event.
+    std::uint64_t layout_ticks;
+
+    //! Protects structure of <code>sites</code>; only the owning thread
+    //! changes it and it does not lock it to look callsites up.
+    thread::Mutex mutex;
+
+    callsite_table sites;
+
+private:
+    callsite_profiler_data (callsite_profiler_data const &) = delete;
+    callsite_profiler_data & operator = (callsite_profiler_data const &)
+        = delete;
+};
+
+
+} // namespace log4cplus::internal
+
+#endif // LOG4CPLUS_INTERNAL_CALLSITEPROFILER_H
@@ -47,21 +47,44 @@
 #  error "This header must not be be used outside log4cplus' implementation files."
 #endif
 
+#include <atomic>
 #include <memory>
 #include <vector>
 #include <sstream>
+#include <locale>
 #include <cstdio>
 #include <log4cplus/tstring.h>
 #include <log4cplus/streams.h>
 #include <log4cplus/ndc.h>
 #include <log4cplus/mdc.h>
+#include <log4cplus/layout.h>
 #include <log4cplus/spi/loggingevent.h>
 #include <log4cplus/thread/impl/tls.h>
 #include <log4cplus/helpers/snprintf.h>
+#include <log4cplus/helpers/messagebuilder.h>
+
+#if defined (LOG4CPLUS_ENABLE_STAGE_PROFILER)
+#include <log4cplus/internal/stageprofiler.h>
+#endif
+
+#if defined (LOG4CPLUS_ENABLE_CALLSITE_PROFILER)
+#include <log4cplus/internal/callsiteprofiler.h>
+#endif
+
+#if ! defined (LOG4CPLUS_SINGLE_THREADED)
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <thread>
+#endif
 
 
 namespace log4cplus {
 
+class Hierarchy;
+
 namespace internal {
 
 
@@ -70,30 +93,37 @@ namespace internal {
 extern log4cplus::tstring const empty_str;
 
 
+//! Generation counter of appender configuration (thresholds and filters)
+//! shared by all appenders. Loggers use it to invalidate their cached
+//! lowest accepted log level.
+extern std::atomic<unsigned> appender_config_generation;
+
+
+inline
+unsigned
+getAppenderConfigGeneration ()
+{
+    return appender_config_generation.load (std::memory_order_acquire);
+}
+
+
+inline
+void
+bumpAppenderConfigGeneration ()
+{
+    appender_config_generation.fetch_add (1, std::memory_order_acq_rel);
+}
+
+
 struct gft_scratch_pad
 {
     gft_scratch_pad ();
     ~gft_scratch_pad ();
-    
-    void
-    reset ()
-    {
-        uc_q_str_valid = false;
-        q_str_valid = false;
-        s_str_valid = false;
-        ret.clear ();
-    }
-    
-    log4cplus::tstring q_str;
-    log4cplus::tstring uc_q_str;
-    log4cplus::tstring s_str;
+
+    //! Formatter compiled from the format last passed to
+    //! helpers::getFormattedTime().
+    helpers::TimeFormatter formatter;
     log4cplus::tstring ret;
-    log4cplus::tstring fmt;
-    log4cplus::tstring tmp;
-    std::vector<tchar> buffer;
-    bool uc_q_str_valid;
-    bool q_str_valid;
-    bool s_str_valid;
 };
 
 
@@ -108,14 +138,45 @@ struct appender_sratch_pad
 };
 
 
+//! Data shared by appenders while a single event is being dispatched to
+//! multiple appenders.
+struct dispatch_cache
+{
+    dispatch_cache ();
+    ~dispatch_cache ();
+
+    //! Layout output of the event keyed by layout fingerprint and locale.
+    struct entry
+    {
+        log4cplus::tstring fingerprint;
+        std::locale loc;
+        log4cplus::tstring str;
+    };
+
+    //! Event being currently dispatched, NULL if caching is inactive.
+    spi::InternalLoggingEvent const * event;
+    //! Fingerprints of layouts shared by appenders of the event.
+    std::vector<log4cplus::tstring> const * shared_fingerprints;
+    //! Storage of entries is reused, only first `size` are valid.
+    std::vector<entry> entries;
+    std::size_t size;
+    tostringstream oss;
+    //! Immutable copy of the event shared by asynchronous appenders.
+    std::shared_ptr<spi::InternalLoggingEvent const> shared_event;
+    //! Thread specific data captured by `shared_event`.
+    unsigned shared_event_fields;
+};
+
+
 //! Per thread data.
 struct per_thread_data
 {
     per_thread_data ();
     ~per_thread_data ();
 
-    tstring macros_str;
+    tstring truncated_message;
     tostringstream macros_oss;
+    helpers::MessageBuilder macros_builder;
     tostringstream layout_oss;
     DiagnosticContextStack ndc_dcs;
     MappedDiagnosticContextMap mdc_map;
@@ -123,11 +184,22 @@ struct per_thread_data
     log4cplus::tstring thread_name2;
     gft_scratch_pad gft_sp;
     appender_sratch_pad appender_sp;
+    dispatch_cache event_dispatch;
+    //! Hierarchy in which the thread dispatches an event or which it
+    //! holds through HierarchyLocker.
+    Hierarchy * dispatch_hierarchy;
     log4cplus::tstring faa_str;
+    LayoutSegments layout_segments;
     log4cplus::tstring ll_str;
     spi::InternalLoggingEvent forced_log_ev;
     std::FILE * fnull;
     log4cplus::helpers::snprintf_buf snprintf_buf;
+#if defined (LOG4CPLUS_ENABLE_STAGE_PROFILER)
+    stage_profiler_data profiler;
+#endif
+#if defined (LOG4CPLUS_ENABLE_CALLSITE_PROFILER)
+    callsite_profiler_data callsites;
+#endif
 };
 
 
@@ -227,6 +299,76 @@ get_appender_sp ()
 }
 
 
+inline
+dispatch_cache &
+get_dispatch_cache ()
+{
+    return get_ptd ()->event_dispatch;
+}
+
+
+//! Returns number of days since 1970-01-01 of the given date of the
+//! proleptic Gregorian calendar. This is based on
+//! <http://howardhinnant.github.io/date_algorithms.html>.
+inline
+long long
+days_from_civil (long long y, unsigned m, unsigned d)
+{
+    y -= m <= 2;
+    long long const era = (y >= 0 ? y : y - 399) / 400;
+    unsigned const yoe = static_cast<unsigned>(y - era * 400);
+    unsigned const doy = (153 * (m > 2 ? m - 3 : m + 9) + 2) / 5 + d - 1;
+    unsigned const doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + static_cast<long long>(doe) - 719468;
+}
+
+
+#if ! defined (LOG4CPLUS_SINGLE_THREADED)
+
+//! Runs periodic tasks scheduled by helpers::scheduleHousekeepingTask()
+//! on a single thread. The thread is started with the first task.
+class housekeeper
+{
+public:
+    typedef std::chrono::steady_clock clock_type;
+    typedef unsigned long long task_id;
+
+    housekeeper ();
+    ~housekeeper ();
+
+    task_id schedule (std::chrono::milliseconds period,
+        std::function<void ()> task);
+    void cancel (task_id id);
+
+private:
+    struct task_type
+    {
+        std::chrono::milliseconds period;
+        std::function<void ()> func;
+    };
+
+    void run ();
+
+    std::mutex mtx;
+    std::condition_variable cond;
+    //! Scheduled tasks by their identifiers.
+    std::map<task_id, std::shared_ptr<task_type>> tasks;
+    //! Identifiers of scheduled tasks ordered by their next run time.
+    std::multimap<clock_type::time_point, task_id> schedule_queue;
+    task_id next_id;
+    task_id running_id;
+    bool exit_flag;
+    std::thread thread;
+};
+
+
+//! Returns housekeeper of the default context. Returns nullptr if
+//! <code>alloc</code> is false and the default context does not exist.
+housekeeper * get_housekeeper (bool alloc = true);
+
+#endif
+
+
 } // namespace internal {
 
 
@@ -0,0 +1,189 @@
+// -*- C++ -*-
+//
+//  Copyright (C) 2026, Vaclav Zeman. All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without modifica-
+//  tion, are permitted provided that the following conditions are met:
+//
+//  1. Redistributions of  source code must  retain the above copyright  notice,
+//     this list of conditions and the following disclaimer.
+//
+//  2. Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//
+//  THIS SOFTWARE IS PROVIDED ``AS IS'' AND ANY EXPRESSED OR IMPLIED WARRANTIES,
+//  INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+//  FITNESS  FOR A PARTICULAR  PURPOSE ARE  DISCLAIMED.  IN NO  EVENT SHALL  THE
+//  APACHE SOFTWARE  FOUNDATION  OR ITS CONTRIBUTORS  BE LIABLE FOR  ANY DIRECT,
+//  INDIRECT, INCIDENTAL, SPECIAL,  EXEMPLARY, OR CONSEQUENTIAL  DAMAGES (INCLU-
+//  DING, BUT NOT LIMITED TO, PROCUREMENT  OF SUBSTITUTE GOODS OR SERVICES; LOSS
+//  OF USE, DATA, OR  PROFITS; OR BUSINESS  INTERRUPTION)  HOWEVER CAUSED AND ON
+//  ANY  THEORY OF LIABILITY,  WHETHER  IN CONTRACT,  STRICT LIABILITY,  OR TORT
+//  (INCLUDING  NEGLIGENCE OR  OTHERWISE) ARISING IN  ANY WAY OUT OF THE  USE OF
+//  THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+/** @file
+ * This header contains declaration of per-thread data of the stage
+ * profiler. This header is internal to log4cplus and is included only
+ * when LOG4CPLUS_ENABLE_STAGE_PROFILER is defined.
+ */
+
+#ifndef LOG4CPLUS_INTERNAL_STAGEPROFILER_H
+#define LOG4CPLUS_INTERNAL_STAGEPROFILER_H
+
+#include <log4cplus/config.hxx>
+
+#if defined (LOG4CPLUS_HAVE_PRAGMA_ONCE)
+#pragma once
+#endif
+
+#if ! defined (INSIDE_LOG4CPLUS)
+#  error "This header must not be be used outside log4cplus' implementation files."
+#endif
+
+#include <log4cplus/tstring.h>
+#include <log4cplus/thread/syncprims.h>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <map>
+
+#if defined (__x86_64__) || defined (__i386__)
+#include <x86intrin.h>
+#elif defined (_M_X64) || defined (_M_IX86)
+#include <intrin.h>
+#endif
+
+
+namespace log4cplus::internal {
+
+
+//! Stages of the logging pipeline measured by the stage profiler.
+enum profiled_stage
+{
+    STAGE_ENABLED_CHECK,
+    STAGE_MESSAGE_BUILD,
+    STAGE_EVENT_CONSTRUCTION,
+    STAGE_FILTER,
+    STAGE_LOCK_WAIT,
+    STAGE_LAYOUT,
+    STAGE_SINK_IO,
+    STAGE_COUNT
+};
+
+
+//! \return Current value of the cheapest available cycle counter.
+inline
+std::uint64_t
+profiler_ticks ()
+{
+#if defined (__x86_64__) || defined (__i386__) \
+    || defined (_M_X64) || defined (_M_IX86)
+    return __rdtsc ();
+#elif defined (__aarch64__) && defined (__GNUC__)
+    std::uint64_t ticks;
+    __asm__ __volatile__ ("mrs %0, cntvct_el0" : "=r" (ticks));
+    return ticks;
+#else
+    return static_cast<std::uint64_t>(
+        std::chrono::steady_clock::now ().time_since_epoch ().count ());
+#endif
+}
+
+
+struct stage_stats
+{
+    std::uint64_t samples = 0;
+    std::uint64_t ticks = 0;
+};
+
+
+typedef std::array<stage_stats, STAGE_COUNT> stage_row;
+
+//! Rows of the profile keyed by logger or appender name.
+typedef std::map<tstring, stage_row> stage_table;
+
+
+//! Sampling interval set by helpers::setStageProfilerSampleInterval().
+extern std::atomic<unsigned> stage_profiler_interval;
+
+
+//! Per-thread accumulators of the stage profiler. They are registered
+//! globally so that helpers::dumpStageProfile() can sum them and are
+//! merged into global totals when the thread ends.
+struct stage_profiler_data
+{
+    stage_profiler_data ();
+    ~stage_profiler_data ();
+
+    //! Called at the start of each enabled check.
+    //! \return True if the event is sampled.
+    bool
+    start_event ()
+    {
+        sampling = false;
+        if (--countdown != 0)
+            return false;
+
+        countdown = stage_profiler_interval.load (std::memory_order_relaxed);
+        return true;
+    }
+
+    //! Records ticks from <code>since</code> till now as stage
+    //! <code>stage</code> of logger <code>name</code>.
+    //! \return The current ticks.
+    std::uint64_t
+    lap_logger (tstring const & name, profiled_stage stage,
+        std::uint64_t since)
+    {
+        std::uint64_t const now = profiler_ticks ();
+        record (loggers, name, stage, now - since);
+        return now;
+    }
+
+    //! Same as lap_logger() for appender <code>name</code>.
+    std::uint64_t
+    lap_appender (tstring const & name, profiled_stage stage,
+        std::uint64_t since)
+    {
+        std::uint64_t const now = profiler_ticks ();
+        record (appenders, name, stage, now - since);
+        return now;
+    }
+
+    void record (stage_table & table, tstring const & name,
+        profiled_stage stage, std::uint64_t ticks);
+
+    //! Enabled checks till the next sampled one.
+    unsigned countdown;
+
+    //! True while the current event is being sampled.
+    bool sampling;
+
+    //! Ticks at the end of the enabled check of the sampled event.
+    std::uint64_t mark;
+
+    //! Ticks spent in layouts during the current append.
+    std::uint64_t layout_ticks;
+
+    //! Protects the tables against helpers::dumpStageProfile().
+    thread::Mutex mutex;
+
+    stage_table loggers;
+    stage_table appenders;
+
+private:
+    stage_profiler_data (stage_profiler_data const &) = delete;
+    stage_profiler_data & operator = (stage_profiler_data const &) = delete;
+};
+
+
+//! Writes the profile into std::cerr if there are any samples.
+void dump_stage_profile_at_exit ();
+
+
+} // namespace log4cplus::internal
+
+#endif // LOG4CPLUS_INTERNAL_STAGEPROFILER_H
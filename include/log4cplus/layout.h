@@ -66,6 +66,67 @@ namespace log4cplus {
     }
 
 
+    /**
+     * Output of a layout as a list of segments. Literals and short fields
+     * are kept in a scratch buffer owned by this object. Long fields are
+     * kept as references to strings owned by the formatted event, so
+     * they are not copied before they are written. The segments are
+     * valid only as long as the event is.
+     */
+    class LOG4CPLUS_EXPORT LayoutSegments
+    {
+    public:
+        //! Referenced text shorter than this is copied into the scratch
+        //! buffer instead.
+        static std::size_t const referenceThreshold = 256;
+
+        LayoutSegments();
+        ~LayoutSegments();
+
+        //! Removes all segments.
+        void clear();
+
+        //! Appends copy of <code>text</code>.
+        void appendText(log4cplus::tstring_view const & text);
+
+        //! Appends <code>count</code> copies of <code>ch</code>.
+        void appendFill(std::size_t count, log4cplus::tchar ch);
+
+        //! Appends reference to <code>text</code>, which must stay
+        //! valid until the segments are written.
+        void appendReference(log4cplus::tstring_view const & text);
+
+        //! \return Number of segments.
+        std::size_t size() const
+        { return segments.size(); }
+
+        //! \return Text of segment <code>i</code>.
+        log4cplus::tstring_view operator [] (std::size_t i) const;
+
+        //! Writes all segments to <code>output</code>.
+        void writeTo(log4cplus::tostream & output) const;
+
+        //! \return Concatenation of all segments.
+        log4cplus::tstring str() const;
+
+    private:
+        struct Segment
+        {
+            //! Referenced text or NULL for text in the scratch buffer.
+            log4cplus::tchar const * ptr;
+            std::size_t offset;
+            std::size_t length;
+        };
+
+        //! \return Segment of the scratch buffer to append text to.
+        Segment & scratchSegment();
+
+        log4cplus::tstring scratch;
+        std::vector<Segment> segments;
+    };
+
+
+
     /**
      * This class is used to layout strings sent to an {@link
      * log4cplus::Appender}.
@@ -80,9 +141,43 @@ namespace log4cplus {
         virtual void formatAndAppend(log4cplus::tostream& output,
             const log4cplus::spi::InternalLoggingEvent& event) = 0;
 
+        /**
+         * Appends the formatted event to <code>output</code> as list of
+         * segments, some of which may refer to strings owned by the
+         * event. The default implementation appends the output of
+         * formatAndAppend() as one segment.
+         */
+        virtual void formatSegments(LayoutSegments & output,
+            const log4cplus::spi::InternalLoggingEvent& event);
+
+        /**
+         * Returns a string which identifies configuration of this layout.
+         * Two layouts with the same non-empty fingerprint produce
+         * identical output for the same event, which allows appenders to
+         * share one rendering of an event. Empty fingerprint, the
+         * default, means the output of this layout must not be shared.
+         */
+        log4cplus::tstring const & getFingerprint() const
+        { return fingerprint; }
+
+        /**
+         * Returns combination of
+         * spi::InternalLoggingEvent::ThreadSpecificData flags selecting
+         * the thread specific data this layout prints. Asynchronous
+         * appenders capture only those. All of them by default.
+         */
+        unsigned getRequiredThreadSpecificData() const
+        { return requiredThreadSpecificData; }
+
     protected:
         LogLevelManager& llmCache;
 
+        //! \sa getFingerprint()
+        log4cplus::tstring fingerprint;
+
+        //! \sa getRequiredThreadSpecificData()
+        unsigned requiredThreadSpecificData;
+
     private:
       // Disable copy
         Layout(const Layout&);
@@ -185,12 +280,15 @@ namespace log4cplus {
 
     protected:
        log4cplus::tstring dateFormat;
+       helpers::TimeFormatter dateFormatter;
        bool use_gmtime = false;
        bool thread_printing = true;
        bool category_prefixing = true;
        bool context_printing = true;
 
     private:
+        LOG4CPLUS_PRIVATE void updateFingerprint();
+
       // Disallow copying of instances of this class
         TTCCLayout(const TTCCLayout&);
         TTCCLayout& operator=(const TTCCLayout&);
@@ -262,6 +360,16 @@ namespace log4cplus {
      * </tr>
      *
      * <tr>
+     *   <td align=center><b>B</b></td>
+     *
+     *   <td>Used to output the binary payload attached to the logging
+     *   event by Logger::logBinary(). It takes optional encoding
+     *   parameter, <b>%B{hex}</b> (the default) or
+     *   <b>%B{base64}</b>. Events without payload output nothing.
+     *   </td>
+     * </tr>
+     *
+     * <tr>
      *   <td align=center><b>c</b></td>
      *
      *   <td>Used to output the logger of the logging event. The
@@ -625,6 +733,13 @@ namespace log4cplus {
         virtual void formatAndAppend(log4cplus::tostream& output,
                                      const log4cplus::spi::InternalLoggingEvent& event);
 
+        /**
+         * Message and MDC values selected by key are referenced, not
+         * copied, when they are long.
+         */
+        virtual void formatSegments(LayoutSegments & output,
+            const log4cplus::spi::InternalLoggingEvent& event);
+
     protected:
         void init(const log4cplus::tstring& pattern, unsigned ndcMaxDepth = 0);
 
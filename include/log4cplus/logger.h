@@ -184,6 +184,20 @@ namespace log4cplus
 
         void log(spi::InternalLoggingEvent const &) const;
 
+        /**
+         * Logs <code>message</code> with <code>size</code> bytes at
+         * <code>data</code> attached to the event as binary payload, if
+         * this logger is enabled for <code>ll</code>. The bytes are
+         * encoded only by layouts which output them, e.g., by
+         * <code>%B</code> of PatternLayout, and they are sent raw by
+         * SocketAppender. They are copied only if the event is.
+         */
+        void logBinary(LogLevel ll, const log4cplus::tstring_view& message,
+            void const * data, std::size_t size,
+            const char* file = LOG4CPLUS_CALLER_FILE (),
+            int line = LOG4CPLUS_CALLER_LINE (),
+            const char* function = LOG4CPLUS_CALLER_FUNCTION ()) const;
+
         /**
          * This method creates a new logging event and logs the event
          * without further checks.
@@ -208,6 +222,16 @@ namespace log4cplus
          */
         void callAppenders(const spi::InternalLoggingEvent& event) const;
 
+        /**
+         * Log <code>count</code> pre-built events without further checks,
+         * like forcedLog() would for each of them, but resolve the
+         * appenders only once and hand each appender the whole batch.
+         *
+         * @see Hierarchy::logBatch()
+         */
+        void logBatch(spi::InternalLoggingEvent const * events,
+            std::size_t count) const;
+
         /**
          * Starting from this logger, search the logger hierarchy for a
          * "set" LogLevel and return it. Otherwise, return the LogLevel of the
@@ -230,6 +254,27 @@ namespace log4cplus
          */
         void setLogLevel(LogLevel ll);
 
+        /**
+         * Starting from this logger, search the logger hierarchy for a
+         * non-zero maximal message size and return it. Zero means that
+         * messages are not limited.
+         */
+        std::size_t getChainedMaxMessageSize() const;
+
+        /**
+         * Returns the maximal message size assigned to this logger, zero
+         * if none is assigned.
+         */
+        std::size_t getMaxMessageSize() const;
+
+        /**
+         * Set the maximal size of messages logged through this logger and
+         * its descendants that do not set their own. Longer messages are
+         * truncated and marked before they are copied into the logging
+         * event. Setting it on the root logger sets the global limit.
+         */
+        void setMaxMessageSize(std::size_t size);
+
         /**
          * Return the the {@link Hierarchy} where this <code>Logger</code> instance is
          * attached.
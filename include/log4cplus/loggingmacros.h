@@ -34,8 +34,10 @@
 #include <log4cplus/streams.h>
 #include <log4cplus/logger.h>
 #include <log4cplus/helpers/snprintf.h>
+#include <log4cplus/helpers/messagebuilder.h>
 #include <log4cplus/tracelogger.h>
 #include <sstream>
+#include <type_traits>
 #include <utility>
 
 
@@ -125,6 +127,7 @@ LOG4CPLUS_EXPORT void clear_tostringstream (tostringstream &);
 
 
 LOG4CPLUS_EXPORT log4cplus::tostringstream & get_macro_body_oss ();
+LOG4CPLUS_EXPORT log4cplus::helpers::MessageBuilder & get_macro_body_builder ();
 LOG4CPLUS_EXPORT log4cplus::helpers::snprintf_buf & get_macro_body_snprintf_buf ();
 LOG4CPLUS_EXPORT void macro_forced_log (log4cplus::Logger const &,
     log4cplus::LogLevel, log4cplus::tstring_view const &, char const *, int,
@@ -158,6 +161,11 @@ LOG4CPLUS_EXPORT void macro_forced_log (log4cplus::Logger const &,
 #  endif
 #endif
 
+// The file name and line passed by the macros below also identify the
+// callsite for the callsite profiler (LOG4CPLUS_ENABLE_CALLSITE_PROFILER);
+// the function name is used instead if LOG4CPLUS_DISABLE_FILE_MACRO is
+// defined. The profiler lives in the library, so the macros do not
+// change with it.
 #undef LOG4CPLUS_MACRO_FILE
 #define LOG4CPLUS_MACRO_FILE() nullptr
 #if ! defined (LOG4CPLUS_DISABLE_FILE_MACRO)
@@ -208,6 +216,23 @@ LOG4CPLUS_EXPORT void macro_forced_log (log4cplus::Logger const &,
 #endif
 
 
+// Either build messages of the stream macros using
+// helpers::MessageBuilder, or using ostringstream.
+#if defined (LOG4CPLUS_MACRO_ENABLE_MESSAGE_BUILDER)
+#  if defined (LOG4CPLUS_MACRO_DISABLE_TLS)
+#    define LOG4CPLUS_MACRO_INSTANTIATE_MESSAGE_BUF(var)    \
+    log4cplus::helpers::MessageBuilder var
+#  else
+#    define LOG4CPLUS_MACRO_INSTANTIATE_MESSAGE_BUF(var)    \
+    log4cplus::helpers::MessageBuilder & var                \
+        = log4cplus::detail::get_macro_body_builder ()
+#  endif
+#else
+#  define LOG4CPLUS_MACRO_INSTANTIATE_MESSAGE_BUF(var)      \
+    LOG4CPLUS_MACRO_INSTANTIATE_OSTRINGSTREAM (var)
+#endif
+
+
 #define LOG4CPLUS_MACRO_BODY(logger, logEvent, logLevel)                \
     LOG4CPLUS_SUPPRESS_DOWHILE_WARNING()                                \
     do {                                                                \
@@ -215,7 +240,7 @@ LOG4CPLUS_EXPORT void macro_forced_log (log4cplus::Logger const &,
             = log4cplus::detail::macros_get_logger (logger);            \
         if (LOG4CPLUS_MACRO_LOGLEVEL_PRED (                             \
                 _l.isEnabledFor (log4cplus::logLevel), logLevel)) {     \
-            LOG4CPLUS_MACRO_INSTANTIATE_OSTRINGSTREAM (_log4cplus_buf); \
+            LOG4CPLUS_MACRO_INSTANTIATE_MESSAGE_BUF (_log4cplus_buf);   \
             _log4cplus_buf << logEvent;                                 \
             log4cplus::detail::macro_forced_log (_l,                    \
                 log4cplus::logLevel, _log4cplus_buf.str(),              \
@@ -250,7 +275,8 @@ LOG4CPLUS_EXPORT void macro_forced_log (log4cplus::Logger const &,
                 _l.isEnabledFor (log4cplus::logLevel), logLevel)) {     \
             LOG4CPLUS_MACRO_INSTANTIATE_SNPRINTF_BUF (_snpbuf);         \
             log4cplus::tchar const * _logEvent                          \
-                = _snpbuf.print (__VA_ARGS__);                          \
+                = _snpbuf.print_capped (                                \
+                    _l.getChainedMaxMessageSize (), __VA_ARGS__);       \
             log4cplus::detail::macro_forced_log (_l,                    \
                 log4cplus::logLevel, _logEvent,                         \
                 LOG4CPLUS_MACRO_FILE (), __LINE__,                      \
@@ -259,6 +285,70 @@ LOG4CPLUS_EXPORT void macro_forced_log (log4cplus::Logger const &,
     } while (false)                                                     \
     LOG4CPLUS_RESTORE_DOWHILE_WARNING()
 
+namespace log4cplus
+{
+
+namespace detail
+{
+
+//! Logs message returned by <code>callable</code>. The result can be a
+//! string, a string view, a C string or anything else which can be
+//! streamed into an <code>ostream</code>.
+template <typename Callable>
+void
+macro_forced_log_lazy (log4cplus::Logger const & logger,
+    log4cplus::LogLevel ll, char const * file, int line,
+    char const * function, Callable && callable)
+{
+    // Evaluate the callable before touching the thread-local message
+    // buffer; the callable may log, too.
+    auto && message = std::forward<Callable> (callable) ();
+    using message_type = std::decay_t<decltype (message)>;
+    if constexpr (std::is_convertible_v<message_type, tchar const *>)
+        macro_forced_log (logger, ll, static_cast<tchar const *> (message),
+            file, line, function);
+    else if constexpr (std::is_convertible_v<message_type const &,
+            tstring_view>)
+        macro_forced_log (logger, ll, tstring_view (message), file, line,
+            function);
+    else
+    {
+        LOG4CPLUS_MACRO_INSTANTIATE_MESSAGE_BUF (_log4cplus_buf);
+        _log4cplus_buf << message;
+        macro_forced_log (logger, ll, _log4cplus_buf.str (), file, line,
+            function);
+    }
+}
+
+} // namespace detail
+
+} // namespace log4cplus
+
+
+#define LOG4CPLUS_MACRO_LAZY_BODY(logger, logLevel, ...)                \
+    LOG4CPLUS_SUPPRESS_DOWHILE_WARNING()                                \
+    do {                                                                \
+        log4cplus::Logger const & _l                                    \
+            = log4cplus::detail::macros_get_logger (logger);            \
+        if (LOG4CPLUS_MACRO_LOGLEVEL_PRED (                             \
+                _l.isEnabledFor (log4cplus::logLevel), logLevel)) {     \
+            log4cplus::detail::macro_forced_log_lazy (_l,               \
+                log4cplus::logLevel, LOG4CPLUS_MACRO_FILE (), __LINE__, \
+                LOG4CPLUS_MACRO_FUNCTION (), __VA_ARGS__);              \
+        }                                                               \
+    } while (false)                                                     \
+    LOG4CPLUS_RESTORE_DOWHILE_WARNING()
+
+/**
+ * The <code>LOG4CPLUS_*_LAZY(logger, callable)</code> macros call
+ * <code>callable</code> without arguments and log its result, but only
+ * when the event would reach at least one appender, i.e., when the log
+ * level passes both the logger's log level and the appenders'
+ * thresholds. Use them instead of an explicit
+ * <code>isEnabledFor()</code> check around expensive diagnostics:
+ * <code>LOG4CPLUS_DEBUG_LAZY(logger, [&] { return dump(state); });</code>
+ */
+
 /**
  * @def LOG4CPLUS_TRACE(logger, logEvent) This macro creates a
  * TraceLogger to log a TRACE_LOG_LEVEL message to <code>logger</code>
@@ -276,12 +366,15 @@ LOG4CPLUS_EXPORT void macro_forced_log (log4cplus::Logger const &,
     LOG4CPLUS_MACRO_STR_BODY (logger, logEvent, TRACE_LOG_LEVEL)
 #define LOG4CPLUS_TRACE_FMT(logger, ...)                                \
     LOG4CPLUS_MACRO_FMT_BODY (logger, TRACE_LOG_LEVEL, __VA_ARGS__)
+#define LOG4CPLUS_TRACE_LAZY(logger, ...)                               \
+    LOG4CPLUS_MACRO_LAZY_BODY (logger, TRACE_LOG_LEVEL, __VA_ARGS__)
 
 #else
 #define LOG4CPLUS_TRACE_METHOD(logger, logEvent) LOG4CPLUS_DOWHILE_NOTHING()
 #define LOG4CPLUS_TRACE(logger, logEvent) LOG4CPLUS_DOWHILE_NOTHING()
 #define LOG4CPLUS_TRACE_STR(logger, logEvent) LOG4CPLUS_DOWHILE_NOTHING()
 #define LOG4CPLUS_TRACE_FMT(logger, logFmt, ...) LOG4CPLUS_DOWHILE_NOTHING()
+#define LOG4CPLUS_TRACE_LAZY(logger, ...) LOG4CPLUS_DOWHILE_NOTHING()
 
 #endif
 
@@ -297,11 +390,14 @@ LOG4CPLUS_EXPORT void macro_forced_log (log4cplus::Logger const &,
     LOG4CPLUS_MACRO_STR_BODY (logger, logEvent, DEBUG_LOG_LEVEL)
 #define LOG4CPLUS_DEBUG_FMT(logger, ...)                                \
     LOG4CPLUS_MACRO_FMT_BODY (logger, DEBUG_LOG_LEVEL, __VA_ARGS__)
+#define LOG4CPLUS_DEBUG_LAZY(logger, ...)                               \
+    LOG4CPLUS_MACRO_LAZY_BODY (logger, DEBUG_LOG_LEVEL, __VA_ARGS__)
 
 #else
 #define LOG4CPLUS_DEBUG(logger, logEvent) LOG4CPLUS_DOWHILE_NOTHING()
 #define LOG4CPLUS_DEBUG_STR(logger, logEvent) LOG4CPLUS_DOWHILE_NOTHING()
 #define LOG4CPLUS_DEBUG_FMT(logger, ...) LOG4CPLUS_DOWHILE_NOTHING()
+#define LOG4CPLUS_DEBUG_LAZY(logger, ...) LOG4CPLUS_DOWHILE_NOTHING()
 
 #endif
 
@@ -317,11 +413,14 @@ LOG4CPLUS_EXPORT void macro_forced_log (log4cplus::Logger const &,
     LOG4CPLUS_MACRO_STR_BODY (logger, logEvent, INFO_LOG_LEVEL)
 #define LOG4CPLUS_INFO_FMT(logger, ...)                                 \
     LOG4CPLUS_MACRO_FMT_BODY (logger, INFO_LOG_LEVEL, __VA_ARGS__)
+#define LOG4CPLUS_INFO_LAZY(logger, ...)                                \
+    LOG4CPLUS_MACRO_LAZY_BODY (logger, INFO_LOG_LEVEL, __VA_ARGS__)
 
 #else
 #define LOG4CPLUS_INFO(logger, logEvent) LOG4CPLUS_DOWHILE_NOTHING()
 #define LOG4CPLUS_INFO_STR(logger, logEvent) LOG4CPLUS_DOWHILE_NOTHING()
 #define LOG4CPLUS_INFO_FMT(logger, ...) LOG4CPLUS_DOWHILE_NOTHING()
+#define LOG4CPLUS_INFO_LAZY(logger, ...) LOG4CPLUS_DOWHILE_NOTHING()
 
 #endif
 
@@ -337,11 +436,14 @@ LOG4CPLUS_EXPORT void macro_forced_log (log4cplus::Logger const &,
     LOG4CPLUS_MACRO_STR_BODY (logger, logEvent, WARN_LOG_LEVEL)
 #define LOG4CPLUS_WARN_FMT(logger, ...)                                 \
     LOG4CPLUS_MACRO_FMT_BODY (logger, WARN_LOG_LEVEL, __VA_ARGS__)
+#define LOG4CPLUS_WARN_LAZY(logger, ...)                                \
+    LOG4CPLUS_MACRO_LAZY_BODY (logger, WARN_LOG_LEVEL, __VA_ARGS__)
 
 #else
 #define LOG4CPLUS_WARN(logger, logEvent) LOG4CPLUS_DOWHILE_NOTHING()
 #define LOG4CPLUS_WARN_STR(logger, logEvent) LOG4CPLUS_DOWHILE_NOTHING()
 #define LOG4CPLUS_WARN_FMT(logger, ...) LOG4CPLUS_DOWHILE_NOTHING()
+#define LOG4CPLUS_WARN_LAZY(logger, ...) LOG4CPLUS_DOWHILE_NOTHING()
 
 #endif
 
@@ -357,11 +459,14 @@ LOG4CPLUS_EXPORT void macro_forced_log (log4cplus::Logger const &,
     LOG4CPLUS_MACRO_STR_BODY (logger, logEvent, ERROR_LOG_LEVEL)
 #define LOG4CPLUS_ERROR_FMT(logger, ...)                                \
     LOG4CPLUS_MACRO_FMT_BODY (logger, ERROR_LOG_LEVEL, __VA_ARGS__)
+#define LOG4CPLUS_ERROR_LAZY(logger, ...)                               \
+    LOG4CPLUS_MACRO_LAZY_BODY (logger, ERROR_LOG_LEVEL, __VA_ARGS__)
 
 #else
 #define LOG4CPLUS_ERROR(logger, logEvent) LOG4CPLUS_DOWHILE_NOTHING()
 #define LOG4CPLUS_ERROR_STR(logger, logEvent) LOG4CPLUS_DOWHILE_NOTHING()
 #define LOG4CPLUS_ERROR_FMT(logger, ...) LOG4CPLUS_DOWHILE_NOTHING()
+#define LOG4CPLUS_ERROR_LAZY(logger, ...) LOG4CPLUS_DOWHILE_NOTHING()
 
 #endif
 
@@ -377,11 +482,14 @@ LOG4CPLUS_EXPORT void macro_forced_log (log4cplus::Logger const &,
     LOG4CPLUS_MACRO_STR_BODY (logger, logEvent, FATAL_LOG_LEVEL)
 #define LOG4CPLUS_FATAL_FMT(logger, ...)                                \
     LOG4CPLUS_MACRO_FMT_BODY (logger, FATAL_LOG_LEVEL, __VA_ARGS__)
+#define LOG4CPLUS_FATAL_LAZY(logger, ...)                               \
+    LOG4CPLUS_MACRO_LAZY_BODY (logger, FATAL_LOG_LEVEL, __VA_ARGS__)
 
 #else
 #define LOG4CPLUS_FATAL(logger, logEvent) LOG4CPLUS_DOWHILE_NOTHING()
 #define LOG4CPLUS_FATAL_STR(logger, logEvent) LOG4CPLUS_DOWHILE_NOTHING()
 #define LOG4CPLUS_FATAL_FMT(logger, ...) LOG4CPLUS_DOWHILE_NOTHING()
+#define LOG4CPLUS_FATAL_LAZY(logger, ...) LOG4CPLUS_DOWHILE_NOTHING()
 
 #endif
 
@@ -49,6 +49,7 @@ namespace log4cplus {
 
       // Methods
         virtual void close();
+        virtual unsigned getRequiredThreadSpecificData() const;
 
     protected:
         virtual void append(const log4cplus::spi::InternalLoggingEvent& event);
@@ -35,11 +35,27 @@
 #include <log4cplus/thread/syncprims.h>
 #include <log4cplus/thread/threads.h>
 #include <log4cplus/helpers/connectorthread.h>
+#include <atomic>
+#include <deque>
+#include <string>
+#include <utility>
 
 
 namespace log4cplus
 {
 
+    //! Version of the message format written by helpers::convertToBuffer().
+    int const LOG4CPLUS_MESSAGE_VERSION = 3;
+
+    //! Version byte of the sequence header written by
+    //! helpers::appendSequenceHeader(). It precedes messages sent in
+    //! acknowledged mode and forms whole acknowledgement messages.
+    int const LOG4CPLUS_SEQUENCED_MESSAGE_VERSION = 4;
+
+    //! Size of the sequence header: version byte, session and sequence
+    //! number.
+    std::size_t const LOG4CPLUS_SEQUENCE_HEADER_SIZE = 1 + 2 * 4;
+
 #ifndef UNICODE
     std::size_t const LOG4CPLUS_MAX_MESSAGE_SIZE = 8*1024;
 #else
@@ -83,6 +99,15 @@ namespace log4cplus
      *   <li>On the other hand, if the network link is up, but the server
      *   is down, the client will not be blocked when making log requests
      *   but the log events will be lost due to server unavailability.
+     *
+     *   <li>In acknowledged mode each event is prefixed with a session
+     *   identifier and a sequence number and kept until the server
+     *   acknowledges it. The server acknowledges cumulatively, every few
+     *   events or when its input drains, and the acknowledgements are
+     *   picked up without waiting for them on following appends. Events
+     *   not yet acknowledged are sent again after reconnection and the
+     *   server drops duplicates, so no event is lost as long as no more
+     *   than <tt>MaxUnacknowledgedEvents</tt> events are outstanding.
      * </ul>
      *
      * <h3>Properties</h3>
@@ -100,6 +125,16 @@ namespace log4cplus
      * <dd>Boolean value specifying whether to use IPv6 (true) or IPv4
      * (false). Default value is false.</dd>
      *
+     * <dt><tt>Acknowledged</tt></dt>
+     * <dd>Boolean value enabling acknowledged mode. The server must
+     * support it, like <tt>loggingserver</tt> does. Default value is
+     * false.</dd>
+     *
+     * <dt><tt>MaxUnacknowledgedEvents</tt></dt>
+     * <dd>Number of unacknowledged events kept for resending in
+     * acknowledged mode. When it is exceeded the oldest events are
+     * dropped. Default value is 1000.</dd>
+     *
      * </dl>
      */
     class LOG4CPLUS_EXPORT SocketAppender
@@ -112,7 +147,8 @@ namespace log4cplus
       // Ctors
         SocketAppender(const log4cplus::tstring& host, unsigned short port,
             const log4cplus::tstring& serverName = tstring(),
-            bool ipv6 = false);
+            bool ipv6 = false, bool acknowledged = false,
+            std::size_t maxUnacknowledgedEvents = 1000);
         SocketAppender(const log4cplus::helpers::Properties & properties);
 
       // Dtor
@@ -121,11 +157,26 @@ namespace log4cplus
       // Methods
         virtual void close();
 
+        //! \return Number of events kept until the server acknowledges
+        //! them.
+        std::size_t getUnacknowledgedEventCount() const;
+
+        //! \return Number of unacknowledged events dropped because there
+        //! were more than <tt>MaxUnacknowledgedEvents</tt> of them.
+        unsigned long long getDroppedEventCount() const;
+
     protected:
         void openSocket();
         void initConnector ();
         virtual void append(const spi::InternalLoggingEvent& event);
 
+        //! Reads acknowledgements that have already arrived and forgets
+        //! acknowledged events. Does not block.
+        void readAcknowledgements();
+
+        //! Sends all unacknowledged events again after reconnection.
+        bool resendUnacknowledged();
+
       // Data
         log4cplus::helpers::Socket socket;
         log4cplus::tstring host;
@@ -133,6 +184,18 @@ namespace log4cplus
         log4cplus::tstring serverName;
         bool ipv6 = false;
 
+        bool acknowledged = false;
+        std::size_t maxUnacknowledgedEvents = 1000;
+        unsigned int session = 0;
+        unsigned int nextSequence = 1;
+        //! Sequence numbers and complete messages, including the size and
+        //! the sequence header, of events not acknowledged yet.
+        std::deque<std::pair<unsigned int, std::string>> unacknowledged;
+        //! Received part of acknowledgement which has not arrived whole.
+        std::string partialAcknowledgement;
+        std::atomic<std::size_t> unacknowledgedCount {0};
+        std::atomic<unsigned long long> droppedEvents {0};
+
 #if ! defined (LOG4CPLUS_SINGLE_THREADED)
         virtual thread::Mutex const & ctcGetAccessMutex () const;
         virtual helpers::Socket & ctcGetSocket ();
@@ -157,6 +220,27 @@ namespace log4cplus
 
         LOG4CPLUS_EXPORT
         log4cplus::spi::InternalLoggingEvent readFromBuffer(SocketBuffer& buffer);
+
+        //! Appends sequence header of acknowledged mode to
+        //! <code>buffer</code>.
+        LOG4CPLUS_EXPORT
+        void appendSequenceHeader (SocketBuffer & buffer,
+            unsigned int session, unsigned int sequence);
+
+        //! Reads sequence header if <code>buffer</code> starts with one.
+        //! \return true if the header was read.
+        LOG4CPLUS_EXPORT
+        bool readSequenceHeader (SocketBuffer & buffer,
+            unsigned int & session, unsigned int & sequence);
+
+        //! \return true if <code>sequence</code> comes after
+        //! <code>last</code>, taking wrap around into account.
+        inline
+        bool
+        isSequenceAfter (unsigned int sequence, unsigned int last)
+        {
+            return static_cast<int>(sequence - last) > 0;
+        }
     } // end namespace helpers
 
 } // end namespace log4cplus
@@ -0,0 +1,156 @@
+// -*- C++ -*-
+//
+//  Copyright (C) 2026, Vaclav Zeman. All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without modifica-
+//  tion, are permitted provided that the following conditions are met:
+//
+//  1. Redistributions of  source code must  retain the above copyright  notice,
+//     this list of conditions and the following disclaimer.
+//
+//  2. Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//
+//  THIS SOFTWARE IS PROVIDED ``AS IS'' AND ANY EXPRESSED OR IMPLIED WARRANTIES,
+//  INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+//  FITNESS  FOR A PARTICULAR  PURPOSE ARE  DISCLAIMED.  IN NO  EVENT SHALL  THE
+//  APACHE SOFTWARE  FOUNDATION  OR ITS CONTRIBUTORS  BE LIABLE FOR  ANY DIRECT,
+//  INDIRECT, INCIDENTAL, SPECIAL,  EXEMPLARY, OR CONSEQUENTIAL  DAMAGES (INCLU-
+//  DING, BUT NOT LIMITED TO, PROCUREMENT  OF SUBSTITUTE GOODS OR SERVICES; LOSS
+//  OF USE, DATA, OR  PROFITS; OR BUSINESS  INTERRUPTION)  HOWEVER CAUSED AND ON
+//  ANY  THEORY OF LIABILITY,  WHETHER  IN CONTRACT,  STRICT LIABILITY,  OR TORT
+//  (INCLUDING  NEGLIGENCE OR  OTHERWISE) ARISING IN  ANY WAY OUT OF THE  USE OF
+//  THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+/** @file */
+
+#ifndef LOG4CPLUS_SOCKETHUBAPPENDER_H
+#define LOG4CPLUS_SOCKETHUBAPPENDER_H
+
+#include <log4cplus/config.hxx>
+
+#if defined (LOG4CPLUS_HAVE_PRAGMA_ONCE)
+#pragma once
+#endif
+
+#ifndef LOG4CPLUS_SINGLE_THREADED
+
+#include <log4cplus/appender.h>
+#include <log4cplus/helpers/housekeeping.h>
+#include <log4cplus/helpers/socket.h>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+namespace log4cplus
+{
+
+
+/**
+   Listens on a port and streams events to every connected client, in the
+   format used by SocketAppender.
+
+   Each event is serialized once, on the logging thread, and the result is
+   shared by all clients. Each client has its own bounded queue and its own
+   sending thread, so a slow client does not slow down the logging thread
+   or the other clients. When a client's queue is full, either its oldest
+   queued event is dropped or the client is disconnected.
+
+   <h3>Properties</h3>
+   <dl>
+   <dt><tt>port</tt></dt>
+   <dd>Port to listen on. Default value is 4560. Port 0 lets the system
+   choose a free port; see getPort().</dd>
+
+   <dt><tt>host</tt></dt>
+   <dd>Address to listen on. Default is all addresses.</dd>
+
+   <dt><tt>ServerName</tt></dt>
+   <dd>Host name of event's origin prepended to each event.</dd>
+
+   <dt><tt>IPv6</tt></dt>
+   <dd>Boolean value specifying whether to use IPv6 (true) or IPv4
+   (false). Default value is false.</dd>
+
+   <dt><tt>MaxQueuedEvents</tt></dt>
+   <dd>Maximal number of events queued for one client. Default value is
+   1000.</dd>
+
+   <dt><tt>DropSlowClients</tt></dt>
+   <dd>Boolean value specifying whether a client whose queue is full is
+   disconnected (true) or loses its oldest queued event (false). Default
+   value is false.</dd>
+   </dl>
+ */
+class LOG4CPLUS_EXPORT SocketHubAppender
+    : public Appender
+{
+public:
+    SocketHubAppender (unsigned short port,
+        tstring const & serverName = tstring (), bool ipv6 = false,
+        std::size_t maxQueuedEvents = 1000, bool dropSlowClients = false);
+    SocketHubAppender (helpers::Properties const &);
+    virtual ~SocketHubAppender ();
+
+    virtual void close ();
+
+    virtual unsigned getRequiredThreadSpecificData () const;
+
+    //! \return Port the appender listens on.
+    unsigned short getPort () const;
+
+    //! \return Number of connected clients.
+    std::size_t getClientCount () const;
+
+    //! \return Number of events dropped for slow clients.
+    unsigned long long getDroppedEventCount () const;
+
+protected:
+    virtual void append (spi::InternalLoggingEvent const & event);
+
+private:
+    class Client;
+
+    void start (tstring const & host);
+    void acceptLoop ();
+
+    //! Moves disconnected clients, or all clients, to
+    //! <code>retiredClients</code>.
+    void retireClients (bool all);
+
+    //! Stops threads of retired clients. It joins them, so it must not
+    //! be called while the appender is locked.
+    void reapClients ();
+
+    unsigned short port;
+    tstring serverName;
+    bool ipv6;
+    std::size_t maxQueuedEvents;
+    bool dropSlowClients;
+
+    std::unique_ptr<helpers::ServerSocket> serverSocket;
+    std::thread acceptThread;
+    std::atomic<bool> stopping;
+    helpers::HousekeepingTaskId reaperTask;
+
+    mutable std::mutex clientsMutex;
+    std::vector<std::shared_ptr<Client> > clients;
+    std::vector<std::shared_ptr<Client> > retiredClients;
+    std::atomic<std::size_t> clientCount;
+    std::atomic<unsigned long long> droppedEvents;
+
+    SocketHubAppender (SocketHubAppender const &) = delete;
+    SocketHubAppender & operator = (SocketHubAppender const &) = delete;
+};
+
+
+} // namespace log4cplus
+
+
+#endif // LOG4CPLUS_SINGLE_THREADED
+
+#endif // LOG4CPLUS_SOCKETHUBAPPENDER_H
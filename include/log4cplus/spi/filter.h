@@ -74,6 +74,30 @@ namespace log4cplus {
         LOG4CPLUS_EXPORT FilterResult checkFilter(const Filter* filter,
                                                   const InternalLoggingEvent& event);
 
+        /**
+         * Returns the lowest LogLevel, starting at <code>ll</code>, for
+         * which the filter chain might accept an event. If the filter
+         * chain denies events of all levels at or above <code>ll</code>
+         * then the maximum value of LogLevel is returned.
+         *
+         * Only filters whose decision depends solely on the log level
+         * (see Filter::decideLogLevel()) are taken into account. Any
+         * other filter is assumed to possibly accept the event.
+         *
+         * Note: <code>filter</code> can be NULL.
+         */
+        LOG4CPLUS_EXPORT LogLevel getLowestAcceptedLogLevel(
+            const Filter* filter, LogLevel ll);
+
+        /**
+         * Returns the union of InternalLoggingEvent::ThreadSpecificData
+         * flags required by the filters of the chain.
+         *
+         * Note: <code>filter</code> can be NULL.
+         */
+        LOG4CPLUS_EXPORT unsigned getRequiredThreadSpecificData(
+            const Filter* filter);
+
         typedef helpers::SharedObjectPtr<Filter> FilterPtr;
 
 
@@ -130,6 +154,27 @@ namespace log4cplus {
              */
             virtual FilterResult decide(const InternalLoggingEvent& event) const = 0;
 
+            /**
+             * If the decision of this filter depends only on the log level
+             * of the event, store the decision for events of log level
+             * <code>ll</code> into <code>result</code> and the lowest log
+             * level above <code>ll</code> at which the decision might
+             * change into <code>next</code>, then return <code>true</code>.
+             * The maximum value of LogLevel in <code>next</code> means
+             * that the decision does not change for any higher level.
+             *
+             * The default implementation returns <code>false</code>.
+             */
+            virtual bool decideLogLevel(LogLevel ll, FilterResult & result,
+                LogLevel & next) const;
+
+            /**
+             * Returns combination of InternalLoggingEvent::ThreadSpecificData
+             * flags selecting the thread specific data decide() looks at.
+             * The default implementation returns all of them.
+             */
+            virtual unsigned getRequiredThreadSpecificData() const;
+
           // Data
             /**
              * Points to the next filter in the filter chain.
@@ -157,6 +202,11 @@ namespace log4cplus {
              * {@link InternalLoggingEvent} parameter.
              */
             virtual FilterResult decide(const InternalLoggingEvent& event) const;
+
+            virtual bool decideLogLevel(LogLevel ll, FilterResult & result,
+                LogLevel & next) const;
+
+            virtual unsigned getRequiredThreadSpecificData() const;
         };
 
 
@@ -188,6 +238,11 @@ namespace log4cplus {
              */
             virtual FilterResult decide(const InternalLoggingEvent& event) const;
 
+            virtual bool decideLogLevel(LogLevel ll, FilterResult & result,
+                LogLevel & next) const;
+
+            virtual unsigned getRequiredThreadSpecificData() const;
+
         private:
           // Methods
             LOG4CPLUS_PRIVATE void init();
@@ -236,6 +291,11 @@ namespace log4cplus {
              */
             virtual FilterResult decide(const InternalLoggingEvent& event) const;
 
+            virtual bool decideLogLevel(LogLevel ll, FilterResult & result,
+                LogLevel & next) const;
+
+            virtual unsigned getRequiredThreadSpecificData() const;
+
         private:
           // Methods
             LOG4CPLUS_PRIVATE void init();
@@ -271,6 +331,8 @@ namespace log4cplus {
              */
             virtual FilterResult decide(const InternalLoggingEvent& event) const;
 
+            virtual unsigned getRequiredThreadSpecificData() const;
+
         private:
           // Methods
             LOG4CPLUS_PRIVATE void init();
@@ -337,6 +399,8 @@ namespace log4cplus {
                  */
                 virtual FilterResult decide(const InternalLoggingEvent& event) const;
 
+                virtual unsigned getRequiredThreadSpecificData() const;
+
             private:
               // Methods
                 LOG4CPLUS_PRIVATE void init();
@@ -383,6 +447,8 @@ namespace log4cplus {
                  */
                 virtual FilterResult decide(const InternalLoggingEvent& event) const;
 
+                virtual unsigned getRequiredThreadSpecificData() const;
+
             private:
               // Methods
                 LOG4CPLUS_PRIVATE void init();
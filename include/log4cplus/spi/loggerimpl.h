@@ -34,7 +34,9 @@
 #include <log4cplus/helpers/appenderattachableimpl.h>
 #include <log4cplus/helpers/pointer.h>
 #include <log4cplus/spi/loggerfactory.h>
+#include <atomic>
 #include <memory>
+#include <string_view>
 #include <vector>
 
 
@@ -70,15 +72,61 @@ namespace log4cplus {
              */
             virtual void callAppenders(const InternalLoggingEvent& event);
 
+            /**
+             * Call the appenders in the hierarchy starting at
+             * <code>this</code> with all <code>count</code> events. The
+             * appenders are resolved once and each of them receives the
+             * whole batch through Appender::doAppendBatch().
+             *
+             * @see callAppenders()
+             */
+            virtual void callAppendersBatch(
+                InternalLoggingEvent const * const * events,
+                std::size_t count);
+
             /**
              * Close all attached appenders implementing the AppenderAttachable
              * interface.
              */
             virtual void closeNestedAppenders();
 
+            /**
+             * Return the flattened list of appenders reached by this logger,
+             * i.e., appenders attached to it and to its ancestors up to the
+             * first non-additive logger. Each appender appears only once.
+             *
+             * The list is cached and it is rebuilt lazily when the
+             * configuration generation of the {@link Hierarchy} changes.
+             */
+            std::shared_ptr<SharedAppenderPtrList const>
+                getEffectiveAppenders() const;
+
+            /**
+             * Return the lowest LogLevel accepted by any of the appenders
+             * returned by getEffectiveAppenders(), considering their
+             * thresholds and log level based filters. If this logger does
+             * not reach any appender then no restriction is imposed, so
+             * that the missing configuration can still be reported.
+             *
+             * The value is cached along with the flattened appender list.
+             */
+            LogLevel getLowestAcceptedLogLevel() const;
+
+            // AppenderAttachable overrides. These invalidate flattened
+            // appender lists of the whole hierarchy.
+            virtual void addAppender(SharedAppenderPtr newAppender);
+            virtual void removeAllAppenders();
+            virtual void removeAppender(SharedAppenderPtr appender);
+            virtual void removeAppender(const log4cplus::tstring& name);
+
             /**
              * Check whether this logger is enabled for a given LogLevel passed
-             * as parameter.
+             * as parameter. The logger is not enabled for levels that none
+             * of the appenders it reaches would accept.
+             *
+             * The chained LogLevel is cached along with the flattened
+             * appender list, so that this only checks the configuration
+             * generations in the common case.
              *
              * @return boolean True if this logger is enabled for <code>ll</code>.
              */
@@ -108,12 +156,41 @@ namespace log4cplus {
              *
              * @return LogLevel - the assigned LogLevel.
              */
-            LogLevel getLogLevel() const { return this->ll; }
+            LogLevel getLogLevel() const
+            {
+                return ll.load(std::memory_order_relaxed);
+            }
+
+            /**
+             * Set the LogLevel of this Logger. This invalidates cached
+             * chained log levels of the whole hierarchy.
+             */
+            void setLogLevel(LogLevel _ll);
 
             /**
-             * Set the LogLevel of this Logger.
+             * Starting from this logger, search the logger hierarchy for a
+             * non-zero maximal message size and return it. Zero means that
+             * messages are not limited.
+             *
+             * The value is cached along with the flattened appender list.
+             */
+            std::size_t getChainedMaxMessageSize() const;
+
+            /**
+             * Returns the maximal message size assigned to this logger, zero
+             * if none is assigned.
              */
-            void setLogLevel(LogLevel _ll) { this->ll = _ll; }
+            std::size_t getMaxMessageSize() const { return maxMessageSize; }
+
+            /**
+             * Set the maximal size of messages logged through this logger
+             * and its descendants that do not set their own. Longer
+             * messages are truncated and marked before they are copied
+             * into the logging event. Zero inherits the size from ancestors.
+             * This invalidates cached maximal message sizes of the whole
+             * hierarchy.
+             */
+            void setMaxMessageSize(std::size_t size);
 
             /**
              * Return the the {@link Hierarchy} where this <code>Logger</code>
@@ -166,6 +243,18 @@ namespace log4cplus {
 
             virtual void forcedLog(spi::InternalLoggingEvent const & ev);
 
+            /**
+             * Like forcedLog() but attaches <code>payload</code> to the
+             * event. The payload is borrowed, not copied, while the event
+             * is dispatched.
+             */
+            void forcedLogBinary(LogLevel ll,
+                                 const log4cplus::tstring_view& message,
+                                 std::string_view payload,
+                                 const char* file,
+                                 int line,
+                                 const char* function);
+
 
           // Data
             /** The name of this logger */
@@ -174,7 +263,7 @@ namespace log4cplus {
             /**
              * The assigned LogLevel of this logger.
              */
-            LogLevel ll;
+            std::atomic<LogLevel> ll;
 
             /**
              * The parent of this logger. All loggers have at least one
@@ -191,13 +280,119 @@ namespace log4cplus {
              * have their additivity flag set to <code>false</code> too. See
              * the user manual for more details.
              */
-            bool additive;
+            std::atomic<bool> additive;
+
+            /**
+             * The assigned maximal message size of this logger, zero if
+             * it is not set.
+             */
+            std::atomic<std::size_t> maxMessageSize;
 
         private:
+            /**
+             * Flattened appender list together with the configuration
+             * epoch it was built in and fingerprints of layouts it shares.
+             */
+            struct EffectiveAppenders;
+
           // Data
             /** Loggers need to know what Hierarchy they are in. */
             Hierarchy& hierarchy;
 
+            /**
+             * Serializes publication of the caches below. It is not held
+             * while they are built.
+             */
+            mutable thread::Mutex effective_appenders_mutex;
+
+            /**
+             * Cached result of getEffectiveAppenders(). It is an
+             * immutable snapshot, accessed with std::atomic_load() and
+             * std::atomic_store().
+             */
+            mutable std::shared_ptr<EffectiveAppenders const>
+                effective_appenders;
+
+            /** Hierarchy configuration generation the cache was built for. */
+            mutable std::atomic<unsigned> effective_appenders_generation;
+
+            /** Appender configuration generation the cache was built for. */
+            mutable std::atomic<unsigned> effective_appenders_app_generation;
+
+            /** Cached result of getLowestAcceptedLogLevel(). */
+            mutable std::atomic<LogLevel> lowest_accepted_log_level;
+
+            /** Cached result of getChainedLogLevel(). */
+            mutable std::atomic<LogLevel> effective_log_level;
+
+            /** Cached result of getChainedMaxMessageSize(). */
+            mutable std::atomic<std::size_t> effective_max_message_size;
+
+          // Types
+            /** Values derived from the flattened appender list. */
+            struct EffectiveState
+            {
+                std::shared_ptr<EffectiveAppenders const> appenders;
+                LogLevel lowestAcceptedLogLevel;
+                LogLevel logLevel;
+                std::size_t maxMessageSize;
+            };
+
+          // Methods
+            /**
+             * Like getEffectiveAppenders() but also returns fingerprints
+             * of layouts shared by the appenders.
+             */
+            LOG4CPLUS_PRIVATE std::shared_ptr<EffectiveAppenders const>
+                getEffectiveState() const;
+
+            /**
+             * Drop the cached flattened appender list, so that it does not
+             * keep the configuration epoch it was built in alive.
+             */
+            LOG4CPLUS_PRIVATE void resetEffectiveAppenders();
+
+            /**
+             * @return true if the caches were built for the given
+             * configuration generations.
+             */
+            LOG4CPLUS_PRIVATE bool isEffectiveStateFresh(
+                unsigned generation, unsigned app_generation) const;
+
+            /**
+             * Build the flattened appender list, lowest accepted and
+             * chained log levels and chained maximal message size into
+             * <code>state</code> and publish them as the caches unless
+             * the hierarchy is held. While another thread holds the
+             * hierarchy through HierarchyLocker this waits for it to be
+             * released if <code>wait</code> is true and returns false
+             * otherwise.
+             */
+            LOG4CPLUS_PRIVATE bool buildEffectiveState(unsigned generation,
+                unsigned app_generation, bool wait,
+                EffectiveState & state) const;
+
+            /**
+             * If the caches are stale, rebuild them without waiting for a
+             * HierarchyLocker into <code>state</code>, or fill it from
+             * assigned values only, and return true.
+             */
+            LOG4CPLUS_PRIVATE bool refreshEffectiveState(
+                EffectiveState & state) const;
+
+            /**
+             * @return Maximal message size assigned to this logger or to
+             * the closest ancestor which has one, or 0.
+             */
+            LOG4CPLUS_PRIVATE std::size_t findChainedMaxMessageSize() const;
+
+            /**
+             * Warn, only once per hierarchy, if <code>appenders</code>
+             * obtained from getEffectiveAppenders() is empty.
+             */
+            LOG4CPLUS_PRIVATE void checkNoAppenders(
+                SharedAppenderPtrList const & appenders);
+
           // Disallow copying of instances of this class
             LoggerImpl(const LoggerImpl&) = delete;
             LoggerImpl& operator=(const LoggerImpl&) = delete;
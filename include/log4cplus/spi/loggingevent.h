@@ -31,6 +31,8 @@
 #endif
 
 #include <memory>
+#include <string>
+#include <string_view>
 #include <log4cplus/loglevel.h>
 #include <log4cplus/ndc.h>
 #include <log4cplus/mdc.h>
@@ -93,6 +95,15 @@ namespace log4cplus {
             InternalLoggingEvent(
                 const log4cplus::spi::InternalLoggingEvent& rhs);
 
+            //! Copies <code>rhs</code> but takes from it only thread
+            //! specific data selected by <code>fields</code>, a combination
+            //! of ThreadSpecificData flags. The other thread specific data
+            //! are neither read from <code>rhs</code> nor gathered later;
+            //! they stay empty in the copy.
+            InternalLoggingEvent(
+                const log4cplus::spi::InternalLoggingEvent& rhs,
+                unsigned fields);
+
             virtual ~InternalLoggingEvent();
 
             void setLoggingEvent (const log4cplus::tstring_view & logger,
@@ -202,8 +213,51 @@ namespace log4cplus {
                 return function;
             }
 
+            //! Binary payload attached to the event. It is rendered only
+            //! by layouts which ask for it, e.g., by <code>%B</code> of
+            //! PatternLayout.
+            std::string_view getPayload () const
+            {
+                return payloadBorrowed ? payloadView
+                    : std::string_view (payload);
+            }
+
+            //! Copies <code>size</code> bytes at <code>data</code> into the
+            //! event as its binary payload.
+            void setPayload (void const * data, std::size_t size);
+
+            //! Attaches <code>size</code> bytes at <code>data</code> to the
+            //! event without copying them. The bytes have to outlive the
+            //! event; copies of the event, e.g., those queued by
+            //! asynchronous appenders, own a copy of them.
+            void borrowPayload (void const * data, std::size_t size);
+
+            //! Thread specific data of the event. They are gathered
+            //! lazily from the thread that created the event, so they
+            //! have to be gathered before the event is passed to another
+            //! thread.
+            enum ThreadSpecificData
+            {
+                TSD_NDC = 0x01,
+                TSD_MDC = 0x02,
+                TSD_THREAD = 0x04,
+                TSD_THREAD2 = 0x08,
+                TSD_ALL = TSD_NDC | TSD_MDC | TSD_THREAD | TSD_THREAD2
+            };
+
             void gatherThreadSpecificData () const;
 
+            //! Gathers only thread specific data selected by
+            //! <code>fields</code>, a combination of ThreadSpecificData
+            //! flags.
+            void gatherThreadSpecificData (unsigned fields) const;
+
+            //! Clears thread specific data selected by <code>fields</code>
+            //! and marks them as gathered, so that they are never taken
+            //! from the current thread. This is used on copies of events
+            //! passed to another thread.
+            void discardThreadSpecificData (unsigned fields);
+
             void swap (InternalLoggingEvent &);
 
           // public operators
@@ -226,6 +280,9 @@ namespace log4cplus {
             log4cplus::tstring file;
             log4cplus::tstring function;
             int line;
+            std::string payload;
+            std::string_view payloadView;
+            bool payloadBorrowed;
             /** Indicates whether or not the Threadname has been retrieved. */
             mutable bool threadCached;
             mutable bool thread2Cached;
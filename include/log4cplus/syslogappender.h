@@ -71,11 +71,21 @@ namespace log4cplus
      * <dd>Boolean value specifying whether to use IPv6 (true) or IPv4
      * (false). Default value is false.</dd>
      *
+     * <dt><tt>LocalSocket</tt></dt>
+     * <dd>Path of local syslog socket. When the socket can be opened,
+     * local messages are written to it directly instead of using
+     * <code>syslog()</code>. Empty value disables it. The default value
+     * is <tt>/dev/log</tt> on Linux and empty elsewhere.</dd>
+     *
      * </dl>
      *
      * \note Messages sent to remote syslog using UDP are conforming
      * to RFC5424. Messages sent to remote syslog using TCP are
-     * using octet counting as described in RFC6587.
+     * using octet counting as described in RFC6587. Messages written
+     * to local syslog socket are conforming to RFC3164, like those of
+     * <code>syslog()</code>, but use the ident and facility of the
+     * appender instead of process global <code>openlog()</code>
+     * settings.
      */
     class LOG4CPLUS_EXPORT SysLogAppender
       : public Appender
@@ -105,13 +115,31 @@ namespace log4cplus
 
       // Methods
         virtual void close();
+        virtual unsigned getRequiredThreadSpecificData() const;
 
     protected:
         virtual int getSysLogLevel(const LogLevel& ll) const;
         virtual void append(const spi::InternalLoggingEvent& event);
+        virtual void appendBatch(
+            spi::InternalLoggingEvent const * const * events,
+            std::size_t count);
 #if defined (LOG4CPLUS_HAVE_SYSLOG_H)
         //! Local syslog (served by `syslog()`) worker function.
         void appendLocal(const spi::InternalLoggingEvent& event);
+        //! Local syslog worker function writing to local syslog socket.
+        void appendLocalSocket(const spi::InternalLoggingEvent& event);
+        //! Opens local syslog socket and selects appendLocalSocket() if
+        //! it succeeds, appendLocal() otherwise.
+        void initLocal ();
+        bool openLocalSocket ();
+        void closeLocalSocket ();
+        //! Formats RFC3164 datagram for local syslog socket.
+        void formatLocalDatagram (std::string & datagram,
+            const spi::InternalLoggingEvent& event);
+        //! Sends datagrams to local syslog socket, reopening it once if
+        //! that fails.
+        void sendLocalDatagrams (std::string const * datagrams,
+            std::size_t count);
 #endif
         //! Remote syslog worker function.
         void appendRemote(const spi::InternalLoggingEvent& event);
@@ -133,6 +161,15 @@ namespace log4cplus
 
         static tstring const remoteTimeFormat;
 
+        tstring localSocketPath;
+        //! Descriptor of local syslog socket or -1.
+        int localSocket = -1;
+        //! RFC3164 timestamp of <code>localHeaderTime</code> second.
+        std::string localHeaderTimestamp;
+        long long localHeaderTime = -1;
+        //! TAG part of RFC3164 header.
+        std::string localTag;
+
         void initConnector ();
         void openSocket ();
 
@@ -88,6 +88,20 @@ Mutex::unlock () const
 }
 
 
+LOG4CPLUS_INLINE_EXPORT
+bool
+Mutex::timed_lock (unsigned long LOG4CPLUS_THREADED (msec)) const
+{
+#if defined (LOG4CPLUS_SINGLE_THREADED)
+    return true;
+
+#else
+    return mtx.try_lock_for (std::chrono::milliseconds (msec));
+
+#endif
+}
+
+
 //
 //
 //
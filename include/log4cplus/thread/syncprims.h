@@ -71,8 +71,12 @@ public:
     void lock () const;
     void unlock () const;
 
+    //! Waits at most <code>msec</code> milliseconds to lock the mutex.
+    //! \return true if the mutex has been locked.
+    bool timed_lock (unsigned long msec) const;
+
 private:
-    LOG4CPLUS_THREADED (mutable std::recursive_mutex mtx;)
+    LOG4CPLUS_THREADED (mutable std::recursive_timed_mutex mtx;)
 };
 
 
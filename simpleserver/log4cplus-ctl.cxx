@@ -0,0 +1,119 @@
+//  Copyright (C) 2026, Vaclav Zeman. All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without modifica-
+//  tion, are permitted provided that the following conditions are met:
+//
+//  1. Redistributions of  source code must  retain the above copyright  notice,
+//     this list of conditions and the following disclaimer.
+//
+//  2. Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//
+//  THIS SOFTWARE IS PROVIDED ``AS IS'' AND ANY EXPRESSED OR IMPLIED WARRANTIES,
+//  INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+//  FITNESS  FOR A PARTICULAR  PURPOSE ARE  DISCLAIMED.  IN NO  EVENT SHALL  THE
+//  APACHE SOFTWARE  FOUNDATION  OR ITS CONTRIBUTORS  BE LIABLE FOR  ANY DIRECT,
+//  INDIRECT, INCIDENTAL, SPECIAL,  EXEMPLARY, OR CONSEQUENTIAL  DAMAGES (INCLU-
+//  DING, BUT NOT LIMITED TO, PROCUREMENT  OF SUBSTITUTE GOODS OR SERVICES; LOSS
+//  OF USE, DATA, OR  PROFITS; OR BUSINESS  INTERRUPTION)  HOWEVER CAUSED AND ON
+//  ANY  THEORY OF LIABILITY,  WHETHER  IN CONTRACT,  STRICT LIABILITY,  OR TORT
+//  (INCLUDING  NEGLIGENCE OR  OTHERWISE) ARISING IN  ANY WAY OUT OF THE  USE OF
+//  THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// log4cplus-ctl changes logger levels and appender thresholds of a running
+// process through its log4cplus::ControlSegment.
+
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <log4cplus/controlsegment.h>
+#include <log4cplus/loglevel.h>
+#include <log4cplus/streams.h>
+#include <log4cplus/initializer.h>
+
+
+static
+void
+usage ()
+{
+    std::cout << "Usage: log4cplus-ctl <pid|path> list\n"
+        << "       log4cplus-ctl <pid|path> logger <name> <level>\n"
+        << "       log4cplus-ctl <pid|path> appender <name> <threshold>\n"
+        << "<pid> is process id of a process with the control segment at the"
+        " default path\n"
+        << "<name> \"root\" is the root logger\n"
+        << "<level> e.g. DEBUG or NOTSET to inherit the parent's level\n"
+        << std::flush;
+}
+
+
+int
+main (int argc, char ** argv)
+{
+    log4cplus::Initializer initializer;
+
+    if (argc < 3)
+    {
+        usage ();
+        return 1;
+    }
+
+    log4cplus::tstring path;
+    if (std::strspn (argv[1], "0123456789") == std::strlen (argv[1]))
+        path = log4cplus::ControlSegment::getDefaultPath (
+            std::strtoul (argv[1], nullptr, 10));
+    else
+        path = LOG4CPLUS_C_STR_TO_TSTRING (argv[1]);
+
+    log4cplus::ControlSegmentClient client (path);
+    if (! client.isOpen ())
+    {
+        log4cplus::tcerr << LOG4CPLUS_TEXT ("Could not open control segment ")
+            << path << std::endl;
+        return 2;
+    }
+
+    log4cplus::LogLevelManager & llm = log4cplus::getLogLevelManager ();
+    std::string const command (argv[2]);
+    if (command == "list" && argc == 3)
+    {
+        for (auto const & entry : client.list ())
+            log4cplus::tcout
+                << (entry.appender ? LOG4CPLUS_TEXT ("appender ")
+                    : LOG4CPLUS_TEXT ("logger "))
+                << entry.name << LOG4CPLUS_TEXT (' ')
+                << llm.toString (entry.level) << std::endl;
+        return 0;
+    }
+    else if ((command == "logger" || command == "appender") && argc == 5)
+    {
+        log4cplus::tstring const name = LOG4CPLUS_C_STR_TO_TSTRING (argv[3]);
+        log4cplus::tstring const level = LOG4CPLUS_C_STR_TO_TSTRING (argv[4]);
+        log4cplus::LogLevel const ll = llm.fromString (level);
+        if (ll == log4cplus::NOT_SET_LOG_LEVEL
+            && level != LOG4CPLUS_TEXT ("NOTSET"))
+        {
+            log4cplus::tcerr << LOG4CPLUS_TEXT ("Unknown level ") << level
+                << std::endl;
+            return 1;
+        }
+
+        bool const ok = command == "logger"
+            ? client.setLoggerLevel (name, ll)
+            : client.setAppenderThreshold (name, ll);
+        if (! ok)
+        {
+            log4cplus::tcerr
+                << LOG4CPLUS_TEXT ("Control segment is full or name is")
+                LOG4CPLUS_TEXT (" too long") << std::endl;
+            return 2;
+        }
+
+        return 0;
+    }
+
+    usage ();
+    return 1;
+}
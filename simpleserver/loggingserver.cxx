@@ -18,17 +18,36 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <algorithm>
+#include <atomic>
 #include <cstdlib>
+#include <cstring>
+#include <chrono>
 #include <list>
 #include <iostream>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
 #include <log4cplus/configurator.h>
 #include <log4cplus/socketappender.h>
+#include <log4cplus/helpers/datagramparser.h>
+#include <log4cplus/helpers/housekeeping.h>
 #include <log4cplus/helpers/socket.h>
 #include <log4cplus/thread/threads.h>
 #include <log4cplus/spi/loggingevent.h>
 #include <log4cplus/thread/syncprims.h>
 #include <log4cplus/log4cplus.h>
 
+#if ! defined (_WIN32)
+#include <cerrno>
+#include <netdb.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#define LOGGINGSERVER_UDP_INGEST
+#endif
+
 
 namespace loggingserver
 {
@@ -37,123 +56,135 @@ namespace loggingserver
 typedef std::list<log4cplus::thread::AbstractThreadPtr> ThreadQueueType;
 
 
-class ReaperThread
-    : public log4cplus::thread::AbstractThread
+/**
+   Remembers the last delivered sequence number of each session of
+   SocketAppenders in acknowledged mode, across reconnections, so that
+   events sent again after reconnection are delivered only once.
+ */
+class SessionRegistry
 {
 public:
-    ReaperThread (log4cplus::thread::Mutex & mtx_,
-        log4cplus::thread::ManualResetEvent & ev_,
-        ThreadQueueType & queue_)
-        : mtx (mtx_)
-        , ev (ev_)
-        , queue (queue_)
-        , stop (false)
-    { }
+    //! \return true if the event has not been delivered yet and marks it
+    //! as delivered.
+    bool deliver (unsigned int session, unsigned int sequence);
 
-    virtual
-    ~ReaperThread ()
-    { }
-
-    virtual void run ();
-
-    void signal_exit ();
+    //! Forgets sessions which have not delivered any event for
+    //! <code>max_idle</code>.
+    void expire (std::chrono::steady_clock::duration max_idle);
 
 private:
-    log4cplus::thread::Mutex & mtx;
-    log4cplus::thread::ManualResetEvent & ev;
-    ThreadQueueType & queue;
-    bool stop;
-};
-
+    struct Session
+    {
+        unsigned int last;
+        std::chrono::steady_clock::time_point seen;
+    };
 
-typedef log4cplus::helpers::SharedObjectPtr<ReaperThread> ReaperThreadPtr;
+    std::mutex mtx;
+    std::map<unsigned int, Session> sessions;
+};
 
 
-void
-ReaperThread::signal_exit ()
+bool
+SessionRegistry::deliver (unsigned int session, unsigned int sequence)
 {
-    log4cplus::thread::MutexGuard guard (mtx);
-    stop = true;
-    ev.signal ();
+    auto const now = std::chrono::steady_clock::now ();
+    std::lock_guard<std::mutex> guard (mtx);
+    auto const ret = sessions.emplace (session, Session {sequence, now});
+    if (ret.second)
+        return true;
+
+    Session & s = ret.first->second;
+    s.seen = now;
+    if (! log4cplus::helpers::isSequenceAfter (sequence, s.last))
+        return false;
+
+    s.last = sequence;
+    return true;
 }
 
 
 void
-ReaperThread::run ()
+SessionRegistry::expire (std::chrono::steady_clock::duration max_idle)
 {
-    ThreadQueueType q;
-
-    while (true)
+    auto const oldest = std::chrono::steady_clock::now () - max_idle;
+    std::lock_guard<std::mutex> guard (mtx);
+    for (auto it = sessions.begin (); it != sessions.end (); )
     {
-        ev.timed_wait (30 * 1000);
-
-        {
-            log4cplus::thread::MutexGuard guard (mtx);
-
-            // Check exit condition as the very first thing.
-            if (stop)
-            {
-                std::cout << "Reaper thread is stopping..." << std::endl;
-                return;
-            }
-
-            ev.reset ();
-            q.swap (queue);
-        }
-
-        if (! q.empty ())
-        {
-            std::cout << "Reaper thread is reaping " << q.size () << " threads."
-                      << std::endl;
-
-            for (ThreadQueueType::iterator it = q.begin (), end_it = q.end ();
-                 it != end_it; ++it)
-            {
-                AbstractThread & t = **it;
-                t.join ();
-            }
-
-            q.clear ();
-        }
+        if (it->second.seen < oldest)
+            it = sessions.erase (it);
+        else
+            ++it;
     }
 }
 
-
+
+
 
 /**
-   This class wraps ReaperThread thread and its queue.
+   This class joins finished client threads and expires idle sessions
+   periodically on the housekeeping thread of log4cplus.
  */
 class Reaper
 {
 public:
-    Reaper ()
-    {
-        reaper_thread = ReaperThreadPtr (new ReaperThread (mtx, ev, queue));
-        reaper_thread->start ();
-    }
+    explicit Reaper (SessionRegistry & sessions_)
+        : sessions (sessions_)
+        , task_id (log4cplus::helpers::scheduleHousekeepingTask (
+            std::chrono::seconds (30), [this] { reap (); }))
+    { }
 
     ~Reaper ()
     {
-        reaper_thread->signal_exit ();
-        reaper_thread->join ();
+        log4cplus::helpers::cancelHousekeepingTask (task_id);
+        std::cout << "Reaper is stopping..." << std::endl;
     }
 
     void visit (log4cplus::thread::AbstractThreadPtr const & thread_ptr);
 
 private:
+    void reap ();
+
     log4cplus::thread::Mutex mtx;
-    log4cplus::thread::ManualResetEvent ev;
     ThreadQueueType queue;
-    ReaperThreadPtr reaper_thread;
+    SessionRegistry & sessions;
+    log4cplus::helpers::HousekeepingTaskId const task_id;
 };
 
 
+void
+Reaper::reap ()
+{
+    ThreadQueueType q;
+
+    {
+        log4cplus::thread::MutexGuard guard (mtx);
+        q.swap (queue);
+    }
+
+    if (! q.empty ())
+    {
+        std::cout << "Reaper is reaping " << q.size () << " threads."
+                  << std::endl;
+
+        for (ThreadQueueType::iterator it = q.begin (), end_it = q.end ();
+             it != end_it; ++it)
+        {
+            log4cplus::thread::AbstractThread & t = **it;
+            t.join ();
+        }
+    }
+
+    // Sessions of appenders which have not reconnected for an hour are
+    // not expected to come back.
+    sessions.expire (std::chrono::hours (1));
+}
+
+
 void
 Reaper::visit (log4cplus::thread::AbstractThreadPtr const & thread_ptr)
 {
     log4cplus::thread::MutexGuard guard (mtx);
     queue.push_back (thread_ptr);
-    ev.signal ();
 }
 
 
@@ -163,10 +194,12 @@ class ClientThread
     : public log4cplus::thread::AbstractThread
 {
 public:
-    ClientThread(log4cplus::helpers::Socket clientsock_, Reaper & reaper_)
+    ClientThread(log4cplus::helpers::Socket clientsock_, Reaper & reaper_,
+        SessionRegistry & sessions_)
         : self_reference (log4cplus::thread::AbstractThreadPtr (this))
         , clientsock(std::move (clientsock_))
         , reaper (reaper_)
+        , sessions (sessions_)
     {
         std::cout << "Received a client connection!!!!" << std::endl;
     }
@@ -179,15 +212,40 @@ public:
     virtual void run();
 
 private:
+    bool acknowledge (unsigned int session, unsigned int sequence);
+
+    //! Acknowledge at least every ack_events events...
+    static constexpr unsigned ack_events = 64;
+    //! ...or ack_interval, or whenever there is no more input pending.
+    static constexpr std::chrono::milliseconds ack_interval {100};
+
     log4cplus::thread::AbstractThreadPtr self_reference;
     log4cplus::helpers::Socket clientsock;
     Reaper & reaper;
+    SessionRegistry & sessions;
 };
 
 
+bool
+loggingserver::ClientThread::acknowledge (unsigned int session,
+    unsigned int sequence)
+{
+    log4cplus::helpers::SocketBuffer buffer (sizeof (unsigned int)
+        + log4cplus::LOG4CPLUS_SEQUENCE_HEADER_SIZE);
+    buffer.appendInt (log4cplus::LOG4CPLUS_SEQUENCE_HEADER_SIZE);
+    log4cplus::helpers::appendSequenceHeader (buffer, session, sequence);
+    return clientsock.write (buffer);
+}
+
+
 void
 loggingserver::ClientThread::run()
 {
+    unsigned int session = 0;
+    unsigned int sequence = 0;
+    unsigned unacknowledged = 0;
+    auto last_ack = std::chrono::steady_clock::now ();
+
     try
     {
         while (true)
@@ -205,11 +263,32 @@ loggingserver::ClientThread::run()
             if (!clientsock.read(buffer))
                 break;
 
-            log4cplus::spi::InternalLoggingEvent event
-                = log4cplus::helpers::readFromBuffer(buffer);
-            log4cplus::Logger logger
-                = log4cplus::Logger::getInstance(event.getLoggerName());
-            logger.callAppenders(event);
+            bool const sequenced = log4cplus::helpers::readSequenceHeader (
+                buffer, session, sequence);
+            if (! sequenced || sessions.deliver (session, sequence))
+            {
+                log4cplus::spi::InternalLoggingEvent event
+                    = log4cplus::helpers::readFromBuffer(buffer);
+                log4cplus::Logger logger
+                    = log4cplus::Logger::getInstance(event.getLoggerName());
+                logger.callAppenders(event);
+            }
+
+            if (! sequenced)
+                continue;
+
+            // Acknowledge cumulatively, without waiting for the client.
+            ++unacknowledged;
+            auto const now = std::chrono::steady_clock::now ();
+            if (unacknowledged >= ack_events || now - last_ack >= ack_interval
+                || ! clientsock.hasPendingInput ())
+            {
+                if (! acknowledge (session, sequence))
+                    break;
+
+                unacknowledged = 0;
+                last_ack = now;
+            }
         }
     }
     catch (...)
@@ -221,6 +300,228 @@ loggingserver::ClientThread::run()
     reaper.visit (std::move (self_reference));
 }
 
+
+
+#if defined (LOGGINGSERVER_UDP_INGEST)
+
+/**
+   Counters of datagrams received by all UdpIngestThread instances,
+   printed periodically on the housekeeping thread of log4cplus.
+ */
+class UdpStats
+{
+public:
+    UdpStats ()
+        : received (0)
+        , rejected (0)
+        , last_received (0)
+        , task_id (log4cplus::helpers::scheduleHousekeepingTask (
+            std::chrono::seconds (period), [this] { report (); }))
+    { }
+
+    ~UdpStats ()
+    {
+        log4cplus::helpers::cancelHousekeepingTask (task_id);
+    }
+
+    std::atomic<unsigned long long> received;
+    std::atomic<unsigned long long> rejected;
+
+private:
+    void report ();
+
+    static constexpr int period = 10;
+    unsigned long long last_received;
+    log4cplus::helpers::HousekeepingTaskId const task_id;
+};
+
+
+void
+UdpStats::report ()
+{
+    unsigned long long const total = received.load ();
+    if (total == last_received)
+        return;
+
+    std::cout << "UDP ingest: " << (total - last_received) / period
+        << " events/s, " << total << " events, " << rejected.load ()
+        << " rejected datagrams." << std::endl;
+    last_received = total;
+}
+
+
+//! Opens UDP socket bound to host and port. Several sockets can be bound
+//! to the same port with SO_REUSEPORT; the kernel then spreads incoming
+//! datagrams among them.
+int
+openUdpSocket (char const * host, char const * port, bool ipv6)
+{
+    struct addrinfo hints;
+    std::memset (&hints, 0, sizeof (hints));
+    hints.ai_family = ipv6 ? AF_INET6 : AF_INET;
+    hints.ai_socktype = SOCK_DGRAM;
+    hints.ai_flags = AI_PASSIVE;
+
+    struct addrinfo * ai = nullptr;
+    if (getaddrinfo (host, port, &hints, &ai) != 0)
+        return -1;
+
+    int fd = socket (ai->ai_family, ai->ai_socktype, ai->ai_protocol);
+    if (fd != -1)
+    {
+        int const on = 1;
+#if defined (SO_REUSEPORT)
+        setsockopt (fd, SOL_SOCKET, SO_REUSEPORT, &on, sizeof (on));
+#else
+        setsockopt (fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof (on));
+#endif
+        // Give the kernel room to absorb bursts.
+        int const rcvbuf = 4 * 1024 * 1024;
+        setsockopt (fd, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof (rcvbuf));
+
+        if (bind (fd, ai->ai_addr, ai->ai_addrlen) != 0)
+        {
+            ::close (fd);
+            fd = -1;
+        }
+    }
+
+    freeaddrinfo (ai);
+    return fd;
+}
+
+
+/**
+   Receives syslog, log4j XML and SocketAppender datagrams in batches and
+   routes each batch of parsed events through the local hierarchy at once.
+ */
+class UdpIngestThread
+    : public log4cplus::thread::AbstractThread
+{
+public:
+    UdpIngestThread (int fd_, UdpStats & stats_)
+        : fd (fd_)
+        , stats (stats_)
+        , events (batch_size)
+        , parsed (0)
+    { }
+
+    virtual void run();
+
+private:
+    void process (char const * data, std::size_t size, bool truncated);
+    void flush ();
+
+    static constexpr std::size_t batch_size = 32;
+    static constexpr std::size_t max_datagram_size = 65536;
+
+    int fd;
+    UdpStats & stats;
+    std::vector<log4cplus::spi::InternalLoggingEvent> events;
+    std::size_t parsed;
+};
+
+
+void
+UdpIngestThread::process (char const * data, std::size_t size,
+    bool truncated)
+{
+    if (truncated
+        || log4cplus::helpers::parseDatagram (events[parsed],
+            std::string_view (data, size))
+            == log4cplus::helpers::DATAGRAM_UNKNOWN)
+    {
+        stats.rejected.fetch_add (1, std::memory_order_relaxed);
+        return;
+    }
+
+    ++parsed;
+}
+
+
+void
+UdpIngestThread::flush ()
+{
+    if (parsed == 0)
+        return;
+
+    log4cplus::getDefaultHierarchy ().logBatch (events.data (), parsed);
+    stats.received.fetch_add (parsed, std::memory_order_relaxed);
+    parsed = 0;
+}
+
+
+void
+UdpIngestThread::run()
+{
+    std::vector<char> buffer (batch_size * max_datagram_size);
+
+#if defined (__linux__)
+    struct mmsghdr msgs[batch_size];
+    struct iovec iovs[batch_size];
+    for (std::size_t i = 0; i != batch_size; ++i)
+    {
+        iovs[i].iov_base = &buffer[i * max_datagram_size];
+        iovs[i].iov_len = max_datagram_size;
+    }
+
+    while (true)
+    {
+        std::memset (msgs, 0, sizeof (msgs));
+        for (std::size_t i = 0; i != batch_size; ++i)
+        {
+            msgs[i].msg_hdr.msg_iov = &iovs[i];
+            msgs[i].msg_hdr.msg_iovlen = 1;
+        }
+
+        // Block until at least one datagram arrives, then take all
+        // datagrams already queued, up to batch_size.
+        int const count = recvmmsg (fd, msgs, batch_size, MSG_WAITFORONE,
+            nullptr);
+        if (count == -1)
+        {
+            if (errno == EINTR)
+                continue;
+
+            std::cerr << "recvmmsg() failed: " << std::strerror (errno)
+                << std::endl;
+            break;
+        }
+
+        for (int i = 0; i != count; ++i)
+            process (&buffer[i * max_datagram_size], msgs[i].msg_len,
+                (msgs[i].msg_hdr.msg_flags & MSG_TRUNC) != 0);
+        flush ();
+    }
+
+#else
+    while (true)
+    {
+        ssize_t const size = recv (fd, &buffer[0], max_datagram_size,
+            MSG_TRUNC);
+        if (size == -1)
+        {
+            if (errno == EINTR)
+                continue;
+
+            std::cerr << "recv() failed: " << std::strerror (errno)
+                << std::endl;
+            break;
+        }
+
+        process (&buffer[0], (std::min) (static_cast<std::size_t>(size),
+            max_datagram_size),
+            static_cast<std::size_t>(size) > max_datagram_size);
+        flush ();
+    }
+#endif
+
+    ::close (fd);
+}
+
+#endif // LOGGINGSERVER_UDP_INGEST
+
+
 } // namespace loggingserver
 
 
@@ -232,13 +533,20 @@ main(int argc, char** argv)
     log4cplus::Initializer initializer;
 
     if(argc < 4) {
-        std::cout << "Usage: host port config_file [<IP version>]\n"
+        std::cout << "Usage: host port config_file [<IP version>"
+            " [<UDP port> [<UDP threads>]]]\n"
             << "<IP version> either 0 for IPv4 (default) or 1 for IPv6\n"
+            << "<UDP port> port to receive syslog, log4j XML and binary"
+            " datagrams on, 0 (default) disables it\n"
+            << "<UDP threads> number of threads receiving datagrams,"
+            " 1 by default\n"
             << std::flush;
         return 1;
     }
     int const port = std::atoi(argv[2]);
     bool const ipv6 = argc >= 5 ? !!std::atoi(argv[4]) : false;
+    int const udpPort = argc >= 6 ? std::atoi(argv[5]) : 0;
+    int const udpThreads = argc >= 7 ? (std::max) (std::atoi(argv[6]), 1) : 1;
     const log4cplus::tstring configFile = LOG4CPLUS_C_STR_TO_TSTRING(argv[3]);
 
     log4cplus::PropertyConfigurator config(configFile);
@@ -252,12 +560,39 @@ main(int argc, char** argv)
         return 2;
     }
 
-    loggingserver::Reaper reaper;
+    loggingserver::SessionRegistry sessions;
+    loggingserver::Reaper reaper (sessions);
+
+    if (udpPort != 0)
+    {
+#if defined (LOGGINGSERVER_UDP_INGEST)
+        static loggingserver::UdpStats udpStats;
+        for (int i = 0; i != udpThreads; ++i)
+        {
+            int const fd = loggingserver::openUdpSocket (argv[1], argv[5],
+                ipv6);
+            if (fd == -1) {
+                std::cerr << "Could not open UDP socket, maybe port "
+                    << udpPort << " is already in use." << std::endl;
+                return 2;
+            }
+
+            log4cplus::thread::AbstractThreadPtr thr (
+                new loggingserver::UdpIngestThread (fd, udpStats));
+            thr->start();
+        }
+#else
+        std::cerr << "UDP ingest is not supported on this platform."
+            << std::endl;
+        return 2;
+#endif
+    }
 
     for (;;)
     {
         loggingserver::ClientThread *thr =
-            new loggingserver::ClientThread(serverSocket.accept(), reaper);
+            new loggingserver::ClientThread(serverSocket.accept(), reaper,
+                sessions);
         thr->start();
     }
 
@@ -20,7 +20,9 @@
 
 #include <log4cplus/appender.h>
 #include <log4cplus/layout.h>
+#include <log4cplus/helpers/housekeeping.h>
 #include <log4cplus/helpers/loglog.h>
+#include <log4cplus/helpers/memorybudget.h>
 #include <log4cplus/helpers/pointer.h>
 #include <log4cplus/helpers/stringhelper.h>
 #include <log4cplus/helpers/property.h>
@@ -28,14 +30,32 @@
 #include <log4cplus/spi/loggingevent.h>
 #include <log4cplus/internal/internal.h>
 #include <log4cplus/thread/syncprims-pub-impl.h>
+#include <algorithm>
 #include <memory>
 #include <stdexcept>
+#include <vector>
+
+#if defined (LOG4CPLUS_WITH_UNIT_TESTS)
+#include <log4cplus/hierarchy.h>
+#include <log4cplus/logger.h>
+#include <catch.hpp>
+#include <future>
+#include <thread>
+#endif
 
 
 namespace log4cplus
 {
 
 
+namespace internal
+{
+
+std::atomic<unsigned> appender_config_generation (1);
+
+} // namespace internal
+
+
 ///////////////////////////////////////////////////////////////////////////////
 // log4cplus::ErrorHandler dtor
 ///////////////////////////////////////////////////////////////////////////////
@@ -78,6 +98,79 @@ OnlyOnceErrorHandler::reset()
 
 
 
+///////////////////////////////////////////////////////////////////////////////
+// log4cplus::Appender::LatencyWatchdog
+///////////////////////////////////////////////////////////////////////////////
+
+#if ! defined (LOG4CPLUS_SINGLE_THREADED)
+struct Appender::LatencyWatchdog
+{
+    LatencyWatchdog (std::chrono::milliseconds budget_,
+        SharedAppenderPtr fallback_)
+        : budget (budget_)
+        , fallback (std::move (fallback_))
+    { }
+
+    ~LatencyWatchdog ()
+    {
+        if (task_id != 0)
+            helpers::cancelHousekeepingTask (task_id);
+    }
+
+    static
+    long long
+    now ()
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds> (
+            std::chrono::steady_clock::now ().time_since_epoch ()).count ();
+    }
+
+    //! Switches to degraded mode. Returns true if the appender has not
+    //! been degraded yet.
+    bool
+    degrade ()
+    {
+        if (degraded.exchange (true, std::memory_order_acq_rel))
+            return false;
+
+        degradations.fetch_add (1, std::memory_order_relaxed);
+        return true;
+    }
+
+    //! Marks append in progress for the lifetime of the object.
+    struct Timer
+    {
+        explicit
+        Timer (LatencyWatchdog * wd_)
+            : wd (wd_)
+        {
+            if (wd)
+                wd->append_start.store (now (), std::memory_order_release);
+        }
+
+        ~Timer ()
+        {
+            if (wd)
+                wd->append_start.store (0, std::memory_order_release);
+        }
+
+        LatencyWatchdog * const wd;
+    };
+
+    std::chrono::milliseconds const budget;
+    SharedAppenderPtr const fallback;
+    //! Start of append in progress in nanoseconds of steady clock, or 0.
+    std::atomic<long long> append_start {0};
+    std::atomic<bool> degraded {false};
+    std::atomic<unsigned long long> degradations {0};
+    std::atomic<unsigned long long> diverted {0};
+    std::atomic<unsigned long long> dropped {0};
+    helpers::HousekeepingTaskId task_id = 0;
+};
+
+#endif
+
+
 ///////////////////////////////////////////////////////////////////////////////
 // log4cplus::Appender ctors
 ///////////////////////////////////////////////////////////////////////////////
@@ -91,9 +184,13 @@ Appender::Appender()
    async(false),
 #if ! defined (LOG4CPLUS_SINGLE_THREADED)
    in_flight(0),
+   requiredThreadSpecificData(0),
 #endif
-   closed(false)
+   closed(false),
+   lowestAcceptedLogLevel(NOT_SET_LOG_LEVEL),
+   layoutRequiredThreadSpecificData(0)
 {
+    publishConfig ();
 }
 
 
@@ -106,8 +203,11 @@ Appender::Appender(const log4cplus::helpers::Properties & properties)
     , async(false)
 #if ! defined (LOG4CPLUS_SINGLE_THREADED)
     , in_flight(0)
+    , requiredThreadSpecificData(0)
 #endif
     , closed(false)
+    , lowestAcceptedLogLevel(NOT_SET_LOG_LEVEL)
+    , layoutRequiredThreadSpecificData(0)
 {
     if(properties.exists( LOG4CPLUS_TEXT("layout") ))
     {
@@ -179,6 +279,37 @@ Appender::Appender(const log4cplus::helpers::Properties & properties)
         addFilter (std::move (tmpFilter));
     }
 
+    // Publish layout and threshold set above.
+    publishConfig ();
+
+#if ! defined (LOG4CPLUS_SINGLE_THREADED)
+    // Deal with latency budget and fallback appender.
+    unsigned latencyBudget = 0;
+    properties.getUInt (latencyBudget, LOG4CPLUS_TEXT("LatencyBudget"));
+    if (latencyBudget != 0)
+    {
+        SharedAppenderPtr fallback;
+        tstring const & fallbackName
+            = properties.getProperty (LOG4CPLUS_TEXT("FallbackAppender"));
+        if (! fallbackName.empty ())
+        {
+            spi::AppenderFactory * factory
+                = spi::getAppenderFactoryRegistry ().get (fallbackName);
+            if (! factory)
+                helpers::getLogLog ().error (
+                    LOG4CPLUS_TEXT ("Appender::ctor()- Cannot find ")
+                    LOG4CPLUS_TEXT ("AppenderFactory: ") + fallbackName);
+            else
+                fallback = factory->createObject (
+                    properties.getPropertySubset (
+                        LOG4CPLUS_TEXT ("FallbackAppender.")));
+        }
+
+        setLatencyBudget (std::chrono::milliseconds (latencyBudget),
+            std::move (fallback));
+    }
+#endif
+
     // Deal with file locking settings.
     properties.getBool (useLockFile, LOG4CPLUS_TEXT("UseLockFile"));
     if (useLockFile)
@@ -266,6 +397,122 @@ bool Appender::isClosed() const
 }
 
 
+void
+Appender::setLatencyBudget (
+    std::chrono::milliseconds LOG4CPLUS_THREADED (budget),
+    SharedAppenderPtr LOG4CPLUS_THREADED (fallback))
+{
+#if ! defined (LOG4CPLUS_SINGLE_THREADED)
+    std::shared_ptr<LatencyWatchdog> wd;
+    if (budget.count () > 0)
+    {
+        wd = std::make_shared<LatencyWatchdog> (budget, std::move (fallback));
+        // The task is cancelled by the watchdog's destructor, so it can
+        // refer to the watchdog directly.
+        LatencyWatchdog * const wd_ptr = wd.get ();
+        wd->task_id = helpers::scheduleHousekeepingTask (
+            (std::max) (budget / 2, std::chrono::milliseconds (1)),
+            [this, wd_ptr] { checkLatency (*wd_ptr); });
+    }
+
+    // The previous watchdog is destroyed when appends using it finish.
+    std::atomic_store (&watchdog, std::move (wd));
+#endif
+}
+
+
+Appender::LatencyStats
+Appender::getLatencyStats () const
+{
+    LatencyStats stats {false, 0, 0, 0};
+#if ! defined (LOG4CPLUS_SINGLE_THREADED)
+    std::shared_ptr<LatencyWatchdog> const wd = std::atomic_load (&watchdog);
+    if (wd)
+    {
+        stats.degraded = wd->degraded.load (std::memory_order_acquire);
+        stats.degradations = wd->degradations.load (std::memory_order_relaxed);
+        stats.diverted = wd->diverted.load (std::memory_order_relaxed);
+        stats.dropped = wd->dropped.load (std::memory_order_relaxed);
+    }
+#endif
+    return stats;
+}
+
+
+#if ! defined (LOG4CPLUS_SINGLE_THREADED)
+bool
+Appender::lockForAppend (thread::MutexGuard & guard, LatencyWatchdog * wd)
+{
+    if (! wd)
+    {
+        guard.attach_and_lock (access_mutex);
+        return true;
+    }
+
+    if (wd->degraded.load (std::memory_order_acquire))
+        return false;
+
+    if (! access_mutex.timed_lock (
+            static_cast<unsigned long>(wd->budget.count ())))
+    {
+        if (wd->degrade ())
+            helpers::getLogLog ().warn (
+                LOG4CPLUS_TEXT ("Appender [") + name
+                + LOG4CPLUS_TEXT ("] is degraded, waiting for it")
+                LOG4CPLUS_TEXT (" exceeded latency budget."));
+
+        return false;
+    }
+
+    guard.attach (access_mutex);
+    return true;
+}
+
+
+void
+Appender::divertEvent (const spi::InternalLoggingEvent& event,
+    LatencyWatchdog & wd)
+{
+    // Only the threshold is checked, filters are not safe to use
+    // without the lock.
+    if (! isAsSevereAsThreshold (event.getLogLevel ()))
+        return;
+
+    if (wd.fallback)
+    {
+        wd.diverted.fetch_add (1, std::memory_order_relaxed);
+        wd.fallback->doAppend (event);
+    }
+    else
+        wd.dropped.fetch_add (1, std::memory_order_relaxed);
+}
+
+
+void
+Appender::checkLatency (LatencyWatchdog & wd)
+{
+    long long const start = wd.append_start.load (std::memory_order_acquire);
+    if (start == 0)
+    {
+        // Nothing is stuck in append() any more; resume normal operation.
+        if (wd.degraded.exchange (false, std::memory_order_acq_rel))
+            helpers::getLogLog ().warn (
+                LOG4CPLUS_TEXT ("Appender [") + name
+                + LOG4CPLUS_TEXT ("] has recovered."));
+    }
+    else if (LatencyWatchdog::now () - start
+            > std::chrono::duration_cast<std::chrono::nanoseconds> (
+                wd.budget).count ()
+        && wd.degrade ())
+        helpers::getLogLog ().warn (
+            LOG4CPLUS_TEXT ("Appender [") + name
+            + LOG4CPLUS_TEXT ("] is degraded, append in progress")
+            LOG4CPLUS_TEXT (" exceeded latency budget."));
+}
+
+#endif
+
+
 #if ! defined (LOG4CPLUS_SINGLE_THREADED)
 void
 Appender::subtract_in_flight ()
@@ -284,9 +531,122 @@ Appender::subtract_in_flight ()
 #endif
 
 
+#if ! defined (LOG4CPLUS_SINGLE_THREADED) \
+    && defined (LOG4CPLUS_ENABLE_THREAD_POOL)
 // from global-init.cxx
 void enqueueAsyncDoAppend (SharedAppenderPtr const & appender,
-    spi::InternalLoggingEvent const & event);
+    std::shared_ptr<spi::InternalLoggingEvent const> event);
+
+
+namespace
+{
+
+//! Returns memory budget reserved for the event copy once the last
+//! asynchronous append using it has finished.
+struct release_budget_deleter
+{
+    std::size_t bytes;
+#if defined (LOG4CPLUS_HAVE_MEMORY_RESOURCE)
+    std::pmr::memory_resource * resource;
+#endif
+
+    void
+    operator () (spi::InternalLoggingEvent const * ev) const
+    {
+#if defined (LOG4CPLUS_HAVE_MEMORY_RESOURCE)
+        ev->~InternalLoggingEvent ();
+        resource->deallocate (const_cast<spi::InternalLoggingEvent *>(ev),
+            sizeof (spi::InternalLoggingEvent),
+            alignof (spi::InternalLoggingEvent));
+#else
+        delete ev;
+#endif
+        helpers::getMemoryBudget ().release (
+            helpers::MemoryBudget::THREAD_POOL_QUEUE, bytes);
+    }
+};
+
+
+//! Returns immutable copy of the event for asynchronous append. The copy
+//! is made only once per dispatch and it is shared by all asynchronous
+//! appenders the event is dispatched to. The copy keeps only thread
+//! specific data selected by `fields`. Returns empty pointer if the
+//! copy does not fit into memory budget.
+static
+std::shared_ptr<spi::InternalLoggingEvent const>
+getSharedEvent (const spi::InternalLoggingEvent& event, unsigned fields)
+{
+    internal::dispatch_cache & cache = internal::get_dispatch_cache ();
+    bool const dispatching = cache.event == &event;
+    if (dispatching && cache.shared_event)
+    {
+        // The shared copy is reused unless this appender needs thread
+        // specific data the copy has not captured. In that case a new
+        // copy with the union of the fields replaces it.
+        if ((fields & ~cache.shared_event_fields) == 0)
+            return cache.shared_event;
+
+        fields |= cache.shared_event_fields;
+    }
+
+    event.gatherThreadSpecificData (fields);
+
+    helpers::MemoryBudget & budget = helpers::getMemoryBudget ();
+    std::size_t const bytes
+        = helpers::MemoryBudget::estimateEventSize (event, fields);
+    if (! budget.tryAcquire (helpers::MemoryBudget::THREAD_POOL_QUEUE, bytes))
+        return std::shared_ptr<spi::InternalLoggingEvent const> ();
+
+    spi::InternalLoggingEvent * copy;
+#if defined (LOG4CPLUS_HAVE_MEMORY_RESOURCE)
+    // The copy and the shared pointer's control block come from the
+    // resource set by helpers::setAsyncEventMemoryResource(). Strings
+    // owned by the copy use the global heap.
+    std::pmr::memory_resource * const resource
+        = helpers::getAsyncEventMemoryResource ();
+    void * storage = nullptr;
+#endif
+    try
+    {
+#if defined (LOG4CPLUS_HAVE_MEMORY_RESOURCE)
+        storage = resource->allocate (sizeof (spi::InternalLoggingEvent),
+            alignof (spi::InternalLoggingEvent));
+        copy = new (storage) spi::InternalLoggingEvent (event, fields);
+#else
+        copy = new spi::InternalLoggingEvent (event, fields);
+#endif
+    }
+    catch (...)
+    {
+#if defined (LOG4CPLUS_HAVE_MEMORY_RESOURCE)
+        if (storage)
+            resource->deallocate (storage, sizeof (spi::InternalLoggingEvent),
+                alignof (spi::InternalLoggingEvent));
+#endif
+        budget.release (helpers::MemoryBudget::THREAD_POOL_QUEUE, bytes);
+        throw;
+    }
+
+#if defined (LOG4CPLUS_HAVE_MEMORY_RESOURCE)
+    std::shared_ptr<spi::InternalLoggingEvent const> shared_event (copy,
+        release_budget_deleter {bytes, resource},
+        std::pmr::polymorphic_allocator<char> (resource));
+#else
+    std::shared_ptr<spi::InternalLoggingEvent const> shared_event (copy,
+        release_budget_deleter {bytes});
+#endif
+    if (dispatching)
+    {
+        cache.shared_event = shared_event;
+        cache.shared_event_fields = fields;
+    }
+
+    return shared_event;
+}
+
+} // namespace
+
+#endif
 
 
 void
@@ -296,14 +656,25 @@ Appender::doAppend(const log4cplus::spi::InternalLoggingEvent& event)
     && defined (LOG4CPLUS_ENABLE_THREAD_POOL)
     if (async)
     {
-        event.gatherThreadSpecificData ();
+        std::shared_ptr<spi::InternalLoggingEvent const> shared_event
+            = getSharedEvent (event, getCachedRequiredThreadSpecificData ());
+        if (! shared_event)
+        {
+            if (helpers::getMemoryBudget ().getOverflowPolicy (
+                    helpers::MemoryBudget::THREAD_POOL_QUEUE)
+                == helpers::MemoryBudget::OVERFLOW_SYNC)
+                syncDoAppend (event);
+
+            return;
+        }
 
         std::atomic_fetch_add_explicit (&in_flight, std::size_t (1),
             std::memory_order_relaxed);
 
         try
         {
-            enqueueAsyncDoAppend (SharedAppenderPtr (this), event);
+            enqueueAsyncDoAppend (SharedAppenderPtr (this),
+                std::move (shared_event));
         }
         catch (...)
         {
@@ -347,8 +718,33 @@ Appender::asyncDoAppend(const log4cplus::spi::InternalLoggingEvent& event)
 void
 Appender::syncDoAppend(const log4cplus::spi::InternalLoggingEvent& event)
 {
+#if defined (LOG4CPLUS_ENABLE_STAGE_PROFILER)
+    internal::stage_profiler_data & prof = internal::get_ptd ()->profiler;
+    bool const sampled = prof.sampling;
+    std::uint64_t stamp = sampled ? internal::profiler_ticks () : 0;
+#endif
+
+#if ! defined (LOG4CPLUS_SINGLE_THREADED)
+    std::shared_ptr<LatencyWatchdog> const wd = std::atomic_load (&watchdog);
+    thread::MutexGuard guard;
+    if (! lockForAppend (guard, wd.get ()))
+    {
+        divertEvent (event, *wd);
+        return;
+    }
+
+    LatencyWatchdog::Timer timer (wd.get ());
+
+#else
     thread::MutexGuard guard (access_mutex);
 
+#endif
+
+#if defined (LOG4CPLUS_ENABLE_STAGE_PROFILER)
+    if (sampled)
+        stamp = prof.lap_appender (name, internal::STAGE_LOCK_WAIT, stamp);
+#endif
+
     if(closed) {
         helpers::getLogLog().error(
             LOG4CPLUS_TEXT("Attempted to append to closed appender named [")
@@ -357,14 +753,18 @@ Appender::syncDoAppend(const log4cplus::spi::InternalLoggingEvent& event)
         return;
     }
 
-    // Check appender's threshold logging level.
+    // Check appender's threshold logging level and evaluate filters
+    // attached to this appender.
 
-    if (! isAsSevereAsThreshold(event.getLogLevel()))
-        return;
+    bool const accepted = isAsSevereAsThreshold(event.getLogLevel())
+        && checkFilter(filter.get(), event) != spi::DENY;
 
-    // Evaluate filters attached to this appender.
+#if defined (LOG4CPLUS_ENABLE_STAGE_PROFILER)
+    if (sampled)
+        stamp = prof.lap_appender (name, internal::STAGE_FILTER, stamp);
+#endif
 
-    if (checkFilter(filter.get(), event) == spi::DENY)
+    if (! accepted)
         return;
 
     // Lock system wide lock.
@@ -384,21 +784,220 @@ Appender::syncDoAppend(const log4cplus::spi::InternalLoggingEvent& event)
 
     // Finally append given event.
 
+#if defined (LOG4CPLUS_ENABLE_STAGE_PROFILER)
+    prof.layout_ticks = 0;
+#endif
+
     append(event);
+
+#if defined (LOG4CPLUS_ENABLE_STAGE_PROFILER)
+    if (sampled)
+    {
+        std::uint64_t const layout_ticks = prof.layout_ticks;
+        prof.record (prof.appenders, name, internal::STAGE_LAYOUT,
+            layout_ticks);
+        prof.lap_appender (name, internal::STAGE_SINK_IO,
+            stamp + layout_ticks);
+    }
+#endif
 }
 
 
+void
+Appender::doAppendBatch(spi::InternalLoggingEvent const * const * events,
+    std::size_t count)
+{
+#if ! defined (LOG4CPLUS_SINGLE_THREADED) \
+    && defined (LOG4CPLUS_ENABLE_THREAD_POOL)
+    if (async)
+    {
+        for (std::size_t i = 0; i != count; ++i)
+            doAppend (*events[i]);
+
+        return;
+    }
+#endif
+
+#if ! defined (LOG4CPLUS_SINGLE_THREADED)
+    std::shared_ptr<LatencyWatchdog> const wd = std::atomic_load (&watchdog);
+    thread::MutexGuard guard;
+    if (! lockForAppend (guard, wd.get ()))
+    {
+        for (std::size_t i = 0; i != count; ++i)
+            divertEvent (*events[i], *wd);
+
+        return;
+    }
+
+    LatencyWatchdog::Timer timer (wd.get ());
+
+#else
+    thread::MutexGuard guard (access_mutex);
+
+#endif
+
+    if(closed) {
+        helpers::getLogLog().error(
+            LOG4CPLUS_TEXT("Attempted to append to closed appender named [")
+            + name
+            + LOG4CPLUS_TEXT("]."));
+        return;
+    }
+
+    // Check threshold and filters of all events first so that the lock
+    // file is not locked when no event is accepted.
+
+    std::vector<spi::InternalLoggingEvent const *> accepted;
+    accepted.reserve (count);
+    for (std::size_t i = 0; i != count; ++i)
+    {
+        spi::InternalLoggingEvent const & event = *events[i];
+        if (isAsSevereAsThreshold(event.getLogLevel())
+            && checkFilter(filter.get(), event) != spi::DENY)
+            accepted.push_back (&event);
+    }
+
+    if (accepted.empty ())
+        return;
+
+    helpers::LockFileGuard lfguard;
+    if (useLockFile && lockFile.get ())
+    {
+        try
+        {
+            lfguard.attach_and_lock (*lockFile);
+        }
+        catch (std::runtime_error const &)
+        {
+            return;
+        }
+    }
+
+    appendBatch(accepted.data (), accepted.size ());
+}
+
+
+void
+Appender::appendBatch(spi::InternalLoggingEvent const * const * events,
+    std::size_t count)
+{
+    for (std::size_t i = 0; i != count; ++i)
+        append(*events[i]);
+}
+
+
+namespace
+{
+
+//! Returns layout output cached for the event being dispatched or NULL if
+//! the output of the layout is not shared with another appender.
+static
+tstring *
+getCachedLayoutOutput (Layout & layout, std::locale const & loc,
+    const spi::InternalLoggingEvent& event)
+{
+    internal::dispatch_cache & cache = internal::get_dispatch_cache ();
+    tstring const & fingerprint = layout.getFingerprint ();
+    if (cache.event != &event || fingerprint.empty ()
+        || std::find (cache.shared_fingerprints->begin (),
+            cache.shared_fingerprints->end (), fingerprint)
+        == cache.shared_fingerprints->end ())
+        return nullptr;
+
+    for (std::size_t i = 0; i != cache.size; ++i)
+    {
+        internal::dispatch_cache::entry & entry = cache.entries[i];
+        if (entry.fingerprint == fingerprint && entry.loc == loc)
+            return &entry.str;
+    }
+
+    if (cache.size == cache.entries.size ())
+        cache.entries.emplace_back ();
+
+    internal::dispatch_cache::entry & entry
+        = cache.entries[cache.size];
+    entry.fingerprint = fingerprint;
+    entry.loc = loc;
+    detail::clear_tostringstream (cache.oss);
+    cache.oss.imbue (loc);
+    layout.formatAndAppend (cache.oss, event);
+    entry.str = cache.oss.str ();
+    ++cache.size;
+
+    return &entry.str;
+}
+
+} // namespace
+
+
 tstring &
 Appender::formatEvent (const spi::InternalLoggingEvent& event) const
 {
+#if defined (LOG4CPLUS_ENABLE_STAGE_PROFILER)
+    internal::stage_profiler_data & prof = internal::get_ptd ()->profiler;
+#endif
+#if defined (LOG4CPLUS_ENABLE_CALLSITE_PROFILER)
+    std::uint64_t const start = internal::profiler_ticks ();
+#elif defined (LOG4CPLUS_ENABLE_STAGE_PROFILER)
+    std::uint64_t const start = prof.sampling ? internal::profiler_ticks () : 0;
+#endif
+
     internal::appender_sratch_pad & appender_sp = internal::get_appender_sp ();
-    detail::clear_tostringstream (appender_sp.oss);
-    layout->formatAndAppend(appender_sp.oss, event);
-    appender_sp.str = appender_sp.oss.str();
+    if (tstring const * cached = getCachedLayoutOutput (*layout,
+            appender_sp.oss.getloc (), event))
+        appender_sp.str = *cached;
+    else
+    {
+        detail::clear_tostringstream (appender_sp.oss);
+        layout->formatAndAppend(appender_sp.oss, event);
+        appender_sp.str = appender_sp.oss.str();
+    }
+
+#if defined (LOG4CPLUS_ENABLE_STAGE_PROFILER)
+    if (prof.sampling)
+        prof.layout_ticks += internal::profiler_ticks () - start;
+#endif
+
+#if defined (LOG4CPLUS_ENABLE_CALLSITE_PROFILER)
+    internal::get_ptd ()->callsites.layout_ticks
+        += internal::profiler_ticks () - start;
+#endif
+
     return appender_sp.str;
 }
 
 
+void
+Appender::formatAndAppend (tostream & output,
+    const spi::InternalLoggingEvent& event) const
+{
+#if defined (LOG4CPLUS_ENABLE_STAGE_PROFILER)
+    internal::stage_profiler_data & prof = internal::get_ptd ()->profiler;
+#endif
+#if defined (LOG4CPLUS_ENABLE_CALLSITE_PROFILER)
+    std::uint64_t const start = internal::profiler_ticks ();
+#elif defined (LOG4CPLUS_ENABLE_STAGE_PROFILER)
+    std::uint64_t const start = prof.sampling ? internal::profiler_ticks () : 0;
+#endif
+
+    if (tstring const * cached = getCachedLayoutOutput (*layout,
+            output.getloc (), event))
+        output << *cached;
+    else
+        layout->formatAndAppend (output, event);
+
+#if defined (LOG4CPLUS_ENABLE_STAGE_PROFILER)
+    if (prof.sampling)
+        prof.layout_ticks += internal::profiler_ticks () - start;
+#endif
+
+#if defined (LOG4CPLUS_ENABLE_CALLSITE_PROFILER)
+    internal::get_ptd ()->callsites.layout_ticks
+        += internal::profiler_ticks () - start;
+#endif
+}
+
+
 log4cplus::tstring
 Appender::getName()
 {
@@ -445,8 +1044,10 @@ void
 Appender::setLayout(std::unique_ptr<Layout> lo)
 {
     thread::MutexGuard guard (access_mutex);
+    thread::MutexGuard config_guard (config_mutex);
 
     this->layout = std::move(lo);
+    publishConfig ();
 }
 
 
@@ -464,11 +1065,106 @@ void
 Appender::setFilter(log4cplus::spi::FilterPtr f)
 {
     thread::MutexGuard guard (access_mutex);
+    thread::MutexGuard config_guard (config_mutex);
 
     filter = std::move (f);
+    publishConfig ();
+}
+
+
+void
+Appender::setThreshold(LogLevel th)
+{
+    // The filters cannot change while config_mutex is held, so it is
+    // not necessary to wait for access_mutex and an append in progress.
+    thread::MutexGuard guard (config_mutex);
+
+    threshold = th;
+    publishConfig ();
+}
+
+
+LogLevel
+Appender::getLowestAcceptedLogLevel() const
+{
+    return lowestAcceptedLogLevel.load (std::memory_order_acquire);
+}
+
+
+void
+Appender::publishConfig()
+{
+    thread::MutexGuard guard (config_mutex);
+
+    LogLevel ll = threshold;
+    if (ll == NOT_SET_LOG_LEVEL)
+        ll += 1;
+
+    lowestAcceptedLogLevel.store (
+        spi::getLowestAcceptedLogLevel (filter.get (), ll),
+        std::memory_order_release);
+
+    unsigned fields = spi::getRequiredThreadSpecificData (filter.get ());
+    if (layout)
+        fields |= layout->getRequiredThreadSpecificData ();
+
+    layoutRequiredThreadSpecificData.store (fields,
+        std::memory_order_release);
+
+    if (layout)
+        layoutFingerprint = layout->getFingerprint ();
+    else
+        layoutFingerprint.clear ();
+
+    internal::bumpAppenderConfigGeneration ();
+}
+
+
+unsigned
+Appender::getRequiredThreadSpecificData() const
+{
+    return spi::InternalLoggingEvent::TSD_ALL;
 }
 
 
+unsigned
+Appender::getLayoutRequiredThreadSpecificData() const
+{
+    return layoutRequiredThreadSpecificData.load (std::memory_order_acquire);
+}
+
+
+tstring
+Appender::getLayoutFingerprint() const
+{
+    thread::MutexGuard guard (config_mutex);
+    return layoutFingerprint;
+}
+
+
+#if ! defined (LOG4CPLUS_SINGLE_THREADED)
+unsigned
+Appender::getCachedRequiredThreadSpecificData() const
+{
+    // Lower half holds the flags, with the highest bit of the lower half
+    // marking the cached value as valid.
+    unsigned long long const valid = 0x80000000ull;
+    unsigned long long const generation
+        = internal::getAppenderConfigGeneration ();
+    unsigned long long const cached
+        = requiredThreadSpecificData.load (std::memory_order_acquire);
+    if ((cached & valid) && (cached >> 32) == generation)
+        return static_cast<unsigned>(cached & ~valid & 0xffffffffull);
+
+    unsigned const fields = getRequiredThreadSpecificData ();
+    requiredThreadSpecificData.store ((generation << 32) | valid | fields,
+        std::memory_order_release);
+
+    return fields;
+}
+#endif
+
+
 log4cplus::spi::FilterPtr
 Appender::getFilter() const
 {
@@ -482,14 +1178,14 @@ void
 Appender::addFilter (log4cplus::spi::FilterPtr f)
 {
     thread::MutexGuard guard (access_mutex);
+    thread::MutexGuard config_guard (config_mutex);
 
-    log4cplus::spi::FilterPtr filterChain = getFilter ();
-    if (filterChain)
-        filterChain->appendFilter (std::move (f));
+    if (filter)
+        filter->appendFilter (std::move (f));
     else
-        filterChain = std::move (f);
+        filter = std::move (f);
 
-    setFilter (filterChain);
+    publishConfig ();
 }
 
 
@@ -502,4 +1198,298 @@ Appender::addFilter (std::function<
 }
 
 
+#if defined (LOG4CPLUS_WITH_UNIT_TESTS) \
+    && ! defined (LOG4CPLUS_SINGLE_THREADED)
+namespace
+{
+
+class BlockingAppender
+    : public Appender
+{
+public:
+    BlockingAppender ()
+        : count (0)
+    { }
+
+    virtual ~BlockingAppender ()
+    {
+        destructorImpl ();
+    }
+
+    virtual void close ()
+    { }
+
+    std::atomic<int> count;
+    std::promise<void> entered;
+    std::shared_future<void> release;
+
+    unsigned
+    layoutFields () const
+    {
+        return getLayoutRequiredThreadSpecificData ();
+    }
+
+protected:
+    virtual void append (const spi::InternalLoggingEvent &)
+    {
+        if (count++ == 0)
+        {
+            entered.set_value ();
+            release.wait ();
+        }
+    }
+};
+
+} // namespace
+
+
+CATCH_TEST_CASE ("Appender latency budget", "[appender]")
+{
+    helpers::SharedObjectPtr<BlockingAppender> app (new BlockingAppender);
+    helpers::SharedObjectPtr<BlockingAppender> fallback (
+        new BlockingAppender);
+    std::promise<void> release;
+    app->release = release.get_future ().share ();
+    fallback->count = 1;
+    app->setLatencyBudget (std::chrono::milliseconds (20),
+        SharedAppenderPtr (fallback.get ()));
+
+    spi::InternalLoggingEvent const ev (LOG4CPLUS_TEXT ("latency"),
+        INFO_LOG_LEVEL, LOG4CPLUS_TEXT ("msg"), nullptr, 0);
+
+    // The first append gets stuck.
+    std::thread stuck ([&] { app->doAppend (ev); });
+    app->entered.get_future ().wait ();
+
+    // Other threads wait at most the budget and then use the fallback.
+    app->doAppend (ev);
+    app->doAppend (ev);
+    Appender::LatencyStats stats = app->getLatencyStats ();
+    CATCH_REQUIRE (stats.degraded);
+    CATCH_REQUIRE (stats.degradations == 1);
+    CATCH_REQUIRE (stats.diverted == 2);
+    CATCH_REQUIRE (fallback->count == 3);
+
+    // Once the stuck append finishes, the watchdog restores the appender.
+    release.set_value ();
+    stuck.join ();
+    for (int i = 0; i != 500 && app->getLatencyStats ().degraded; ++i)
+        std::this_thread::sleep_for (std::chrono::milliseconds (10));
+    CATCH_REQUIRE (! app->getLatencyStats ().degraded);
+
+    app->doAppend (ev);
+    CATCH_REQUIRE (app->count == 2);
+    CATCH_REQUIRE (app->getLatencyStats ().diverted == 2);
+}
+
+
+CATCH_TEST_CASE ("Appender latency budget changes during append",
+    "[appender]")
+{
+    helpers::SharedObjectPtr<BlockingAppender> app (new BlockingAppender);
+    std::promise<void> release;
+    app->release = release.get_future ().share ();
+    app->setLatencyBudget (std::chrono::milliseconds (20),
+        SharedAppenderPtr ());
+
+    spi::InternalLoggingEvent const ev (LOG4CPLUS_TEXT ("latency"),
+        INFO_LOG_LEVEL, LOG4CPLUS_TEXT ("msg"), nullptr, 0);
+    std::thread stuck ([&] { app->doAppend (ev); });
+    app->entered.get_future ().wait ();
+
+    // The stuck append keeps using the watchdog it started with.
+    app->setLatencyBudget (std::chrono::milliseconds (30),
+        SharedAppenderPtr ());
+    app->setLatencyBudget (std::chrono::milliseconds::zero (),
+        SharedAppenderPtr ());
+    CATCH_REQUIRE (! app->getLatencyStats ().degraded);
+
+    release.set_value ();
+    stuck.join ();
+    app->doAppend (ev);
+    CATCH_REQUIRE (app->count == 2);
+}
+
+
+CATCH_TEST_CASE ("Appender configuration queries do not wait for append",
+    "[appender]")
+{
+    helpers::SharedObjectPtr<BlockingAppender> app (new BlockingAppender);
+    std::promise<void> release;
+    app->release = release.get_future ().share ();
+
+    spi::InternalLoggingEvent const ev (LOG4CPLUS_TEXT ("config"),
+        INFO_LOG_LEVEL, LOG4CPLUS_TEXT ("msg"), nullptr, 0);
+    std::thread stuck ([&] { app->doAppend (ev); });
+    app->entered.get_future ().wait ();
+
+    // All of these would wait for the stuck append if they needed
+    // access_mutex.
+    auto queries = std::async (std::launch::async, [&]
+        {
+            app->setThreshold (WARN_LOG_LEVEL);
+            return app->getLowestAcceptedLogLevel () == WARN_LOG_LEVEL
+                && app->layoutFields () == 0;
+        });
+    bool const finished = queries.wait_for (std::chrono::seconds (10))
+        == std::future_status::ready;
+
+    release.set_value ();
+    stuck.join ();
+    CATCH_REQUIRE (finished);
+    CATCH_REQUIRE (queries.get ());
+
+    app->setLayout (std::unique_ptr<Layout> (new PatternLayout (
+        LOG4CPLUS_TEXT ("%x %m"))));
+    CATCH_REQUIRE (app->layoutFields ()
+        == spi::InternalLoggingEvent::TSD_NDC);
+}
+
+
+#if defined (LOG4CPLUS_ENABLE_THREAD_POOL)
+namespace
+{
+
+class AsyncCountingAppender
+    : public Appender
+{
+public:
+    explicit AsyncCountingAppender (helpers::Properties const & props)
+        : Appender (props)
+        , count (0)
+        , last (nullptr)
+    { }
+
+    virtual ~AsyncCountingAppender ()
+    {
+        destructorImpl ();
+    }
+
+    virtual void close ()
+    { }
+
+    std::atomic<int> count;
+    std::atomic<spi::InternalLoggingEvent const *> last;
+    std::shared_future<void> release;
+
+protected:
+    virtual void append (const spi::InternalLoggingEvent & event)
+    {
+        last = &event;
+        ++count;
+        if (release.valid ())
+            release.wait ();
+    }
+};
+
+
+helpers::Properties
+asyncAppendProperties ()
+{
+    helpers::Properties props;
+    props.setProperty (LOG4CPLUS_TEXT ("AsyncAppend"),
+        LOG4CPLUS_TEXT ("true"));
+    return props;
+}
+
+} // namespace
+
+
+CATCH_TEST_CASE ("Asynchronous appenders share event copy", "[appender]")
+{
+    helpers::SharedObjectPtr<AsyncCountingAppender> app1 (
+        new AsyncCountingAppender (asyncAppendProperties ()));
+    helpers::SharedObjectPtr<AsyncCountingAppender> app2 (
+        new AsyncCountingAppender (asyncAppendProperties ()));
+    std::promise<void> release;
+    app1->release = app2->release = release.get_future ().share ();
+
+    Hierarchy h;
+    Logger logger = h.getInstance (LOG4CPLUS_TEXT ("async"));
+    logger.addAppender (SharedAppenderPtr (app1.get ()));
+    logger.addAppender (SharedAppenderPtr (app2.get ()));
+    spi::InternalLoggingEvent const ev (LOG4CPLUS_TEXT ("async"),
+        INFO_LOG_LEVEL, LOG4CPLUS_TEXT ("msg"), nullptr, 0);
+    logger.log (ev);
+
+    // Appends are held until both tasks are queued or running, so that
+    // separate copies would be alive at the same time.
+    while (app1->count + app2->count == 0)
+        std::this_thread::yield ();
+    release.set_value ();
+    app1->waitToFinishAsyncLogging ();
+    app2->waitToFinishAsyncLogging ();
+
+    CATCH_REQUIRE (app1->count == 1);
+    CATCH_REQUIRE (app2->count == 1);
+    CATCH_REQUIRE (app1->last.load () != &ev);
+    CATCH_REQUIRE (app1->last.load () == app2->last.load ());
+    h.shutdown ();
+}
+
+
+#if defined (LOG4CPLUS_HAVE_MEMORY_RESOURCE)
+namespace
+{
+
+class CountingResource
+    : public std::pmr::memory_resource
+{
+public:
+    std::atomic<int> allocations {0};
+    std::atomic<int> deallocations {0};
+
+private:
+    void *
+    do_allocate (std::size_t bytes, std::size_t alignment) override
+    {
+        ++allocations;
+        return std::pmr::new_delete_resource ()->allocate (bytes, alignment);
+    }
+
+    void
+    do_deallocate (void * p, std::size_t bytes, std::size_t alignment)
+        override
+    {
+        ++deallocations;
+        std::pmr::new_delete_resource ()->deallocate (p, bytes, alignment);
+    }
+
+    bool
+    do_is_equal (std::pmr::memory_resource const & other) const noexcept
+        override
+    {
+        return this == &other;
+    }
+};
+
+} // namespace
+
+
+CATCH_TEST_CASE ("Asynchronous event memory resource", "[appender]")
+{
+    CountingResource resource;
+    helpers::setAsyncEventMemoryResource (&resource);
+
+    helpers::SharedObjectPtr<AsyncCountingAppender> app (
+        new AsyncCountingAppender (asyncAppendProperties ()));
+    spi::InternalLoggingEvent const ev (LOG4CPLUS_TEXT ("pmr"),
+        INFO_LOG_LEVEL, LOG4CPLUS_TEXT ("msg"), nullptr, 0);
+
+    app->doAppend (ev);
+    app->waitToFinishAsyncLogging ();
+    helpers::setAsyncEventMemoryResource (nullptr);
+    CATCH_REQUIRE (app->count == 1);
+
+    // The event copy and the control block of its shared pointer.
+    CATCH_REQUIRE (resource.allocations == 2);
+    for (int i = 0; i != 500 && resource.deallocations != 2; ++i)
+        std::this_thread::sleep_for (std::chrono::milliseconds (10));
+    CATCH_REQUIRE (resource.deallocations == 2);
+}
+#endif
+#endif
+#endif
+
+
 } // namespace log4cplus
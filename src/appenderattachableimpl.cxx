@@ -24,6 +24,7 @@
 #include <log4cplus/helpers/loglog.h>
 #include <log4cplus/spi/loggingevent.h>
 #include <log4cplus/thread/syncprims-pub-impl.h>
+#include <log4cplus/internal/internal.h>
 
 #include <algorithm>
 
@@ -76,6 +77,7 @@ AppenderAttachableImpl::addAppender(SharedAppenderPtr newAppender)
     if (it == appenderList.end())
     {
         appenderList.push_back(newAppender);
+        internal::bumpAppenderConfigGeneration ();
     }
 }
 
@@ -120,6 +122,7 @@ AppenderAttachableImpl::removeAllAppenders()
         app = SharedAppenderPtr ();
 
     appenderList.clear ();
+    internal::bumpAppenderConfigGeneration ();
 }
 
 
@@ -139,6 +142,7 @@ AppenderAttachableImpl::removeAppender(SharedAppenderPtr appender)
     if (it != appenderList.end())
     {
         appenderList.erase(it);
+        internal::bumpAppenderConfigGeneration ();
     }
 }
 
@@ -27,6 +27,7 @@
 #include <log4cplus/asyncappender.h>
 #include <log4cplus/spi/factory.h>
 #include <log4cplus/helpers/loglog.h>
+#include <log4cplus/helpers/memorybudget.h>
 #include <log4cplus/helpers/property.h>
 #include <log4cplus/thread/syncprims-pub-impl.h>
 
@@ -43,19 +44,23 @@ class QueueThread
     : public thread::AbstractThread
 {
 public:
-    QueueThread (AsyncAppenderPtr, thread::QueuePtr);
+    QueueThread (AsyncAppenderPtr, thread::QueuePtr,
+        std::atomic<std::size_t> &);
 
     void run() override;
 
 private:
     AsyncAppenderPtr appenders;
     thread::QueuePtr queue;
+    std::atomic<std::size_t> & queued_bytes;
 };
 
 
-QueueThread::QueueThread (AsyncAppenderPtr aai, thread::QueuePtr q)
+QueueThread::QueueThread (AsyncAppenderPtr aai, thread::QueuePtr q,
+    std::atomic<std::size_t> & qb)
     : appenders (std::move (aai))
     , queue (std::move (q))
+    , queued_bytes (qb)
 { }
 
 
@@ -71,9 +76,17 @@ QueueThread::run()
         if (qflags & thread::Queue::EVENT)
         {
             auto const ev_buf_end = ev_buf.end ();
+            helpers::MemoryBudget & budget = helpers::getMemoryBudget ();
             for (auto it = ev_buf.begin ();
                 it != ev_buf_end; ++it)
-                appenders->appendLoopOnAppenders (*it);
+            {
+                appenders->appendLoopOnAppenders (it->event);
+
+                std::size_t const bytes = it->reserved;
+                queued_bytes.fetch_sub (bytes, std::memory_order_relaxed);
+                budget.release (helpers::MemoryBudget::ASYNC_APPENDER_QUEUE,
+                    bytes);
+            }
         }
 
         if (((thread::Queue::EXIT | thread::Queue::DRAIN
@@ -142,7 +155,8 @@ void
 AsyncAppender::init_queue_thread (unsigned queue_len)
 {
     queue = new thread::Queue (queue_len);
-    queue_thread = new QueueThread (AsyncAppenderPtr (this), queue);
+    queue_thread = new QueueThread (AsyncAppenderPtr (this), queue,
+        queued_bytes);
     queue_thread->start ();
     helpers::getLogLog ().debug (LOG4CPLUS_TEXT("Queue thread started."));
 }
@@ -162,6 +176,7 @@ AsyncAppender::close ()
     if (queue_thread && queue_thread->isRunning ())
         queue_thread->join ();
 
+    release_queued_bytes ();
     removeAllAppenders();
 
     queue_thread = nullptr;
@@ -169,12 +184,63 @@ AsyncAppender::close ()
 }
 
 
+unsigned
+AsyncAppender::getRequiredThreadSpecificData () const
+{
+    unsigned fields = getLayoutRequiredThreadSpecificData ();
+
+    thread::MutexGuard guard (appender_list_mutex);
+
+    for (auto const & appender : appenderList)
+        fields |= appender->getRequiredThreadSpecificData ();
+
+    return fields;
+}
+
+
+void
+AsyncAppender::release_queued_bytes ()
+{
+    std::size_t const bytes = queued_bytes.exchange (0,
+        std::memory_order_relaxed);
+    if (bytes != 0)
+        helpers::getMemoryBudget ().release (
+            helpers::MemoryBudget::ASYNC_APPENDER_QUEUE, bytes);
+}
+
+
 void
 AsyncAppender::append (spi::InternalLoggingEvent const & ev)
 {
     if (queue_thread && queue_thread->isRunning ())
     {
-        unsigned ret = queue->put_event (ev);
+        unsigned const fields = getCachedRequiredThreadSpecificData ();
+        ev.gatherThreadSpecificData (fields);
+
+        helpers::MemoryBudget & budget = helpers::getMemoryBudget ();
+        std::size_t const bytes
+            = helpers::MemoryBudget::estimateEventSize (ev, fields);
+        if (! budget.tryAcquire (helpers::MemoryBudget::ASYNC_APPENDER_QUEUE,
+                bytes))
+        {
+            if (budget.getOverflowPolicy (
+                    helpers::MemoryBudget::ASYNC_APPENDER_QUEUE)
+                == helpers::MemoryBudget::OVERFLOW_SYNC)
+                appendLoopOnAppenders (ev);
+
+            return;
+        }
+
+        queued_bytes.fetch_add (bytes, std::memory_order_relaxed);
+        unsigned ret = queue->put_event (ev, fields, bytes);
+        if (ret & thread::Queue::EXIT)
+        {
+            // The event has not been queued.
+            queued_bytes.fetch_sub (bytes, std::memory_order_relaxed);
+            budget.release (helpers::MemoryBudget::ASYNC_APPENDER_QUEUE,
+                bytes);
+        }
+
         if (ret & (thread::Queue::ERROR_BIT | thread::Queue::ERROR_AFTER))
         {
             getErrorHandler ()->error (
@@ -184,6 +250,7 @@ AsyncAppender::append (spi::InternalLoggingEvent const & ev)
             // the events queue.
             queue->signal_exit (false);
             queue_thread->join ();
+            release_queued_bytes ();
             queue_thread = nullptr;
             queue = nullptr;
             appendLoopOnAppenders (ev);
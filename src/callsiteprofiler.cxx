@@ -0,0 +1,358 @@
+// -*- C++ -*-
+//
+//  Copyright (C) 2026, Vaclav Zeman. All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without modifica-
+//  tion, are permitted provided that the following conditions are met:
+//
+//  1. Redistributions of  source code must  retain the above copyright  notice,
+//     this list of conditions and the following disclaimer.
+//
+//  2. Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//
+//  THIS SOFTWARE IS PROVIDED ``AS IS'' AND ANY EXPRESSED OR IMPLIED WARRANTIES,
+//  INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+//  FITNESS  FOR A PARTICULAR  PURPOSE ARE  DISCLAIMED.  IN NO  EVENT SHALL  THE
+//  APACHE SOFTWARE  FOUNDATION  OR ITS CONTRIBUTORS  BE LIABLE FOR  ANY DIRECT,
+//  INDIRECT, INCIDENTAL, SPECIAL,  EXEMPLARY, OR CONSEQUENTIAL  DAMAGES (INCLU-
+//  DING, BUT NOT LIMITED TO, PROCUREMENT  OF SUBSTITUTE GOODS OR SERVICES; LOSS
+//  OF USE, DATA, OR  PROFITS; OR BUSINESS  INTERRUPTION)  HOWEVER CAUSED AND ON
+//  ANY  THEORY OF LIABILITY,  WHETHER  IN CONTRACT,  STRICT LIABILITY,  OR TORT
+//  (INCLUDING  NEGLIGENCE OR  OTHERWISE) ARISING IN  ANY WAY OUT OF THE  USE OF
+//  THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <log4cplus/helpers/callsiteprofiler.h>
+#include <log4cplus/helpers/housekeeping.h>
+#include <log4cplus/internal/internal.h>
+#include <log4cplus/thread/syncprims-pub-impl.h>
+#include <algorithm>
+#include <csignal>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+#if defined (LOG4CPLUS_WITH_UNIT_TESTS)
+#include <log4cplus/hierarchy.h>
+#include <log4cplus/logger.h>
+#include <log4cplus/loggingmacros.h>
+#include <log4cplus/nullappender.h>
+#include <catch.hpp>
+#endif
+
+
+namespace log4cplus {
+
+
+#if defined (LOG4CPLUS_ENABLE_CALLSITE_PROFILER)
+
+namespace internal {
+
+
+namespace {
+
+
+struct callsite_totals
+{
+    std::uint64_t count = 0;
+    std::uint64_t bytes = 0;
+    std::uint64_t ticks = 0;
+};
+
+
+//! Totals keyed by callsite name and line, so that the same callsite
+//! seen through different <code>__FILE__</code> literals is merged.
+typedef std::map<std::pair<std::string, int>, callsite_totals>
+    callsite_report;
+
+
+//! Counters of live threads and totals of finished threads.
+struct callsite_profiler_registry
+{
+    thread::Mutex mutex;
+    std::vector<callsite_profiler_data *> threads;
+    callsite_report finished;
+};
+
+
+static
+callsite_profiler_registry &
+get_registry ()
+{
+    // Intentionally leaked; threads can end after static destructors
+    // have run.
+    static callsite_profiler_registry * const registry
+        = new callsite_profiler_registry;
+    return *registry;
+}
+
+
+static
+void
+merge (callsite_report & dest, callsite_table const & src)
+{
+    for (auto const & site : src)
+    {
+        callsite_totals & totals = dest[std::make_pair (
+            std::string (site.first.first ? site.first.first : "?"),
+            site.first.second)];
+        totals.count += site.second.count.load (std::memory_order_relaxed);
+        totals.bytes += site.second.bytes.load (std::memory_order_relaxed);
+        totals.ticks += site.second.ticks.load (std::memory_order_relaxed);
+    }
+}
+
+
+//! Set by the signal handler installed by setCallsiteProfileSignal().
+static std::atomic<bool> dump_requested (false);
+
+static_assert (std::atomic<bool>::is_always_lock_free);
+
+
+extern "C"
+void
+callsite_profile_signal_handler (int)
+{
+    dump_requested.store (true, std::memory_order_relaxed);
+}
+
+
+} // namespace
+
+
+callsite_profiler_data::callsite_profiler_data ()
+    : mark (0)
+    , layout_ticks (0)
+{
+    callsite_profiler_registry & registry = get_registry ();
+    thread::MutexGuard guard (registry.mutex);
+    registry.threads.push_back (this);
+}
+
+
+callsite_profiler_data::~callsite_profiler_data ()
+{
+    callsite_profiler_registry & registry = get_registry ();
+    thread::MutexGuard guard (registry.mutex);
+    registry.threads.erase (std::find (registry.threads.begin (),
+        registry.threads.end (), this));
+    merge (registry.finished, sites);
+}
+
+
+callsite_table::iterator
+callsite_profiler_data::insert (callsite_key const & key)
+{
+    thread::MutexGuard guard (mutex);
+    return sites.emplace (std::piecewise_construct,
+        std::forward_as_tuple (key), std::forward_as_tuple ()).first;
+}
+
+
+} // namespace internal
+
+
+namespace helpers {
+
+
+bool
+isCallsiteProfilerEnabled ()
+{
+    return true;
+}
+
+
+void
+resetCallsiteProfile ()
+{
+    internal::callsite_profiler_registry & registry
+        = internal::get_registry ();
+    thread::MutexGuard guard (registry.mutex);
+    registry.finished.clear ();
+
+    // Owning threads look callsites up without locking, so the counters
+    // are zeroed instead of removing them.
+    for (internal::callsite_profiler_data * data : registry.threads)
+    {
+        thread::MutexGuard data_guard (data->mutex);
+        for (auto & site : data->sites)
+        {
+            site.second.count.store (0, std::memory_order_relaxed);
+            site.second.bytes.store (0, std::memory_order_relaxed);
+            site.second.ticks.store (0, std::memory_order_relaxed);
+        }
+    }
+}
+
+
+void
+dumpCallsiteProfile (tostream & os, std::size_t max_rows)
+{
+    internal::callsite_report report;
+    {
+        internal::callsite_profiler_registry & registry
+            = internal::get_registry ();
+        thread::MutexGuard guard (registry.mutex);
+        report = registry.finished;
+        for (internal::callsite_profiler_data * data : registry.threads)
+        {
+            thread::MutexGuard data_guard (data->mutex);
+            internal::merge (report, data->sites);
+        }
+    }
+
+    typedef internal::callsite_report::value_type row_type;
+    std::vector<row_type const *> rows;
+    rows.reserve (report.size ());
+    for (row_type const & row : report)
+        if (row.second.count != 0)
+            rows.push_back (&row);
+
+    std::stable_sort (rows.begin (), rows.end (),
+        [] (row_type const * a, row_type const * b) {
+            return a->second.ticks > b->second.ticks; });
+    if (max_rows != 0 && rows.size () > max_rows)
+        rows.resize (max_rows);
+
+    std::ios_base::fmtflags const flags = os.flags ();
+    os << LOG4CPLUS_TEXT ("log4cplus callsite profile") << std::endl
+        << std::right << std::setw (12) << LOG4CPLUS_TEXT ("events")
+        << std::setw (14) << LOG4CPLUS_TEXT ("bytes")
+        << std::setw (16) << LOG4CPLUS_TEXT ("ticks")
+        << std::setw (12) << LOG4CPLUS_TEXT ("avg ticks")
+        << LOG4CPLUS_TEXT ("  callsite") << std::endl;
+    for (row_type const * row : rows)
+    {
+        internal::callsite_totals const & totals = row->second;
+        os << std::setw (12) << totals.count
+            << std::setw (14) << totals.bytes
+            << std::setw (16) << totals.ticks
+            << std::setw (12) << totals.ticks / totals.count
+            << LOG4CPLUS_TEXT ("  ")
+            << LOG4CPLUS_STRING_TO_TSTRING (row->first.first)
+            << LOG4CPLUS_TEXT (':') << row->first.second << std::endl;
+    }
+    os.flags (flags);
+}
+
+
+bool
+setCallsiteProfileSignal (int LOG4CPLUS_THREADED (signum))
+{
+#if ! defined (LOG4CPLUS_SINGLE_THREADED)
+    static thread::Mutex mutex;
+    static bool task_scheduled = false;
+
+    thread::MutexGuard guard (mutex);
+    if (std::signal (signum, internal::callsite_profile_signal_handler)
+        == SIG_ERR)
+        return false;
+
+    if (! task_scheduled)
+    {
+        scheduleHousekeepingTask (std::chrono::milliseconds (200),
+            [] {
+                if (internal::dump_requested.exchange (false,
+                        std::memory_order_relaxed))
+                    dumpCallsiteProfile (tcerr);
+            });
+        task_scheduled = true;
+    }
+
+    return true;
+
+#else
+    return false;
+
+#endif
+}
+
+
+#if defined (LOG4CPLUS_WITH_UNIT_TESTS)
+CATCH_TEST_CASE ("Callsite profiler", "[callsiteprofiler]")
+{
+    Hierarchy h;
+    Logger logger = h.getInstance (LOG4CPLUS_TEXT ("profiled"));
+    logger.addAppender (SharedAppenderPtr (new NullAppender));
+
+    resetCallsiteProfile ();
+    for (int i = 0; i != 10; ++i)
+    {
+        LOG4CPLUS_INFO (logger, LOG4CPLUS_TEXT ("abc"));
+        if (i % 2 == 0)
+            LOG4CPLUS_INFO (logger, LOG4CPLUS_TEXT ("12345") << i);
+    }
+    LOG4CPLUS_DEBUG (logger, LOG4CPLUS_TEXT ("x"));
+
+    tostringstream oss;
+    dumpCallsiteProfile (oss);
+    tistringstream iss (oss.str ());
+    tstring line;
+    std::getline (iss, line);
+    std::getline (iss, line);
+
+    std::uint64_t count = 0, bytes = 0, ticks = 0, avg = 0;
+    tstring callsite;
+    std::size_t rows = 0;
+    std::uint64_t total_count = 0, total_bytes = 0;
+    while (iss >> count >> bytes >> ticks >> avg >> callsite)
+    {
+        ++rows;
+        total_count += count;
+        total_bytes += bytes;
+        CATCH_REQUIRE (callsite.find (LOG4CPLUS_TEXT ("callsiteprofiler"))
+            != tstring::npos);
+    }
+    CATCH_REQUIRE (rows == 3);
+    CATCH_REQUIRE (total_count == 16);
+    CATCH_REQUIRE (total_bytes == (10 * 3 + 5 * 6 + 1) * sizeof (tchar));
+
+    resetCallsiteProfile ();
+    h.shutdown ();
+}
+#endif
+
+
+} // namespace helpers
+
+#else // defined (LOG4CPLUS_ENABLE_CALLSITE_PROFILER)
+
+namespace helpers {
+
+
+bool
+isCallsiteProfilerEnabled ()
+{
+    return false;
+}
+
+
+void
+resetCallsiteProfile ()
+{ }
+
+
+void
+dumpCallsiteProfile (tostream & os, std::size_t)
+{
+    os << LOG4CPLUS_TEXT ("log4cplus has been built without")
+        LOG4CPLUS_TEXT (" LOG4CPLUS_ENABLE_CALLSITE_PROFILER") << std::endl;
+}
+
+
+bool
+setCallsiteProfileSignal (int)
+{
+    return false;
+}
+
+
+} // namespace helpers
+
+#endif // defined (LOG4CPLUS_ENABLE_CALLSITE_PROFILER)
+
+
+} // namespace log4cplus
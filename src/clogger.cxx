@@ -282,7 +282,8 @@ log4cplus_logger_log(const log4cplus_char_t *name, loglevel_t ll,
             do
             {
                 va_start(ap, msgfmt);
-                retval = buf.print_va_list(msg, msgfmt, ap);
+                retval = buf.print_va_list(
+                    logger.getChainedMaxMessageSize(), msg, msgfmt, ap);
                 va_end(ap);
             }
             while (retval == -1);
@@ -343,7 +344,8 @@ log4cplus_logger_force_log(const log4cplus_char_t *name, loglevel_t ll,
         do
         {
             va_start(ap, msgfmt);
-            retval = buf.print_va_list(msg, msgfmt, ap);
+            retval = buf.print_va_list(
+                logger.getChainedMaxMessageSize(), msg, msgfmt, ap);
             va_end(ap);
         }
         while (retval == -1);
@@ -19,13 +19,14 @@
 // limitations under the License.
 
 #include <log4cplus/configurator.h>
-#include <log4cplus/hierarchylocker.h>
 #include <log4cplus/hierarchy.h>
 #include <log4cplus/helpers/loglog.h>
+#include <log4cplus/helpers/memorybudget.h>
 #include <log4cplus/helpers/stringhelper.h>
 #include <log4cplus/helpers/property.h>
 #include <log4cplus/helpers/timehelper.h>
 #include <log4cplus/helpers/fileinfo.h>
+#include <log4cplus/helpers/housekeeping.h>
 #include <log4cplus/thread/threads.h>
 #include <log4cplus/thread/syncprims-pub-impl.h>
 #include <log4cplus/spi/factory.h>
@@ -47,6 +48,7 @@
 #endif
 
 #include <algorithm>
+#include <atomic>
 #include <cstdlib>
 #include <iterator>
 #include <sstream>
@@ -267,6 +269,17 @@ PropertyConfigurator::doConfigure(const tstring& file, Hierarchy& h,
 }
 
 
+void
+PropertyConfigurator::doStagedConfigure(const tstring& file, Hierarchy& h,
+    unsigned flags)
+{
+    Hierarchy staged;
+    PropertyConfigurator tmp(file, staged, flags);
+    tmp.configure();
+    h.publishConfiguration(staged);
+}
+
+
 
 //////////////////////////////////////////////////////////////////////////////
 // PropertyConfigurator public methods
@@ -297,9 +310,12 @@ PropertyConfigurator::configure()
 
     setThreadPoolSize (thread_pool_size);
 
+    configureMemoryBudget ();
+
     configureAppenders();
     configureLoggers();
     configureAdditivity();
+    configureMaxMessageSize();
 
     if (disable_override)
         h.disable (Hierarchy::DISABLE_OVERRIDE);
@@ -527,6 +543,65 @@ PropertyConfigurator::configureAdditivity()
 }
 
 
+void
+PropertyConfigurator::configureMaxMessageSize()
+{
+    unsigned long size;
+    if (properties.getULong (size, LOG4CPLUS_TEXT ("maxMessageSize")))
+        h.getRoot ().setMaxMessageSize (size);
+
+    helpers::Properties sizeProperties
+        = properties.getPropertySubset (LOG4CPLUS_TEXT ("maxMessageSize."));
+    std::vector<tstring> const loggers = sizeProperties.propertyNames ();
+    for (tstring const & loggerName : loggers)
+    {
+        if (sizeProperties.getULong (size, loggerName))
+            getLogger (loggerName).setMaxMessageSize (size);
+    }
+}
+
+
+void
+PropertyConfigurator::configureMemoryBudget()
+{
+    helpers::MemoryBudget & budget = helpers::getMemoryBudget ();
+
+    // The budget is process wide. Configurations which do not mention it
+    // leave it as it is, e.g., as set up by the application.
+    unsigned long limit = 0;
+    bool const has_limit
+        = properties.getULong (limit, LOG4CPLUS_TEXT ("memoryBudget"));
+    helpers::Properties const policyProperties
+        = properties.getPropertySubset (LOG4CPLUS_TEXT ("memoryBudget."));
+    if (! has_limit && policyProperties.size () == 0)
+        return;
+
+    if (has_limit)
+        budget.setLimit (limit);
+
+    // Policies are replaced as a whole, so that policies dropped from the
+    // configuration revert to the default.
+    for (int i = 0; i != helpers::MemoryBudget::COMPONENT_COUNT; ++i)
+    {
+        auto const c = static_cast<helpers::MemoryBudget::Component>(i);
+        tstring const & policy = policyProperties.getProperty (
+            helpers::MemoryBudget::getComponentName (c));
+        if (policy.empty ()
+            || helpers::toUpper (policy) == LOG4CPLUS_TEXT ("SYNC"))
+            budget.setOverflowPolicy (c, helpers::MemoryBudget::OVERFLOW_SYNC);
+        else if (helpers::toUpper (policy) == LOG4CPLUS_TEXT ("DISCARD"))
+            budget.setOverflowPolicy (c,
+                helpers::MemoryBudget::OVERFLOW_DISCARD);
+        else
+        {
+            helpers::getLogLog ().error (
+                LOG4CPLUS_TEXT ("Unknown memory budget overflow policy: ")
+                + policy);
+            budget.setOverflowPolicy (c, helpers::MemoryBudget::OVERFLOW_SYNC);
+        }
+    }
+}
+
 
 Logger
 PropertyConfigurator::getLogger(const tstring& name)
@@ -586,6 +661,10 @@ BasicConfigurator::doConfigure(Hierarchy& h, bool logToStdErr)
 // ConfigurationWatchDogThread implementation
 //////////////////////////////////////////////////////////////////////////////
 
+//! Checks the configuration file for modifications periodically on the
+//! housekeeping thread. The reconfiguration itself runs on this thread,
+//! so that appenders connecting or opening files while they are being
+//! configured do not stall other housekeeping tasks.
 class ConfigurationWatchDogThread
     : public thread::AbstractThread,
       public PropertyConfigurator
@@ -594,8 +673,9 @@ public:
     ConfigurationWatchDogThread(const tstring& file, unsigned int millis)
         : PropertyConfigurator(file)
         , waitMillis(millis < 1000 ? 1000 : millis)
+        , taskId(0)
         , shouldTerminate(false)
-        , lock(nullptr)
+        , reconfigurePending(false)
     {
         lastFileInfo.mtime = helpers::now ();
         lastFileInfo.size = 0;
@@ -606,16 +686,26 @@ public:
 
     ~ConfigurationWatchDogThread () override = default;
 
+    void startWatching ()
+    {
+        start ();
+        taskId = helpers::scheduleHousekeepingTask (
+            std::chrono::milliseconds (waitMillis), [this] { check (); });
+    }
+
     void terminate ()
     {
-        shouldTerminate.signal ();
+        helpers::cancelHousekeepingTask (taskId);
+        shouldTerminate.store (true);
+        wakeUp.signal ();
         join ();
     }
 
 protected:
     void run() override;
-    Logger getLogger(const tstring& name) override;
-    void addAppender(Logger &logger, SharedAppenderPtr& appender) override;
+
+    //! Housekeeping task, wakes up the thread when the file changes.
+    void check();
 
     bool checkForFileModification();
     void updateLastModInfo();
@@ -626,53 +716,48 @@ private:
         ConfigurationWatchDogThread const &) = delete;
 
     unsigned int const waitMillis;
-    thread::ManualResetEvent shouldTerminate;
+    helpers::HousekeepingTaskId taskId;
     helpers::FileInfo lastFileInfo;
-    HierarchyLocker* lock;
+    thread::ManualResetEvent wakeUp;
+    std::atomic<bool> shouldTerminate;
+
+    //! Set by check() and cleared by run() after
+    //! <code>lastFileInfo</code> is updated. The file is not checked
+    //! meanwhile.
+    std::atomic<bool> reconfigurePending;
 };
 
 
 void
-ConfigurationWatchDogThread::run()
+ConfigurationWatchDogThread::check()
 {
-    while (! shouldTerminate.timed_wait (waitMillis))
+    if (reconfigurePending.load (std::memory_order_acquire))
+        return;
+
+    if (checkForFileModification())
     {
-        bool modified = checkForFileModification();
-        if(modified) {
-            // Lock the Hierarchy
-            HierarchyLocker theLock(h);
-            lock = &theLock;
-
-            // reconfigure the Hierarchy
-            theLock.resetConfiguration();
-            reconfigure();
-            updateLastModInfo();
-
-            // release the lock
-            lock = nullptr;
-        }
+        reconfigurePending.store (true, std::memory_order_relaxed);
+        wakeUp.signal ();
     }
 }
 
 
-Logger
-ConfigurationWatchDogThread::getLogger(const tstring& name)
-{
-    if(lock)
-        return lock->getInstance(name);
-    else
-        return PropertyConfigurator::getLogger(name);
-}
-
-
 void
-ConfigurationWatchDogThread::addAppender(Logger& logger,
-                                         SharedAppenderPtr& appender)
+ConfigurationWatchDogThread::run()
 {
-    if(lock)
-        lock->addAppender(logger, appender);
-    else
-        PropertyConfigurator::addAppender(logger, appender);
+    for (;;)
+    {
+        wakeUp.wait ();
+        wakeUp.reset ();
+        if (shouldTerminate.load ())
+            break;
+
+        // Build the new configuration in a scratch hierarchy and publish
+        // it at once, so that logging is not blocked while it is built.
+        doStagedConfigure(propertyFilename, h, PropertyConfigurator::flags);
+        updateLastModInfo();
+        reconfigurePending.store (false, std::memory_order_release);
+    }
 }
 
 
@@ -727,7 +812,7 @@ ConfigureAndWatchThread::ConfigureAndWatchThread(const tstring& file,
     watchDogThread = new ConfigurationWatchDogThread(file, millis);
     watchDogThread->addReference ();
     watchDogThread->configure();
-    watchDogThread->start();
+    watchDogThread->startWatching();
 }
 
 
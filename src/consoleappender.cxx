@@ -92,6 +92,13 @@ ConsoleAppender::close()
 }
 
 
+unsigned
+ConsoleAppender::getRequiredThreadSpecificData() const
+{
+    return getLayoutRequiredThreadSpecificData ();
+}
+
+
 
 //////////////////////////////////////////////////////////////////////////////
 // ConsoleAppender protected methods
@@ -103,7 +110,7 @@ ConsoleAppender::append(const spi::InternalLoggingEvent& event)
     thread::MutexGuard guard (getOutputMutex ());
 
     tostream& output = (logToStdErr ? tcerr : tcout);
-    layout->formatAndAppend(output, event);
+    formatAndAppend(output, event);
     if(immediateFlush) {
         output.flush();
     }
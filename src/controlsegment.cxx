@@ -0,0 +1,717 @@
+// -*- C++ -*-
+//
+//  Copyright (C) 2026, Vaclav Zeman. All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without modifica-
+//  tion, are permitted provided that the following conditions are met:
+//
+//  1. Redistributions of  source code must  retain the above copyright  notice,
+//     this list of conditions and the following disclaimer.
+//
+//  2. Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//
+//  THIS SOFTWARE IS PROVIDED ``AS IS'' AND ANY EXPRESSED OR IMPLIED WARRANTIES,
+//  INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+//  FITNESS  FOR A PARTICULAR  PURPOSE ARE  DISCLAIMED.  IN NO  EVENT SHALL  THE
+//  APACHE SOFTWARE  FOUNDATION  OR ITS CONTRIBUTORS  BE LIABLE FOR  ANY DIRECT,
+//  INDIRECT, INCIDENTAL, SPECIAL,  EXEMPLARY, OR CONSEQUENTIAL  DAMAGES (INCLU-
+//  DING, BUT NOT LIMITED TO, PROCUREMENT  OF SUBSTITUTE GOODS OR SERVICES; LOSS
+//  OF USE, DATA, OR  PROFITS; OR BUSINESS  INTERRUPTION)  HOWEVER CAUSED AND ON
+//  ANY  THEORY OF LIABILITY,  WHETHER  IN CONTRACT,  STRICT LIABILITY,  OR TORT
+//  (INCLUDING  NEGLIGENCE OR  OTHERWISE) ARISING IN  ANY WAY OUT OF THE  USE OF
+//  THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <log4cplus/controlsegment.h>
+#include <log4cplus/hierarchy.h>
+#include <log4cplus/appender.h>
+#include <log4cplus/helpers/housekeeping.h>
+#include <log4cplus/helpers/loglog.h>
+#include <log4cplus/helpers/stringhelper.h>
+#include <log4cplus/thread/syncprims-pub-impl.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <string>
+#include <thread>
+
+#if defined (LOG4CPLUS_WITH_UNIT_TESTS)
+#include <log4cplus/nullappender.h>
+#include <catch.hpp>
+#endif
+
+#if defined (__unix__) || defined (__APPLE__)
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define LOG4CPLUS_CONTROL_SEGMENT_MMAP
+#endif
+
+
+namespace log4cplus {
+
+
+namespace {
+
+
+//! Identifies the segment file format.
+static char const control_magic[8] = "L4CPCTL";
+
+static std::uint32_t const control_version = 1;
+
+//! Number of slots of segments created by ControlSegment.
+static std::uint32_t const control_slot_count = 256;
+
+//! Size of the name field of a slot, including terminating zero.
+static std::size_t const control_name_size = 116;
+
+//! Name of the root logger in the segment.
+static tchar const control_root_name[] = LOG4CPLUS_TEXT ("root");
+
+//! Maximum number of reads of a slot that is being written.
+static int const control_read_retries = 100;
+
+//! How long a writer waits for the writer lock before it takes it over
+//! from a writer that has presumably died while holding it.
+static std::chrono::seconds const control_lock_timeout (1);
+
+
+enum ControlSlotKind : std::int32_t
+{
+    CONTROL_SLOT_EMPTY = 0,
+    CONTROL_SLOT_LOGGER = 1,
+    CONTROL_SLOT_APPENDER = 2
+};
+
+
+// The segment is shared by processes, so only lock free atomics of fixed
+// size types can be placed in it.
+static_assert (std::atomic<std::uint32_t>::is_always_lock_free);
+static_assert (std::atomic<std::int32_t>::is_always_lock_free);
+
+
+//! Slot is protected by sequence lock; the sequence is odd while
+//! the slot is being written.
+struct ControlSlot
+{
+    std::atomic<std::uint32_t> sequence;
+    std::atomic<std::int32_t> kind;
+    std::atomic<std::int32_t> level;
+    char name[control_name_size];
+};
+
+
+struct ControlHeader
+{
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t slot_count;
+    std::uint32_t owner_pid;
+    std::atomic<std::uint32_t> generation;
+    std::atomic<std::uint32_t> writer_lock;
+    std::uint32_t reserved;
+};
+
+
+//! Consistent copy of a slot.
+struct ControlSlotValue
+{
+    std::int32_t kind;
+    std::int32_t level;
+    std::string name;
+};
+
+
+} // namespace
+
+
+//! Memory mapping of the segment shared by ControlSegment and
+//! ControlSegmentClient.
+class ControlMapping
+{
+public:
+    ControlMapping () = default;
+    ~ControlMapping ();
+
+    //! Creates new segment replacing any stale file at <code>path</code>.
+    bool create (std::string const & path);
+
+    //! Maps existing segment at <code>path</code>.
+    bool attach (std::string const & path);
+
+    //! Assigns <code>level</code> to slot identified by <code>kind</code>
+    //! and <code>name</code>, allocating a new slot if necessary.
+    bool write (std::int32_t kind, std::string const & name,
+        std::int32_t level);
+
+    //! Copies slot <code>index</code> into <code>value</code>.
+    //! \return False if the slot has been written all the time.
+    bool read (std::size_t index, ControlSlotValue & value,
+        std::uint32_t & sequence) const;
+
+    std::size_t
+    slotCount () const
+    {
+        return header ? header->slot_count : 0;
+    }
+
+    ControlHeader * header = nullptr;
+    ControlSlot * slots = nullptr;
+    std::size_t size = 0;
+    std::string path;
+    bool owner = false;
+
+    //! Serializes poll() of the owner.
+    thread::Mutex mutex;
+
+    //! Sequences of slots the owner has already applied.
+    std::vector<std::uint32_t> applied;
+
+    //! Generation the owner has already applied.
+    std::uint32_t applied_generation = 0;
+
+private:
+    void lockWriter ();
+    void unlockWriter ();
+};
+
+
+#if defined (LOG4CPLUS_CONTROL_SEGMENT_MMAP)
+
+static
+std::size_t
+controlSegmentSize (std::uint32_t slot_count)
+{
+    return sizeof (ControlHeader) + slot_count * sizeof (ControlSlot);
+}
+
+
+ControlMapping::~ControlMapping ()
+{
+    if (header)
+        ::munmap (header, size);
+
+    if (owner)
+        ::unlink (path.c_str ());
+}
+
+
+bool
+ControlMapping::create (std::string const & path_)
+{
+    // A file left behind by a crashed process with the same pid would
+    // otherwise make O_EXCL fail.
+    ::unlink (path_.c_str ());
+    int fd = ::open (path_.c_str (), O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC,
+        S_IRUSR | S_IWUSR);
+    if (fd == -1)
+        return false;
+
+    std::size_t const segment_size = controlSegmentSize (control_slot_count);
+    void * mem = MAP_FAILED;
+    if (::ftruncate (fd, static_cast<off_t>(segment_size)) == 0)
+        mem = ::mmap (nullptr, segment_size, PROT_READ | PROT_WRITE,
+            MAP_SHARED, fd, 0);
+    int const eno = errno;
+    ::close (fd);
+    if (mem == MAP_FAILED)
+    {
+        ::unlink (path_.c_str ());
+        errno = eno;
+        return false;
+    }
+
+    path = path_;
+    owner = true;
+    size = segment_size;
+    header = new (mem) ControlHeader ();
+    header->version = control_version;
+    header->slot_count = control_slot_count;
+    header->owner_pid = static_cast<std::uint32_t>(::getpid ());
+    slots = reinterpret_cast<ControlSlot *>(header + 1);
+    for (std::uint32_t i = 0; i != control_slot_count; ++i)
+        new (&slots[i]) ControlSlot ();
+    applied.assign (control_slot_count, 0);
+
+    // Clients check the magic last, so it is written last.
+    std::atomic_thread_fence (std::memory_order_release);
+    std::memcpy (header->magic, control_magic, sizeof (control_magic));
+    return true;
+}
+
+
+bool
+ControlMapping::attach (std::string const & path_)
+{
+    int fd = ::open (path_.c_str (), O_RDWR | O_CLOEXEC);
+    if (fd == -1)
+        return false;
+
+    struct stat st;
+    void * mem = MAP_FAILED;
+    if (::fstat (fd, &st) == 0
+        && static_cast<std::size_t>(st.st_size) >= sizeof (ControlHeader))
+        mem = ::mmap (nullptr, static_cast<std::size_t>(st.st_size),
+            PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close (fd);
+    if (mem == MAP_FAILED)
+        return false;
+
+    auto hdr = static_cast<ControlHeader *>(mem);
+    std::size_t const segment_size = static_cast<std::size_t>(st.st_size);
+    if (std::memcmp (hdr->magic, control_magic, sizeof (control_magic)) != 0
+        || hdr->version != control_version
+        || controlSegmentSize (hdr->slot_count) != segment_size)
+    {
+        ::munmap (mem, segment_size);
+        return false;
+    }
+
+    path = path_;
+    size = segment_size;
+    header = hdr;
+    slots = reinterpret_cast<ControlSlot *>(header + 1);
+    return true;
+}
+
+#else
+
+ControlMapping::~ControlMapping () = default;
+
+
+bool
+ControlMapping::create (std::string const &)
+{
+    return false;
+}
+
+
+bool
+ControlMapping::attach (std::string const &)
+{
+    return false;
+}
+
+#endif
+
+
+void
+ControlMapping::lockWriter ()
+{
+    auto const deadline = std::chrono::steady_clock::now ()
+        + control_lock_timeout;
+    std::uint32_t expected = 0;
+    while (! header->writer_lock.compare_exchange_weak (expected, 1,
+            std::memory_order_acquire, std::memory_order_relaxed))
+    {
+        expected = 0;
+        if (std::chrono::steady_clock::now () >= deadline)
+        {
+            helpers::getLogLog ().warn (
+                LOG4CPLUS_TEXT ("ControlMapping- taking over stale writer")
+                LOG4CPLUS_TEXT (" lock"));
+            header->writer_lock.exchange (1, std::memory_order_acquire);
+            break;
+        }
+        std::this_thread::yield ();
+    }
+}
+
+
+void
+ControlMapping::unlockWriter ()
+{
+    header->writer_lock.store (0, std::memory_order_release);
+}
+
+
+bool
+ControlMapping::write (std::int32_t kind, std::string const & name,
+    std::int32_t level)
+{
+    if (! header || name.empty () || name.size () >= control_name_size)
+        return false;
+
+    lockWriter ();
+
+    ControlSlot * slot = nullptr;
+    ControlSlot * empty = nullptr;
+    for (std::size_t i = 0; i != slotCount (); ++i)
+    {
+        // Only writers change kind and name and we hold the writer lock.
+        ControlSlot & s = slots[i];
+        std::int32_t const slot_kind = s.kind.load (std::memory_order_relaxed);
+        if (slot_kind == CONTROL_SLOT_EMPTY)
+        {
+            if (! empty)
+                empty = &s;
+        }
+        else if (slot_kind == kind && name == s.name)
+        {
+            slot = &s;
+            break;
+        }
+    }
+
+    if (! slot)
+        slot = empty;
+
+    if (slot)
+    {
+        std::uint32_t const seq
+            = slot->sequence.load (std::memory_order_relaxed);
+        slot->sequence.store (seq + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence (std::memory_order_release);
+        slot->kind.store (kind, std::memory_order_relaxed);
+        slot->level.store (level, std::memory_order_relaxed);
+        std::memset (slot->name, 0, control_name_size);
+        std::memcpy (slot->name, name.data (), name.size ());
+        slot->sequence.store (seq + 2, std::memory_order_release);
+        header->generation.fetch_add (1, std::memory_order_acq_rel);
+    }
+
+    unlockWriter ();
+    return slot != nullptr;
+}
+
+
+bool
+ControlMapping::read (std::size_t index, ControlSlotValue & value,
+    std::uint32_t & sequence) const
+{
+    ControlSlot const & slot = slots[index];
+    char name[control_name_size];
+    for (int retry = 0; retry != control_read_retries; ++retry)
+    {
+        std::uint32_t const seq
+            = slot.sequence.load (std::memory_order_acquire);
+        if (seq & 1)
+        {
+            std::this_thread::yield ();
+            continue;
+        }
+
+        value.kind = slot.kind.load (std::memory_order_relaxed);
+        value.level = slot.level.load (std::memory_order_relaxed);
+        std::memcpy (name, slot.name, control_name_size);
+        std::atomic_thread_fence (std::memory_order_acquire);
+        if (slot.sequence.load (std::memory_order_relaxed) == seq)
+        {
+            name[control_name_size - 1] = 0;
+            value.name = name;
+            sequence = seq;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+
+//////////////////////////////////////////////////////////////////////////////
+// ControlSegment
+//////////////////////////////////////////////////////////////////////////////
+
+ControlSegment::ControlSegment (Hierarchy & h, tstring const & path_,
+    unsigned int millis)
+    : hierarchy (h)
+    , path (path_.empty ()
+#if defined (LOG4CPLUS_CONTROL_SEGMENT_MMAP)
+        ? getDefaultPath (static_cast<unsigned long>(::getpid ()))
+#else
+        ? tstring ()
+#endif
+        : path_)
+    , mapping (new ControlMapping)
+    , pollTask (0)
+{
+    helpers::LogLog & loglog = helpers::getLogLog ();
+    if (! mapping->create (LOG4CPLUS_TSTRING_TO_STRING (path)))
+    {
+        loglog.error (LOG4CPLUS_TEXT ("ControlSegment- cannot create ")
+            + path + LOG4CPLUS_TEXT (": ")
+            + helpers::convertIntegerToString (errno));
+        mapping.reset ();
+        return;
+    }
+
+    // Publish levels and thresholds that are set at the moment.
+    LoggerList loggers = hierarchy.getCurrentLoggers ();
+    loggers.push_back (hierarchy.getRoot ());
+    std::vector<tstring> appender_names;
+    bool full = false;
+    for (Logger & logger : loggers)
+    {
+        LogLevel const ll = logger.getLogLevel ();
+        if (ll != NOT_SET_LOG_LEVEL)
+        {
+            full |= ! mapping->write (CONTROL_SLOT_LOGGER,
+                LOG4CPLUS_TSTRING_TO_STRING (logger.getName ()), ll);
+        }
+
+        for (SharedAppenderPtr const & appender : logger.getAllAppenders ())
+        {
+            tstring const & name = appender->getName ();
+            if (std::find (appender_names.begin (), appender_names.end (),
+                    name) != appender_names.end ())
+                continue;
+
+            appender_names.push_back (name);
+            full |= ! mapping->write (CONTROL_SLOT_APPENDER,
+                LOG4CPLUS_TSTRING_TO_STRING (name),
+                appender->getThreshold ());
+        }
+    }
+
+    if (full)
+        loglog.warn (LOG4CPLUS_TEXT ("ControlSegment- not all levels and")
+            LOG4CPLUS_TEXT (" thresholds could be published in ") + path);
+
+    // Values published above are already in effect.
+    for (std::size_t i = 0; i != mapping->slotCount (); ++i)
+        mapping->applied[i]
+            = mapping->slots[i].sequence.load (std::memory_order_relaxed);
+    mapping->applied_generation
+        = mapping->header->generation.load (std::memory_order_relaxed);
+
+#if ! defined (LOG4CPLUS_SINGLE_THREADED)
+    if (millis != 0)
+        pollTask = helpers::scheduleHousekeepingTask (
+            std::chrono::milliseconds (millis), [this] { poll (); });
+#else
+    (void) millis;
+#endif
+}
+
+
+ControlSegment::~ControlSegment ()
+{
+#if ! defined (LOG4CPLUS_SINGLE_THREADED)
+    if (pollTask != 0)
+        helpers::cancelHousekeepingTask (pollTask);
+#endif
+}
+
+
+bool
+ControlSegment::isOpen () const
+{
+    return !! mapping;
+}
+
+
+tstring const &
+ControlSegment::getPath () const
+{
+    return path;
+}
+
+
+std::size_t
+ControlSegment::poll ()
+{
+    if (! mapping)
+        return 0;
+
+    thread::MutexGuard guard (mapping->mutex);
+
+    std::uint32_t const generation
+        = mapping->header->generation.load (std::memory_order_acquire);
+    if (generation == mapping->applied_generation)
+        return 0;
+
+    std::size_t changes = 0;
+    bool complete = true;
+    ControlSlotValue value;
+    for (std::size_t i = 0; i != mapping->slotCount (); ++i)
+    {
+        std::uint32_t const seq
+            = mapping->slots[i].sequence.load (std::memory_order_relaxed);
+        if (seq == mapping->applied[i])
+            continue;
+
+        std::uint32_t read_seq = 0;
+        if (! mapping->read (i, value, read_seq))
+        {
+            complete = false;
+            continue;
+        }
+
+        mapping->applied[i] = read_seq;
+        tstring const name = LOG4CPLUS_STRING_TO_TSTRING (value.name);
+        LogLevel const ll = value.level;
+        if (value.kind == CONTROL_SLOT_LOGGER)
+        {
+            Logger logger = name == control_root_name
+                ? hierarchy.getRoot () : hierarchy.getInstance (name);
+            logger.setLogLevel (ll);
+            ++changes;
+        }
+        else if (value.kind == CONTROL_SLOT_APPENDER)
+        {
+            LoggerList loggers = hierarchy.getCurrentLoggers ();
+            loggers.push_back (hierarchy.getRoot ());
+            for (Logger & logger : loggers)
+            {
+                SharedAppenderPtr appender = logger.getAppender (name);
+                if (appender)
+                    appender->setThreshold (ll);
+            }
+            ++changes;
+        }
+    }
+
+    // Slots that were being written are retried on the next call.
+    if (complete)
+        mapping->applied_generation = generation;
+
+    return changes;
+}
+
+
+tstring
+ControlSegment::getDefaultPath (unsigned long pid)
+{
+#if defined (__linux__)
+    tstring path (LOG4CPLUS_TEXT ("/dev/shm/log4cplus-"));
+#else
+    tstring path (LOG4CPLUS_TEXT ("/tmp/log4cplus-"));
+#endif
+    path += helpers::convertIntegerToString (pid);
+    return path;
+}
+
+
+//////////////////////////////////////////////////////////////////////////////
+// ControlSegmentClient
+//////////////////////////////////////////////////////////////////////////////
+
+ControlSegmentClient::ControlSegmentClient (tstring const & path)
+    : mapping (new ControlMapping)
+{
+    if (! mapping->attach (LOG4CPLUS_TSTRING_TO_STRING (path)))
+        mapping.reset ();
+}
+
+
+ControlSegmentClient::~ControlSegmentClient () = default;
+
+
+bool
+ControlSegmentClient::isOpen () const
+{
+    return !! mapping;
+}
+
+
+bool
+ControlSegmentClient::setLoggerLevel (tstring const & name, LogLevel ll)
+{
+    return mapping && mapping->write (CONTROL_SLOT_LOGGER,
+        LOG4CPLUS_TSTRING_TO_STRING (name), ll);
+}
+
+
+bool
+ControlSegmentClient::setAppenderThreshold (tstring const & name,
+    LogLevel ll)
+{
+    return mapping && mapping->write (CONTROL_SLOT_APPENDER,
+        LOG4CPLUS_TSTRING_TO_STRING (name), ll);
+}
+
+
+std::vector<ControlSegmentClient::Entry>
+ControlSegmentClient::list () const
+{
+    std::vector<Entry> entries;
+    if (! mapping)
+        return entries;
+
+    ControlSlotValue value;
+    std::uint32_t seq = 0;
+    for (std::size_t i = 0; i != mapping->slotCount (); ++i)
+    {
+        if (! mapping->read (i, value, seq)
+            || value.kind == CONTROL_SLOT_EMPTY)
+            continue;
+
+        entries.push_back (Entry {value.kind == CONTROL_SLOT_APPENDER,
+            LOG4CPLUS_STRING_TO_TSTRING (value.name), value.level});
+    }
+
+    return entries;
+}
+
+
+
+#if defined (LOG4CPLUS_WITH_UNIT_TESTS) \
+    && defined (LOG4CPLUS_CONTROL_SEGMENT_MMAP)
+CATCH_TEST_CASE ("ControlSegment", "[controlsegment]")
+{
+    Hierarchy h;
+    Logger root = h.getRoot ();
+    Logger child = h.getInstance (LOG4CPLUS_TEXT ("a.b"));
+    child.setLogLevel (WARN_LOG_LEVEL);
+    SharedAppenderPtr app (new NullAppender);
+    app->setName (LOG4CPLUS_TEXT ("null"));
+    root.addAppender (app);
+
+    tstring const path = ControlSegment::getDefaultPath (
+        static_cast<unsigned long>(::getpid ()))
+        + LOG4CPLUS_TEXT ("-test");
+    ControlSegment segment (h, path, 0);
+    CATCH_REQUIRE (segment.isOpen ());
+    ControlSegmentClient client (path);
+    CATCH_REQUIRE (client.isOpen ());
+
+    CATCH_SECTION ("current levels are published")
+    {
+        auto const entries = client.list ();
+        CATCH_REQUIRE (entries.size () == 3);
+        CATCH_REQUIRE (std::count_if (entries.begin (), entries.end (),
+            [] (ControlSegmentClient::Entry const & e) {
+                return ! e.appender && e.name == LOG4CPLUS_TEXT ("a.b")
+                    && e.level == WARN_LOG_LEVEL; }) == 1);
+        CATCH_REQUIRE (segment.poll () == 0);
+    }
+
+    CATCH_SECTION ("changes are applied by poll")
+    {
+        CATCH_REQUIRE (client.setLoggerLevel (LOG4CPLUS_TEXT ("a.b"),
+            TRACE_LOG_LEVEL));
+        CATCH_REQUIRE (client.setLoggerLevel (LOG4CPLUS_TEXT ("x"),
+            FATAL_LOG_LEVEL));
+        CATCH_REQUIRE (client.setAppenderThreshold (LOG4CPLUS_TEXT ("null"),
+            INFO_LOG_LEVEL));
+        CATCH_REQUIRE (child.getLogLevel () == WARN_LOG_LEVEL);
+        CATCH_REQUIRE (segment.poll () == 3);
+        CATCH_REQUIRE (segment.poll () == 0);
+        CATCH_REQUIRE (child.getLogLevel () == TRACE_LOG_LEVEL);
+        CATCH_REQUIRE (h.getInstance (LOG4CPLUS_TEXT ("x")).getLogLevel ()
+            == FATAL_LOG_LEVEL);
+        CATCH_REQUIRE (app->getThreshold () == INFO_LOG_LEVEL);
+        CATCH_REQUIRE (! child.isEnabledFor (DEBUG_LOG_LEVEL));
+        CATCH_REQUIRE (child.isEnabledFor (INFO_LOG_LEVEL));
+    }
+
+    CATCH_SECTION ("invalid names are rejected")
+    {
+        CATCH_REQUIRE (! client.setLoggerLevel (tstring (), INFO_LOG_LEVEL));
+        CATCH_REQUIRE (! client.setLoggerLevel (
+            tstring (200, LOG4CPLUS_TEXT ('a')), INFO_LOG_LEVEL));
+    }
+
+    h.shutdown ();
+}
+
+#endif
+
+
+} // namespace log4cplus
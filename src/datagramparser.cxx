@@ -0,0 +1,843 @@
+// -*- C++ -*-
+//
+//  Copyright (C) 2026, Vaclav Zeman. All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without modifica-
+//  tion, are permitted provided that the following conditions are met:
+//
+//  1. Redistributions of  source code must  retain the above copyright  notice,
+//     this list of conditions and the following disclaimer.
+//
+//  2. Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//
+//  THIS SOFTWARE IS PROVIDED ``AS IS'' AND ANY EXPRESSED OR IMPLIED WARRANTIES,
+//  INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+//  FITNESS  FOR A PARTICULAR  PURPOSE ARE  DISCLAIMED.  IN NO  EVENT SHALL  THE
+//  APACHE SOFTWARE  FOUNDATION  OR ITS CONTRIBUTORS  BE LIABLE FOR  ANY DIRECT,
+//  INDIRECT, INCIDENTAL, SPECIAL,  EXEMPLARY, OR CONSEQUENTIAL  DAMAGES (INCLU-
+//  DING, BUT NOT LIMITED TO, PROCUREMENT  OF SUBSTITUTE GOODS OR SERVICES; LOSS
+//  OF USE, DATA, OR  PROFITS; OR BUSINESS  INTERRUPTION)  HOWEVER CAUSED AND ON
+//  ANY  THEORY OF LIABILITY,  WHETHER  IN CONTRACT,  STRICT LIABILITY,  OR TORT
+//  (INCLUDING  NEGLIGENCE OR  OTHERWISE) ARISING IN  ANY WAY OUT OF THE  USE OF
+//  THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <log4cplus/helpers/datagramparser.h>
+#include <log4cplus/socketappender.h>
+#include <log4cplus/helpers/socketbuffer.h>
+#include <log4cplus/helpers/timehelper.h>
+#include <log4cplus/internal/internal.h>
+#include <charconv>
+#include <cstring>
+#include <ctime>
+#include <string>
+
+#if defined (LOG4CPLUS_WITH_UNIT_TESTS)
+#include <catch.hpp>
+#endif
+
+
+namespace log4cplus::helpers {
+
+
+namespace
+{
+
+
+using string_view = std::string_view;
+
+
+//! Event fields are passed to InternalLoggingEvent as views of the
+//! datagram, converted only when tchar is not char.
+#if defined (UNICODE)
+using field_type = tstring;
+#else
+using field_type = tstring_view;
+#endif
+
+
+field_type
+to_field (string_view str)
+{
+    return LOG4CPLUS_STRING_TO_TSTRING (str);
+}
+
+
+//! Moving position in parsed text.
+struct cursor
+{
+    string_view rest;
+
+    bool
+    empty () const
+    {
+        return rest.empty ();
+    }
+
+    bool
+    skip (char ch)
+    {
+        if (rest.empty () || rest.front () != ch)
+            return false;
+
+        rest.remove_prefix (1);
+        return true;
+    }
+
+    //! Returns text up to next space and moves past the space.
+    string_view
+    token ()
+    {
+        std::size_t const pos = rest.find (' ');
+        string_view const tok = rest.substr (0, pos);
+        rest.remove_prefix (pos == string_view::npos ? rest.size () : pos + 1);
+        return tok;
+    }
+
+    //! Reads number of exactly <code>digits</code> decimal digits.
+    bool
+    number (int & value, std::size_t digits)
+    {
+        if (rest.size () < digits)
+            return false;
+
+        int result = 0;
+        for (std::size_t i = 0; i != digits; ++i)
+        {
+            char const ch = rest[i];
+            if (ch < '0' || ch > '9')
+                return false;
+
+            result = result * 10 + (ch - '0');
+        }
+
+        rest.remove_prefix (digits);
+        value = result;
+        return true;
+    }
+};
+
+
+//! \return Empty view for NILVALUE of RFC 5424.
+string_view
+nil_to_empty (string_view str)
+{
+    return str == "-" ? string_view () : str;
+}
+
+
+//! Parses TIMESTAMP of RFC 5424, e.g., 2003-10-11T22:14:15.003Z.
+bool
+parse_rfc5424_time (Time & time, string_view str)
+{
+    cursor c {str};
+    int year, month, day, hour, minute, second;
+    if (! (c.number (year, 4) && c.skip ('-')
+            && c.number (month, 2) && c.skip ('-')
+            && c.number (day, 2) && c.skip ('T')
+            && c.number (hour, 2) && c.skip (':')
+            && c.number (minute, 2) && c.skip (':')
+            && c.number (second, 2)))
+        return false;
+
+    long usec = 0;
+    if (c.skip ('.'))
+    {
+        long scale = 100000;
+        std::size_t digits = 0;
+        for (; ! c.empty () && c.rest.front () >= '0'
+                 && c.rest.front () <= '9'; ++digits)
+        {
+            usec += (c.rest.front () - '0') * scale;
+            scale /= 10;
+            c.rest.remove_prefix (1);
+        }
+
+        if (digits == 0 || digits > 6)
+            return false;
+    }
+
+    long offset = 0;
+    if (! c.skip ('Z'))
+    {
+        bool const negative = c.skip ('-');
+        int offset_hours, offset_minutes;
+        if (! ((negative || c.skip ('+'))
+                && c.number (offset_hours, 2) && c.skip (':')
+                && c.number (offset_minutes, 2)))
+            return false;
+
+        offset = (offset_hours * 60L + offset_minutes) * 60;
+        if (negative)
+            offset = -offset;
+    }
+
+    if (! c.empty () || month < 1 || month > 12 || day < 1 || day > 31)
+        return false;
+
+    long long const secs
+        = internal::days_from_civil (year, static_cast<unsigned>(month),
+            static_cast<unsigned>(day)) * 86400
+        + hour * 3600 + minute * 60 + second - offset;
+    time = time_from_parts (static_cast<time_t>(secs), usec);
+    return true;
+}
+
+
+//! Parses TIMESTAMP of RFC 3164, e.g., Oct 11 22:14:15, as local time.
+bool
+parse_rfc3164_time (Time & time, string_view str)
+{
+    static char const months[] = "JanFebMarAprMayJunJulAugSepOctNovDec";
+
+    if (str.size () != 15 || str[3] != ' ')
+        return false;
+
+    int month = 0;
+    while (month != 12 && str.compare (0, 3, months + month * 3, 3) != 0)
+        ++month;
+
+    // Day of month is padded with space.
+    cursor day_field {str.substr (4, 2)};
+    day_field.skip (' ');
+    int day;
+    cursor c {str.substr (6)};
+    int hour, minute, second;
+    if (month == 12
+        || ! day_field.number (day, day_field.rest.size ())
+        || ! (c.skip (' ') && c.number (hour, 2) && c.skip (':')
+            && c.number (minute, 2) && c.skip (':')
+            && c.number (second, 2)))
+        return false;
+
+    // Year is not transmitted. Use the current one unless it would put
+    // the message too far into future, e.g., when a message sent on
+    // December 31 is received on January 1.
+    Time const current = now ();
+    tm current_tm;
+    localTime (&current_tm, current);
+    for (int year = current_tm.tm_year; ; --year)
+    {
+        tm message_tm = tm ();
+        message_tm.tm_year = year;
+        message_tm.tm_mon = month;
+        message_tm.tm_mday = day;
+        message_tm.tm_hour = hour;
+        message_tm.tm_min = minute;
+        message_tm.tm_sec = second;
+        message_tm.tm_isdst = -1;
+        time = from_struct_tm (&message_tm);
+        if (time < current + chrono::hours (24)
+            || year != current_tm.tm_year)
+            return true;
+    }
+}
+
+
+//! Skips STRUCTURED-DATA of RFC 5424.
+bool
+skip_structured_data (cursor & c)
+{
+    if (c.skip ('-'))
+        return true;
+
+    if (c.empty () || c.rest.front () != '[')
+        return false;
+
+    while (! c.empty () && c.rest.front () == '[')
+    {
+        bool quoted = false;
+        std::size_t i = 1;
+        for (; i < c.rest.size (); ++i)
+        {
+            char const ch = c.rest[i];
+            if (quoted)
+            {
+                if (ch == '\\')
+                    ++i;
+                else if (ch == '"')
+                    quoted = false;
+            }
+            else if (ch == '"')
+                quoted = true;
+            else if (ch == ']')
+                break;
+        }
+
+        if (i >= c.rest.size ())
+            return false;
+
+        c.rest.remove_prefix (i + 1);
+    }
+
+    return true;
+}
+
+
+//! Appends code point <code>cp</code> encoded as UTF-8.
+void
+append_utf8 (std::string & out, unsigned long cp)
+{
+    if (cp < 0x80)
+        out.push_back (static_cast<char>(cp));
+    else if (cp < 0x800)
+    {
+        out.push_back (static_cast<char>(0xC0 | (cp >> 6)));
+        out.push_back (static_cast<char>(0x80 | (cp & 0x3F)));
+    }
+    else if (cp < 0x10000)
+    {
+        out.push_back (static_cast<char>(0xE0 | (cp >> 12)));
+        out.push_back (static_cast<char>(0x80 | ((cp >> 6) & 0x3F)));
+        out.push_back (static_cast<char>(0x80 | (cp & 0x3F)));
+    }
+    else
+    {
+        out.push_back (static_cast<char>(0xF0 | ((cp >> 18) & 0x07)));
+        out.push_back (static_cast<char>(0x80 | ((cp >> 12) & 0x3F)));
+        out.push_back (static_cast<char>(0x80 | ((cp >> 6) & 0x3F)));
+        out.push_back (static_cast<char>(0x80 | (cp & 0x3F)));
+    }
+}
+
+
+//! Replaces XML entities and character references in <code>text</code>.
+//! \return <code>text</code> itself when there is nothing to replace,
+//! else view of <code>buf</code>.
+string_view
+xml_unescape (string_view text, std::string & buf)
+{
+    string_view const cdata_start ("<![CDATA[");
+    string_view const cdata_end ("]]>");
+    if (text.substr (0, cdata_start.size ()) == cdata_start
+        && text.size () >= cdata_start.size () + cdata_end.size ()
+        && text.substr (text.size () - cdata_end.size ()) == cdata_end)
+        return text.substr (cdata_start.size (),
+            text.size () - cdata_start.size () - cdata_end.size ());
+
+    std::size_t amp = text.find ('&');
+    if (amp == string_view::npos)
+        return text;
+
+    buf.clear ();
+    while (amp != string_view::npos)
+    {
+        buf.append (text.substr (0, amp));
+        text.remove_prefix (amp);
+
+        std::size_t const semicolon = text.find (';');
+        string_view const entity = text.substr (1,
+            semicolon == string_view::npos ? 0 : semicolon - 1);
+        unsigned long cp = 0;
+        bool known = true;
+        if (entity == "lt")
+            cp = '<';
+        else if (entity == "gt")
+            cp = '>';
+        else if (entity == "amp")
+            cp = '&';
+        else if (entity == "apos")
+            cp = '\'';
+        else if (entity == "quot")
+            cp = '"';
+        else if (entity.size () > 1 && entity[0] == '#')
+        {
+            bool const hex = entity[1] == 'x' || entity[1] == 'X';
+            string_view const digits = entity.substr (hex ? 2 : 1);
+            auto const result = std::from_chars (digits.data (),
+                digits.data () + digits.size (), cp, hex ? 16 : 10);
+            known = result.ec == std::errc ()
+                && result.ptr == digits.data () + digits.size ()
+                && cp <= 0x10FFFF;
+        }
+        else
+            known = false;
+
+        if (known)
+        {
+            append_utf8 (buf, cp);
+            text.remove_prefix (semicolon + 1);
+        }
+        else
+        {
+            buf.push_back ('&');
+            text.remove_prefix (1);
+        }
+
+        amp = text.find ('&');
+    }
+
+    buf.append (text);
+    return buf;
+}
+
+
+//! \return Raw value of attribute <code>name</code> of XML start tag
+//! <code>tag</code>.
+string_view
+xml_attribute (string_view tag, string_view name)
+{
+    std::size_t pos = 0;
+    while ((pos = tag.find (name, pos)) != string_view::npos)
+    {
+        std::size_t const value = pos + name.size ();
+        if (pos > 0 && tag[pos - 1] == ' '
+            && tag.substr (value, 2) == "=\"")
+        {
+            std::size_t const end = tag.find ('"', value + 2);
+            if (end == string_view::npos)
+                break;
+
+            return tag.substr (value + 2, end - value - 2);
+        }
+
+        pos = value;
+    }
+
+    return string_view ();
+}
+
+
+//! \return Start tag of the first element <code>name</code> in
+//! <code>xml</code>, without the closing bracket.
+string_view
+xml_start_tag (string_view xml, string_view name)
+{
+    std::size_t pos = 0;
+    while ((pos = xml.find (name, pos)) != string_view::npos)
+    {
+        std::size_t const after = pos + name.size ();
+        if (pos > 0 && xml[pos - 1] == '<' && after < xml.size ()
+            && (xml[after] == ' ' || xml[after] == '>' || xml[after] == '/'))
+        {
+            std::size_t const end = xml.find ('>', after);
+            if (end == string_view::npos)
+                break;
+
+            return xml.substr (pos - 1, end - pos + 1);
+        }
+
+        pos = after;
+    }
+
+    return string_view ();
+}
+
+
+//! \return Raw content of the first element <code>name</code>.
+string_view
+xml_element_text (string_view xml, string_view name)
+{
+    string_view const tag = xml_start_tag (xml, name);
+    if (tag.empty () || tag.back () == '/')
+        return string_view ();
+
+    std::size_t const start = static_cast<std::size_t>(
+        tag.data () - xml.data ()) + tag.size () + 1;
+    std::string end_tag ("</");
+    end_tag.append (name);
+    end_tag.push_back ('>');
+    std::size_t const end = xml.find (end_tag, start);
+    if (end == string_view::npos)
+        return string_view ();
+
+    return xml.substr (start, end - start);
+}
+
+
+} // namespace
+
+
+DatagramFormat
+detectDatagramFormat (string_view data)
+{
+    if (data.empty ())
+        return DATAGRAM_UNKNOWN;
+
+    if (data[0] == '<')
+    {
+        if (data.size () > 1 && data[1] >= '0' && data[1] <= '9')
+            return DATAGRAM_SYSLOG;
+        else if (data.substr (0, 12) == "<log4j:event")
+            return DATAGRAM_LOG4J_XML;
+        else
+            return DATAGRAM_UNKNOWN;
+    }
+
+    unsigned char const version = LOG4CPLUS_MESSAGE_VERSION;
+    if (static_cast<unsigned char>(data[0]) == version
+        || (data.size () > 4 && data[0] == 0
+            && static_cast<unsigned char>(data[4]) == version))
+        return DATAGRAM_SOCKET;
+
+    return DATAGRAM_UNKNOWN;
+}
+
+
+LogLevel
+syslogSeverityToLogLevel (int severity)
+{
+    switch (severity)
+    {
+    case 0: // Emergency
+    case 1: // Alert
+    case 2: // Critical
+        return FATAL_LOG_LEVEL;
+
+    case 3: // Error
+        return ERROR_LOG_LEVEL;
+
+    case 4: // Warning
+        return WARN_LOG_LEVEL;
+
+    case 5: // Notice
+    case 6: // Informational
+        return INFO_LOG_LEVEL;
+
+    default: // Debug
+        return DEBUG_LOG_LEVEL;
+    }
+}
+
+
+bool
+parseSyslogMessage (spi::InternalLoggingEvent & event, string_view data)
+{
+    cursor c {data};
+    if (! c.skip ('<'))
+        return false;
+
+    int pri = 0;
+    std::size_t digits = 0;
+    for (; digits != 3 && ! c.empty () && c.rest.front () >= '0'
+             && c.rest.front () <= '9'; ++digits)
+    {
+        pri = pri * 10 + (c.rest.front () - '0');
+        c.rest.remove_prefix (1);
+    }
+
+    if (digits == 0 || pri > 191 || ! c.skip ('>'))
+        return false;
+
+    string_view host;
+    string_view app;
+    string_view procid;
+    Time time;
+    bool have_time = false;
+
+    if (c.rest.substr (0, 2) == "1 ")
+    {
+        // RFC 5424: VERSION SP TIMESTAMP SP HOSTNAME SP APP-NAME SP PROCID
+        // SP MSGID SP STRUCTURED-DATA [SP MSG]
+        c.rest.remove_prefix (2);
+        string_view const timestamp = nil_to_empty (c.token ());
+        have_time = ! timestamp.empty ()
+            && parse_rfc5424_time (time, timestamp);
+        host = nil_to_empty (c.token ());
+        app = nil_to_empty (c.token ());
+        procid = nil_to_empty (c.token ());
+        c.token ();
+        if (! skip_structured_data (c))
+            return false;
+
+        c.skip (' ');
+        if (c.rest.substr (0, 3) == "\xEF\xBB\xBF")
+            c.rest.remove_prefix (3);
+    }
+    else
+    {
+        // RFC 3164: TIMESTAMP SP HOSTNAME SP TAG[PID]: MSG
+        if (c.rest.size () > 15 && c.rest[15] == ' '
+            && parse_rfc3164_time (time, c.rest.substr (0, 15)))
+        {
+            have_time = true;
+            c.rest.remove_prefix (16);
+            host = c.token ();
+        }
+
+        std::size_t const tag_end = c.rest.find_first_of (":[ ");
+        if (tag_end != string_view::npos && tag_end != 0 && tag_end <= 32
+            && c.rest[tag_end] != ' ')
+        {
+            app = c.rest.substr (0, tag_end);
+            c.rest.remove_prefix (tag_end);
+            if (c.skip ('['))
+            {
+                std::size_t const pid_end = c.rest.find (']');
+                procid = c.rest.substr (0, pid_end);
+                c.rest.remove_prefix (pid_end == string_view::npos
+                    ? c.rest.size () : pid_end + 1);
+            }
+
+            c.skip (':');
+            c.skip (' ');
+        }
+    }
+
+    string_view message = c.rest;
+    while (! message.empty () && (message.back () == '\n'
+            || message.back () == '\r' || message.back () == '\0'))
+        message.remove_suffix (1);
+
+    if (! have_time)
+        time = now ();
+
+    field_type const logger = to_field (app.empty () ? "syslog" : app);
+    spi::InternalLoggingEvent ev (logger, syslogSeverityToLogLevel (pri & 7),
+        to_field (host), MappedDiagnosticContextMap (), to_field (message),
+        to_field (procid), tstring_view (), time, tstring_view (), 0);
+    event.swap (ev);
+    return true;
+}
+
+
+bool
+parseLog4jXmlEvent (spi::InternalLoggingEvent & event, string_view data)
+{
+    string_view const event_tag = xml_start_tag (data, "log4j:event");
+    if (event_tag.empty ())
+        return false;
+
+    std::string buf[7];
+    string_view const logger = xml_unescape (
+        xml_attribute (event_tag, "logger"), buf[0]);
+    string_view const level = xml_unescape (
+        xml_attribute (event_tag, "level"), buf[1]);
+    string_view const thread = xml_unescape (
+        xml_attribute (event_tag, "thread"), buf[2]);
+    string_view const message = xml_unescape (
+        xml_element_text (data, "log4j:message"), buf[3]);
+    string_view const ndc = xml_unescape (
+        xml_element_text (data, "log4j:NDC"), buf[4]);
+
+    string_view const location = xml_start_tag (data, "log4j:locationInfo");
+    string_view const file = xml_unescape (
+        xml_attribute (location, "file"), buf[5]);
+    string_view const method = xml_unescape (
+        xml_attribute (location, "method"), buf[6]);
+    string_view const line_str = xml_attribute (location, "line");
+    int line = 0;
+    std::from_chars (line_str.data (), line_str.data () + line_str.size (),
+        line);
+
+    // Timestamp is in milliseconds since epoch.
+    string_view const timestamp = xml_attribute (event_tag, "timestamp");
+    long long millis = 0;
+    auto const result = std::from_chars (timestamp.data (),
+        timestamp.data () + timestamp.size (), millis);
+    Time const time = result.ec == std::errc () && ! timestamp.empty ()
+        ? time_from_parts (static_cast<time_t>(millis / 1000),
+            static_cast<long>(millis % 1000) * 1000)
+        : now ();
+
+    MappedDiagnosticContextMap mdc;
+    string_view properties = xml_element_text (data, "log4j:properties");
+    for (string_view tag = xml_start_tag (properties, "log4j:data");
+         ! tag.empty ();
+         tag = xml_start_tag (properties, "log4j:data"))
+    {
+        std::string name_buf;
+        std::string value_buf;
+        string_view const name = xml_unescape (
+            xml_attribute (tag, "name"), name_buf);
+        string_view const value = xml_unescape (
+            xml_attribute (tag, "value"), value_buf);
+        mdc[tstring (to_field (name))] = tstring (to_field (value));
+        properties.remove_prefix (static_cast<std::size_t>(
+            tag.data () - properties.data ()) + tag.size ());
+    }
+
+    field_type const level_field = to_field (level);
+    spi::InternalLoggingEvent ev (to_field (logger),
+        getLogLevelManager ().fromString (level_field), to_field (ndc), mdc,
+        to_field (message), to_field (thread), tstring_view (), time,
+        to_field (file), line, to_field (method));
+    event.swap (ev);
+    return true;
+}
+
+
+bool
+parseSocketMessage (spi::InternalLoggingEvent & event, string_view data)
+{
+    unsigned char const version = LOG4CPLUS_MESSAGE_VERSION;
+
+    // Skip size of the message preceding it in the stream of
+    // SocketAppender.
+    if (data.size () > 4 && static_cast<unsigned char>(data[0]) != version)
+    {
+        SocketBuffer size_buffer (sizeof (unsigned int));
+        std::memcpy (size_buffer.getBuffer (), data.data (),
+            sizeof (unsigned int));
+        size_buffer.setSize (sizeof (unsigned int));
+        if (size_buffer.readInt () == data.size () - sizeof (unsigned int))
+            data.remove_prefix (sizeof (unsigned int));
+    }
+
+    if (data.size () < 2 || static_cast<unsigned char>(data[0]) != version
+        || (data[1] != 1 && data[1] != 2))
+        return false;
+
+    SocketBuffer buffer (data.size ());
+    std::memcpy (buffer.getBuffer (), data.data (), data.size ());
+    buffer.setSize (data.size ());
+    spi::InternalLoggingEvent ev = readFromBuffer (buffer);
+    event.swap (ev);
+    return true;
+}
+
+
+DatagramFormat
+parseDatagram (spi::InternalLoggingEvent & event, string_view data)
+{
+    DatagramFormat const format = detectDatagramFormat (data);
+    bool parsed = false;
+    switch (format)
+    {
+    case DATAGRAM_SOCKET:
+        parsed = parseSocketMessage (event, data);
+        break;
+
+    case DATAGRAM_LOG4J_XML:
+        parsed = parseLog4jXmlEvent (event, data);
+        break;
+
+    case DATAGRAM_SYSLOG:
+        parsed = parseSyslogMessage (event, data);
+        break;
+
+    case DATAGRAM_UNKNOWN:
+        break;
+    }
+
+    return parsed ? format : DATAGRAM_UNKNOWN;
+}
+
+
+#if defined (LOG4CPLUS_WITH_UNIT_TESTS)
+CATCH_TEST_CASE ("Datagram parsers", "[datagramparser]")
+{
+    spi::InternalLoggingEvent ev;
+
+    CATCH_SECTION ("RFC 5424 syslog message")
+    {
+        string_view const msg ("<165>1 2003-10-11T22:14:15.003Z"
+            " mymachine.example.com evntslog 1234 ID47"
+            " [exampleSDID@32473 iut=\"3\" eventSource=\"App\\]\"]"
+            " \xEF\xBB\xBF" "An application event log entry...");
+        CATCH_REQUIRE (parseDatagram (ev, msg) == DATAGRAM_SYSLOG);
+        CATCH_REQUIRE (ev.getLogLevel () == INFO_LOG_LEVEL);
+        CATCH_REQUIRE (ev.getLoggerName () == LOG4CPLUS_TEXT ("evntslog"));
+        CATCH_REQUIRE (ev.getNDC ()
+            == LOG4CPLUS_TEXT ("mymachine.example.com"));
+        CATCH_REQUIRE (ev.getThread () == LOG4CPLUS_TEXT ("1234"));
+        CATCH_REQUIRE (ev.getMessage ()
+            == LOG4CPLUS_TEXT ("An application event log entry..."));
+        CATCH_REQUIRE (to_time_t (ev.getTimestamp ()) == 1065910455);
+        CATCH_REQUIRE (microseconds_part (ev.getTimestamp ()) == 3000);
+    }
+
+    CATCH_SECTION ("RFC 5424 syslog message with nil values")
+    {
+        CATCH_REQUIRE (parseSyslogMessage (ev,
+            "<11>1 2003-08-24T05:14:15.000003-07:00 - - - - -"));
+        CATCH_REQUIRE (ev.getLogLevel () == ERROR_LOG_LEVEL);
+        CATCH_REQUIRE (ev.getLoggerName () == LOG4CPLUS_TEXT ("syslog"));
+        CATCH_REQUIRE (ev.getMessage ().empty ());
+        CATCH_REQUIRE (to_time_t (ev.getTimestamp ()) == 1061727255);
+        CATCH_REQUIRE (microseconds_part (ev.getTimestamp ()) == 3);
+    }
+
+    CATCH_SECTION ("RFC 3164 syslog message")
+    {
+        CATCH_REQUIRE (parseDatagram (ev,
+            "<34>Oct 11 22:14:15 mymachine su[42]: 'su root' failed\n")
+            == DATAGRAM_SYSLOG);
+        CATCH_REQUIRE (ev.getLogLevel () == FATAL_LOG_LEVEL);
+        CATCH_REQUIRE (ev.getLoggerName () == LOG4CPLUS_TEXT ("su"));
+        CATCH_REQUIRE (ev.getNDC () == LOG4CPLUS_TEXT ("mymachine"));
+        CATCH_REQUIRE (ev.getThread () == LOG4CPLUS_TEXT ("42"));
+        CATCH_REQUIRE (ev.getMessage ()
+            == LOG4CPLUS_TEXT ("'su root' failed"));
+
+        tm t;
+        localTime (&t, ev.getTimestamp ());
+        CATCH_REQUIRE (t.tm_mon == 9);
+        CATCH_REQUIRE (t.tm_mday == 11);
+        CATCH_REQUIRE (t.tm_hour == 22);
+    }
+
+    CATCH_SECTION ("RFC 3164 syslog message without header")
+    {
+        CATCH_REQUIRE (parseSyslogMessage (ev, "<15>just text"));
+        CATCH_REQUIRE (ev.getLogLevel () == DEBUG_LOG_LEVEL);
+        CATCH_REQUIRE (ev.getLoggerName () == LOG4CPLUS_TEXT ("syslog"));
+        CATCH_REQUIRE (ev.getMessage () == LOG4CPLUS_TEXT ("just text"));
+    }
+
+    CATCH_SECTION ("log4j XML event")
+    {
+        CATCH_REQUIRE (parseDatagram (ev,
+            "<log4j:event logger=\"a.b\" level=\"WARN\""
+            " timestamp=\"1065910455003\" thread=\"main\">"
+            "<log4j:message>x &lt; y &amp;&#x0a;z</log4j:message>"
+            "<log4j:NDC><![CDATA[<ndc>]]></log4j:NDC>"
+            "<log4j:locationInfo class=\"\" file=\"f.cxx\" method=\"fn\""
+            " line=\"12\"/>"
+            "<log4j:properties><log4j:data name=\"k\" value=\"v&quot;\"/>"
+            "</log4j:properties></log4j:event>") == DATAGRAM_LOG4J_XML);
+        CATCH_REQUIRE (ev.getLoggerName () == LOG4CPLUS_TEXT ("a.b"));
+        CATCH_REQUIRE (ev.getLogLevel () == WARN_LOG_LEVEL);
+        CATCH_REQUIRE (ev.getThread () == LOG4CPLUS_TEXT ("main"));
+        CATCH_REQUIRE (ev.getMessage () == LOG4CPLUS_TEXT ("x < y &\nz"));
+        CATCH_REQUIRE (ev.getNDC () == LOG4CPLUS_TEXT ("<ndc>"));
+        CATCH_REQUIRE (ev.getFile () == LOG4CPLUS_TEXT ("f.cxx"));
+        CATCH_REQUIRE (ev.getFunction () == LOG4CPLUS_TEXT ("fn"));
+        CATCH_REQUIRE (ev.getLine () == 12);
+        CATCH_REQUIRE (ev.getMDC (LOG4CPLUS_TEXT ("k"))
+            == LOG4CPLUS_TEXT ("v\""));
+        CATCH_REQUIRE (to_time_t (ev.getTimestamp ()) == 1065910455);
+        CATCH_REQUIRE (microseconds_part (ev.getTimestamp ()) == 3000);
+    }
+
+    CATCH_SECTION ("socket message")
+    {
+        spi::InternalLoggingEvent sent (LOG4CPLUS_TEXT ("net"),
+            ERROR_LOG_LEVEL, LOG4CPLUS_TEXT ("ndc"),
+            MappedDiagnosticContextMap (), LOG4CPLUS_TEXT ("payload"),
+            LOG4CPLUS_TEXT ("t1"), LOG4CPLUS_TEXT ("t2"), now (),
+            LOG4CPLUS_TEXT ("file"), 7);
+        char const bytes[] = { 'a', 0, '\xff' };
+        sent.setPayload (bytes, sizeof (bytes));
+        SocketBuffer buffer (LOG4CPLUS_MAX_MESSAGE_SIZE);
+        convertToBuffer (buffer, sent, tstring ());
+        string_view const msg (buffer.getBuffer (), buffer.getSize ());
+        CATCH_REQUIRE (parseDatagram (ev, msg) == DATAGRAM_SOCKET);
+        CATCH_REQUIRE (ev.getLoggerName () == LOG4CPLUS_TEXT ("net"));
+        CATCH_REQUIRE (ev.getMessage () == LOG4CPLUS_TEXT ("payload"));
+        CATCH_REQUIRE (ev.getLine () == 7);
+        CATCH_REQUIRE (ev.getPayload ()
+            == std::string_view (bytes, sizeof (bytes)));
+
+        SocketBuffer framed (LOG4CPLUS_MAX_MESSAGE_SIZE);
+        framed.appendInt (static_cast<unsigned>(buffer.getSize ()));
+        framed.appendBuffer (buffer);
+        CATCH_REQUIRE (parseDatagram (ev,
+                string_view (framed.getBuffer (), framed.getSize ()))
+            == DATAGRAM_SOCKET);
+        CATCH_REQUIRE (ev.getMessage () == LOG4CPLUS_TEXT ("payload"));
+    }
+
+    CATCH_SECTION ("garbage")
+    {
+        CATCH_REQUIRE (parseDatagram (ev, "") == DATAGRAM_UNKNOWN);
+        CATCH_REQUIRE (parseDatagram (ev, "hello") == DATAGRAM_UNKNOWN);
+        CATCH_REQUIRE (parseDatagram (ev, "<999>x") == DATAGRAM_UNKNOWN);
+        CATCH_REQUIRE (parseDatagram (ev, "<foo/>") == DATAGRAM_UNKNOWN);
+    }
+}
+#endif
+
+
+} // namespace log4cplus::helpers
@@ -29,6 +29,7 @@
 #include <log4cplus/nteventlogappender.h>
 #include <log4cplus/nullappender.h>
 #include <log4cplus/socketappender.h>
+#include <log4cplus/sockethubappender.h>
 #include <log4cplus/syslogappender.h>
 #include <log4cplus/win32debugappender.h>
 #include <log4cplus/win32consoleappender.h>
@@ -180,6 +181,7 @@ void initializeFactoryRegistry()
     LOG4CPLUS_REG_APPENDER (reg, SysLogAppender);
 #ifndef LOG4CPLUS_SINGLE_THREADED
     LOG4CPLUS_REG_APPENDER (reg, AsyncAppender);
+    LOG4CPLUS_REG_APPENDER (reg, SocketHubAppender);
 #endif
     LOG4CPLUS_REG_APPENDER (reg, Log4jUdpAppender);
 
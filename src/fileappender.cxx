@@ -22,6 +22,7 @@
 #include <log4cplus/layout.h>
 #include <log4cplus/streams.h>
 #include <log4cplus/helpers/loglog.h>
+#include <log4cplus/helpers/memorybudget.h>
 #include <log4cplus/helpers/stringhelper.h>
 #include <log4cplus/helpers/timehelper.h>
 #include <log4cplus/helpers/property.h>
@@ -278,10 +279,20 @@ FileAppenderBase::init()
         lockFileName += LOG4CPLUS_TEXT(".lock");
     }
 
-    if (bufferSize != 0)
+    if (bufferSize != 0 && ! buffer)
     {
-        buffer.reset (new tchar[bufferSize]);
-        out.rdbuf ()->pubsetbuf (buffer.get (), bufferSize);
+        if (helpers::getMemoryBudget ().tryAcquire (
+                helpers::MemoryBudget::FILE_BUFFER,
+                bufferSize * sizeof (tchar)))
+        {
+            buffer.reset (new tchar[bufferSize]);
+            out.rdbuf ()->pubsetbuf (buffer.get (), bufferSize);
+        }
+        else
+            helpers::getLogLog ().warn (
+                LOG4CPLUS_TEXT ("BufferSize of ") + filename
+                + LOG4CPLUS_TEXT (" exceeds memory budget,")
+                LOG4CPLUS_TEXT (" using default buffer"));
     }
 
     helpers::LockFileGuard guard;
@@ -317,11 +328,23 @@ FileAppenderBase::close()
     thread::MutexGuard guard (access_mutex);
 
     out.close();
-    buffer.reset ();
+    if (buffer)
+    {
+        buffer.reset ();
+        helpers::getMemoryBudget ().release (
+            helpers::MemoryBudget::FILE_BUFFER, bufferSize * sizeof (tchar));
+    }
     closed = true;
 }
 
 
+unsigned
+FileAppenderBase::getRequiredThreadSpecificData() const
+{
+    return getLayoutRequiredThreadSpecificData ();
+}
+
+
 std::locale
 FileAppenderBase::imbue(std::locale const& loc)
 {
@@ -360,7 +383,7 @@ FileAppenderBase::append(const spi::InternalLoggingEvent& event)
     if (useLockFile)
         out.seekp (0, std::ios_base::end);
 
-    layout->formatAndAppend(out, event);
+    formatAndAppend(out, event);
 
     if(immediateFlush || useLockFile)
         out.flush();
@@ -23,7 +23,10 @@
 #include <log4cplus/helpers/stringhelper.h>
 #include <log4cplus/helpers/property.h>
 #include <log4cplus/spi/loggingevent.h>
+#include <log4cplus/internal/internal.h>
 #include <log4cplus/thread/syncprims-pub-impl.h>
+#include <algorithm>
+#include <limits>
 
 #if defined (LOG4CPLUS_WITH_UNIT_TESTS)
 #include <log4cplus/logger.h>
@@ -56,6 +59,55 @@ checkFilter(const Filter* filter, const InternalLoggingEvent& event)
 }
 
 
+LogLevel
+getLowestAcceptedLogLevel(const Filter* filter, LogLevel ll)
+{
+    LogLevel const max_ll = (std::numeric_limits<LogLevel>::max) ();
+
+    for (;;)
+    {
+        LogLevel next = max_ll;
+        for (const Filter* currentFilter = filter; currentFilter;
+             currentFilter = currentFilter->next.get())
+        {
+            FilterResult result;
+            LogLevel filterNext = max_ll;
+            if (! currentFilter->decideLogLevel(ll, result, filterNext))
+                // Decision depends on more than just the log level.
+                return ll;
+
+            next = (std::min) (next, filterNext);
+            if (result == ACCEPT)
+                return ll;
+            else if (result == DENY)
+                break;
+            else if (! currentFilter->next)
+                // All filters are neutral, the event is accepted.
+                return ll;
+        }
+
+        if (! filter)
+            return ll;
+        else if (next == max_ll)
+            return max_ll;
+
+        ll = next;
+    }
+}
+
+
+unsigned
+getRequiredThreadSpecificData(const Filter* filter)
+{
+    unsigned fields = 0;
+    for (const Filter* currentFilter = filter; currentFilter;
+         currentFilter = currentFilter->next.get())
+        fields |= currentFilter->getRequiredThreadSpecificData();
+
+    return fields;
+}
+
+
 
 ///////////////////////////////////////////////////////////////////////////////
 // Filter implementation
@@ -74,6 +126,22 @@ Filter::appendFilter(FilterPtr filter)
         next = filter;
     else
         next->appendFilter(filter);
+
+    internal::bumpAppenderConfigGeneration();
+}
+
+
+bool
+Filter::decideLogLevel(LogLevel, FilterResult &, LogLevel &) const
+{
+    return false;
+}
+
+
+unsigned
+Filter::getRequiredThreadSpecificData() const
+{
+    return InternalLoggingEvent::TSD_ALL;
 }
 
 
@@ -96,6 +164,23 @@ DenyAllFilter::decide(const InternalLoggingEvent&) const
 }
 
 
+bool
+DenyAllFilter::decideLogLevel(LogLevel, FilterResult & result,
+    LogLevel & next) const
+{
+    result = DENY;
+    next = (std::numeric_limits<LogLevel>::max) ();
+    return true;
+}
+
+
+unsigned
+DenyAllFilter::getRequiredThreadSpecificData() const
+{
+    return 0;
+}
+
+
 
 ///////////////////////////////////////////////////////////////////////////////
 // LogLevelMatchFilter implementation
@@ -146,6 +231,35 @@ LogLevelMatchFilter::decide(const InternalLoggingEvent& event) const
 }
 
 
+bool
+LogLevelMatchFilter::decideLogLevel(LogLevel ll, FilterResult & result,
+    LogLevel & next) const
+{
+    next = (std::numeric_limits<LogLevel>::max) ();
+
+    if(logLevelToMatch == NOT_SET_LOG_LEVEL || ll > logLevelToMatch) {
+        result = NEUTRAL;
+    }
+    else if(ll < logLevelToMatch) {
+        result = NEUTRAL;
+        next = logLevelToMatch;
+    }
+    else {
+        result = (acceptOnMatch ? ACCEPT : DENY);
+        next = logLevelToMatch + 1;
+    }
+
+    return true;
+}
+
+
+unsigned
+LogLevelMatchFilter::getRequiredThreadSpecificData() const
+{
+    return 0;
+}
+
+
 
 ///////////////////////////////////////////////////////////////////////////////
 // LogLevelRangeFilter implementation
@@ -209,6 +323,36 @@ LogLevelRangeFilter::decide(const InternalLoggingEvent& event) const
 }
 
 
+bool
+LogLevelRangeFilter::decideLogLevel(LogLevel ll, FilterResult & result,
+    LogLevel & next) const
+{
+    next = (std::numeric_limits<LogLevel>::max) ();
+
+    if((logLevelMin != NOT_SET_LOG_LEVEL) && (ll < logLevelMin)) {
+        result = DENY;
+        next = logLevelMin;
+    }
+    else if((logLevelMax != NOT_SET_LOG_LEVEL) && (ll > logLevelMax)) {
+        result = DENY;
+    }
+    else {
+        result = (acceptOnMatch ? ACCEPT : NEUTRAL);
+        if(logLevelMax != NOT_SET_LOG_LEVEL)
+            next = logLevelMax + 1;
+    }
+
+    return true;
+}
+
+
+unsigned
+LogLevelRangeFilter::getRequiredThreadSpecificData() const
+{
+    return 0;
+}
+
+
 
 ///////////////////////////////////////////////////////////////////////////////
 // StringMatchFilter implementation
@@ -255,6 +399,13 @@ StringMatchFilter::decide(const InternalLoggingEvent& event) const
 }
 
 
+unsigned
+StringMatchFilter::getRequiredThreadSpecificData() const
+{
+    return 0;
+}
+
+
 //
 //
 //
@@ -310,6 +461,12 @@ FilterResult NDCMatchFilter::decide(const InternalLoggingEvent& event) const
     return (acceptOnMatch ? DENY : ACCEPT);
 }
 
+
+unsigned NDCMatchFilter::getRequiredThreadSpecificData() const
+{
+    return InternalLoggingEvent::TSD_NDC;
+}
+
 //
 // MDC Match filter
 //
@@ -353,6 +510,12 @@ FilterResult MDCMatchFilter::decide(const InternalLoggingEvent& event) const
 }
 
 
+unsigned MDCMatchFilter::getRequiredThreadSpecificData() const
+{
+    return InternalLoggingEvent::TSD_MDC;
+}
+
+
 #if defined (LOG4CPLUS_WITH_UNIT_TESTS)
 CATCH_TEST_CASE ("Filter", "[filter]")
 {
@@ -706,6 +869,24 @@ CATCH_TEST_CASE ("Filter", "[filter]")
             }
         }
     }
+
+    CATCH_SECTION ("required thread specific data")
+    {
+        CATCH_REQUIRE (getRequiredThreadSpecificData (nullptr) == 0);
+
+        filter = new LogLevelMatchFilter;
+        CATCH_REQUIRE (getRequiredThreadSpecificData (filter.get ()) == 0);
+
+        filter->appendFilter (FilterPtr (new NDCMatchFilter));
+        filter->appendFilter (FilterPtr (new MDCMatchFilter));
+        CATCH_REQUIRE (getRequiredThreadSpecificData (filter.get ())
+            == (InternalLoggingEvent::TSD_NDC | InternalLoggingEvent::TSD_MDC));
+
+        filter->appendFilter (FilterPtr (new FunctionFilter (
+            [] (InternalLoggingEvent const &) { return NEUTRAL; })));
+        CATCH_REQUIRE (getRequiredThreadSpecificData (filter.get ())
+            == InternalLoggingEvent::TSD_ALL);
+    }
 }
 
 #endif
@@ -33,6 +33,7 @@
 #include <log4cplus/ndc.h>
 #include <log4cplus/mdc.h>
 #include <log4cplus/helpers/loglog.h>
+#include <log4cplus/helpers/memorybudget.h>
 #include <log4cplus/internal/customloglevelmanager.h>
 #include <log4cplus/internal/internal.h>
 #include <log4cplus/thread/impl/tls.h>
@@ -103,6 +104,15 @@ Initializer::Initializer ()
 }
 
 
+#if defined (LOG4CPLUS_HAVE_MEMORY_RESOURCE)
+Initializer::Initializer (std::pmr::memory_resource * async_event_resource)
+    : Initializer ()
+{
+    helpers::setAsyncEventMemoryResource (async_event_resource);
+}
+#endif
+
+
 // Forward declaration. Defined in this file.
 void shutdownThreadPool();
 
@@ -118,6 +128,10 @@ Initializer::~Initializer ()
         {
             destroy = true;
             deinitialize ();
+#if defined (LOG4CPLUS_HAVE_MEMORY_RESOURCE)
+            // No queued event outlives deinitialize().
+            helpers::setAsyncEventMemoryResource (nullptr);
+#endif
         }
     }
     if (destroy)
@@ -160,8 +174,10 @@ struct DefaultContext
     spi::LayoutFactoryRegistry layout_factory_registry;
     spi::FilterFactoryRegistry filter_factory_registry;
     spi::LocaleFactoryRegistry locale_factory_registry;
+    helpers::MemoryBudget memory_budget;
 #if ! defined (LOG4CPLUS_SINGLE_THREADED)
     std::unique_ptr<progschj::ThreadPool> thread_pool {instantiate_thread_pool ()};
+    internal::housekeeper housekeeper;
 #endif
     Hierarchy hierarchy;
 };
@@ -250,6 +266,16 @@ CustomLogLevelManager & getCustomLogLevelManager ()
     return get_dc ()->custom_log_level_manager;
 }
 
+
+#if ! defined (LOG4CPLUS_SINGLE_THREADED)
+housekeeper * get_housekeeper (bool alloc)
+{
+    DefaultContext * const dc = get_dc (alloc);
+    return dc ? &dc->housekeeper : nullptr;
+}
+
+#endif
+
 } // namespace internal
 
 
@@ -271,6 +297,13 @@ getLogLog ()
 }
 
 
+MemoryBudget &
+getMemoryBudget ()
+{
+    return get_dc ()->memory_budget;
+}
+
+
 } // namespace helpers
 
 
@@ -313,12 +346,12 @@ getMDC ()
     && defined (LOG4CPLUS_ENABLE_THREAD_POOL)
 void
 enqueueAsyncDoAppend (SharedAppenderPtr const & appender,
-    spi::InternalLoggingEvent const & event)
+    std::shared_ptr<spi::InternalLoggingEvent const> event)
 {
     get_dc ()->thread_pool->enqueue (
-        [=] ()
+        [appender, event = std::move (event)] ()
         {
-            appender->asyncDoAppend (event);
+            appender->asyncDoAppend (*event);
         });
 }
 
@@ -390,11 +423,7 @@ namespace internal
 {
 
 
-gft_scratch_pad::gft_scratch_pad ()
-    : uc_q_str_valid (false)
-    , q_str_valid (false)
-    , s_str_valid (false)
-{ }
+gft_scratch_pad::gft_scratch_pad () = default;
 
 
 gft_scratch_pad::~gft_scratch_pad () = default;
@@ -406,8 +435,20 @@ appender_sratch_pad::appender_sratch_pad () = default;
 appender_sratch_pad::~appender_sratch_pad () = default;
 
 
+dispatch_cache::dispatch_cache ()
+    : event (nullptr)
+    , shared_fingerprints (nullptr)
+    , size (0)
+    , shared_event_fields (0)
+{ }
+
+
+dispatch_cache::~dispatch_cache () = default;
+
+
 per_thread_data::per_thread_data ()
-    : fnull (nullptr)
+    : dispatch_hierarchy (nullptr)
+    , fnull (nullptr)
 { }
 
 
@@ -551,6 +592,9 @@ deinitialize ()
 {
     shutdownThreadPool();
     Logger::shutdown ();
+#if defined (LOG4CPLUS_ENABLE_STAGE_PROFILER)
+    internal::dump_stage_profile_at_exit ();
+#endif
 }
 
 
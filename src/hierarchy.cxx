@@ -19,12 +19,18 @@
 // limitations under the License.
 
 #include <log4cplus/hierarchy.h>
+#include <log4cplus/appender.h>
 #include <log4cplus/helpers/loglog.h>
+#include <log4cplus/spi/loggingevent.h>
 #include <log4cplus/spi/loggerimpl.h>
 #include <log4cplus/spi/rootlogger.h>
+#include <log4cplus/helpers/housekeeping.h>
 #include <log4cplus/thread/syncprims-pub-impl.h>
+#include <log4cplus/internal/internal.h>
+#include <algorithm>
 #include <utility>
 #include <limits>
+#include <unordered_map>
 
 
 namespace log4cplus
@@ -49,9 +55,84 @@ bool startsWith(tstring_view const & teststr, tstring_view const & substr)
     return val;
 }
 
+
+static
+void
+closeAppenders (SharedAppenderPtrList const & appenders)
+{
+    for (auto const & appender : appenders)
+    {
+        appender->waitToFinishAsyncLogging ();
+        if (! appender->isClosed ())
+            appender->close ();
+    }
+}
+
+
+static
+void
+closeReplacedAppenders (SharedAppenderPtrList appenders)
+{
+    if (appenders.empty ())
+        return;
+
+#if ! defined (LOG4CPLUS_SINGLE_THREADED)
+    // The last reference to the epoch can be dropped by a logging call,
+    // so the appenders are closed by a housekeeping task instead. The
+    // task runs as soon as possible, once; it cancels itself after the
+    // first run.
+    auto task_id = std::make_shared<std::atomic<helpers::HousekeepingTaskId>> (0);
+    task_id->store (helpers::scheduleHousekeepingTask (
+        std::chrono::milliseconds::zero (),
+        [task_id, appenders = std::move (appenders)] () mutable
+        {
+            closeAppenders (appenders);
+            appenders.clear ();
+            helpers::cancelHousekeepingTask (task_id->load ());
+        }));
+
+#else
+    closeAppenders (appenders);
+
+#endif
+}
+
 } // namespace
 
 
+struct Hierarchy::ConfigurationEpoch
+{
+    ConfigurationEpoch () = default;
+
+    ~ConfigurationEpoch ()
+    {
+        try
+        {
+            closeReplacedAppenders (std::move (replaced));
+        }
+        catch (std::exception const & e)
+        {
+            helpers::getLogLog ().error (
+                LOG4CPLUS_TEXT ("Closing of replaced appenders failed: ")
+                + LOG4CPLUS_C_STR_TO_TSTRING (e.what ()));
+        }
+
+        if (drained)
+            drained->signal ();
+    }
+
+    //! Appenders dropped by the configuration which ended this epoch.
+    SharedAppenderPtrList replaced;
+
+    //! Signaled when the epoch is released, if set by
+    //! Hierarchy::holdDispatch().
+    thread::ManualResetEvent * drained = nullptr;
+
+    ConfigurationEpoch (ConfigurationEpoch const &) = delete;
+    ConfigurationEpoch & operator = (ConfigurationEpoch const &) = delete;
+};
+
+
 //////////////////////////////////////////////////////////////////////////////
 // Hierarchy static declarations
 //////////////////////////////////////////////////////////////////////////////
@@ -71,6 +152,11 @@ Hierarchy::Hierarchy()
   // Don't disable any LogLevel level by default.
   , disableValue(DISABLE_OFF)
   , emittedNoAppenderWarning(false)
+  , configGeneration(1)
+  , configurationEpoch(std::make_shared<ConfigurationEpoch>())
+  , truncatedMessages(0)
+  , dispatchHeld(false)
+  , dispatchHolderPrevious(nullptr)
 {
     root = Logger( new spi::RootLogger(*this, DEBUG_LOG_LEVEL) );
 }
@@ -94,6 +180,7 @@ Hierarchy::clear()
 
     provisionNodes.erase(provisionNodes.begin(), provisionNodes.end());
     loggerPtrs.erase(loggerPtrs.begin(), loggerPtrs.end());
+    bumpConfigurationGeneration();
 }
 
 
@@ -173,6 +260,54 @@ Hierarchy::getInstance(const tstring_view& name, spi::LoggerFactory& factory)
 }
 
 
+void
+Hierarchy::logBatch(spi::InternalLoggingEvent const * events,
+    std::size_t count)
+{
+    using AppenderListPtr = std::shared_ptr<SharedAppenderPtrList const>;
+    using EventPtrList = std::vector<spi::InternalLoggingEvent const *>;
+
+    // Resolve appenders of each distinct logger only once.
+    std::unordered_map<tstring_view, AppenderListPtr> loggers;
+    // Appenders in order of first use, with the events they should append.
+    std::vector<std::pair<Appender *, EventPtrList>> batches;
+    std::unordered_map<Appender *, std::size_t> batch_index;
+    Logger logger;
+
+    for (std::size_t i = 0; i != count; ++i)
+    {
+        spi::InternalLoggingEvent const & event = events[i];
+        tstring_view const name (event.getLoggerName ());
+
+        auto it = loggers.find (name);
+        if (it == loggers.end ())
+        {
+            logger = getInstance (name);
+            it = loggers.emplace (name,
+                logger.value->getEffectiveAppenders ()).first;
+            logger.value->checkNoAppenders (*it->second);
+        }
+
+        for (SharedAppenderPtr const & appender : *it->second)
+        {
+            auto const ret = batch_index.emplace (appender.get (),
+                batches.size ());
+            if (ret.second)
+                batches.emplace_back (appender.get (), EventPtrList ());
+            batches[ret.first->second].second.push_back (&event);
+        }
+    }
+
+    // The appender lists in loggers keep the appenders alive. They have
+    // been taken before the thread is marked as dispatching, so that they
+    // are held back by HierarchyLocker.
+    DispatchGuard gate (*this);
+    for (auto & batch : batches)
+        batch.first->doAppendBatch (batch.second.data (),
+            batch.second.size ());
+}
+
+
 LoggerList
 Hierarchy::getCurrentLoggers()
 {
@@ -219,6 +354,119 @@ Hierarchy::resetConfiguration()
 }
 
 
+void
+Hierarchy::publishConfiguration(Hierarchy& staged)
+{
+    struct LoggerState
+    {
+        LogLevel ll;
+        bool additive;
+        std::size_t maxMessageSize;
+        SharedAppenderPtrList appenders;
+    };
+
+    // Take the appenders away from the staged loggers so that shutdown of
+    // the staged hierarchy does not close them.
+    auto const take = [] (spi::LoggerImpl & impl)
+    {
+        LoggerState state {impl.ll.load (std::memory_order_relaxed),
+            impl.additive.load (std::memory_order_relaxed),
+            impl.maxMessageSize.load (std::memory_order_relaxed), {}};
+        thread::MutexGuard guard (impl.appender_list_mutex);
+        state.appenders.swap (impl.appenderList);
+        return state;
+    };
+
+    LoggerState root_state = take (*staged.root.value);
+    std::unordered_map<tstring, LoggerState> states;
+    for (Logger & logger : staged.getCurrentLoggers ())
+        states.emplace (logger.getName (), take (*logger.value));
+
+    SharedAppenderPtrList new_appenders;
+    SharedAppenderPtrList old_appenders;
+    std::shared_ptr<ConfigurationEpoch> previous_epoch;
+    auto const install = [&] (spi::LoggerImpl & impl, LoggerState & state)
+    {
+        new_appenders.insert (new_appenders.end (), state.appenders.begin (),
+            state.appenders.end ());
+        {
+            thread::MutexGuard guard (impl.appender_list_mutex);
+            impl.appenderList.swap (state.appenders);
+        }
+        old_appenders.insert (old_appenders.end (), state.appenders.begin (),
+            state.appenders.end ());
+
+        impl.ll.store (state.ll, std::memory_order_relaxed);
+        impl.additive.store (state.additive, std::memory_order_relaxed);
+        impl.maxMessageSize.store (state.maxMessageSize,
+            std::memory_order_relaxed);
+    };
+
+    {
+        thread::MutexGuard guard (hashtable_mutex);
+
+        install (*root.value, root_state);
+        for (auto & entry : loggerPtrs)
+        {
+            auto it = states.find (entry.first);
+            if (it != states.end ())
+            {
+                install (*entry.second.value, it->second);
+                states.erase (it);
+            }
+            else
+            {
+                LoggerState defaults {NOT_SET_LOG_LEVEL, true, 0, {}};
+                install (*entry.second.value, defaults);
+            }
+        }
+
+        // Loggers configured in the staged hierarchy only.
+        for (auto & entry : states)
+        {
+            Logger logger = getInstanceImpl (entry.first, *defaultFactory);
+            install (*logger.value, entry.second);
+        }
+
+        disableValue = staged.disableValue;
+
+        // Appender lists built from now on belong to the new epoch. The
+        // cached ones are dropped so that only lists still in use keep
+        // the old epoch alive.
+        previous_epoch = std::atomic_exchange (&configurationEpoch,
+            std::make_shared<ConfigurationEpoch> ());
+        bumpConfigurationGeneration ();
+
+        root.value->resetEffectiveAppenders ();
+        for (auto & entry : loggerPtrs)
+            entry.second.value->resetEffectiveAppenders ();
+    }
+
+    // Appenders which are part of the new configuration as well stay open.
+    SharedAppenderPtrList replaced;
+    auto const contains = [] (SharedAppenderPtrList const & list,
+        SharedAppenderPtr const & appender)
+    {
+        return std::find (list.begin (), list.end (), appender) != list.end ();
+    };
+    for (auto & appender : old_appenders)
+        if (! contains (new_appenders, appender)
+            && ! contains (replaced, appender))
+            replaced.push_back (std::move (appender));
+
+    // The replaced appenders are closed when the last appender list of
+    // the old epoch is dropped.
+    previous_epoch->replaced = std::move (replaced);
+}
+
+
+std::shared_ptr<Hierarchy::ConfigurationEpoch>
+Hierarchy::getConfigurationEpoch () const
+{
+    return std::atomic_load (&configurationEpoch);
+}
+
+
 void
 Hierarchy::setLoggerFactory(std::unique_ptr<spi::LoggerFactory> factory)
 {
@@ -304,6 +552,9 @@ Hierarchy::getInstanceImpl(const tstring_view& name,
             provisionNodes.erase(pnm_it);
         }
         updateParents(logger);
+
+        // Re-parenting changes which appenders existing loggers reach.
+        bumpConfigurationGeneration();
     }
 
     return logger;
@@ -380,4 +631,102 @@ Hierarchy::updateChildren(ProvisionNode& pn, Logger const & logger)
 }
 
 
+//////////////////////////////////////////////////////////////////////////////
+// Hierarchy dispatch gate
+//////////////////////////////////////////////////////////////////////////////
+
+Hierarchy::DispatchGuard::DispatchGuard(Hierarchy& LOG4CPLUS_THREADED (h))
+    : registered(nullptr)
+    , previous(nullptr)
+{
+#if ! defined (LOG4CPLUS_SINGLE_THREADED)
+    internal::per_thread_data * ptd = internal::get_ptd ();
+    previous = ptd->dispatch_hierarchy;
+    if (previous == &h)
+        return;
+
+    ptd->dispatch_hierarchy = &h;
+    registered = &h;
+#endif
+}
+
+
+Hierarchy::DispatchGuard::~DispatchGuard()
+{
+#if ! defined (LOG4CPLUS_SINGLE_THREADED)
+    if (registered)
+        internal::get_ptd ()->dispatch_hierarchy = previous;
+#endif
+}
+
+
+bool
+Hierarchy::isDispatchingThread() const
+{
+#if ! defined (LOG4CPLUS_SINGLE_THREADED)
+    return internal::get_ptd ()->dispatch_hierarchy == this;
+
+#else
+    return false;
+
+#endif
+}
+
+
+bool
+Hierarchy::holdDispatch()
+{
+#if ! defined (LOG4CPLUS_SINGLE_THREADED)
+    internal::per_thread_data * ptd = internal::get_ptd ();
+    if (ptd->dispatch_hierarchy == this)
+        return false;
+
+    dispatchHoldMutex.lock();
+    dispatchReleased.reset();
+    dispatchDrained.reset();
+
+    // The flag is set before the epoch changes. Loggers check it after
+    // they take the epoch, so a logger which has taken the new epoch
+    // sees the flag and waits, and one which has taken the old epoch is
+    // waited for below.
+    dispatchHeld.store(true);
+    std::shared_ptr<ConfigurationEpoch> previous_epoch
+        = std::atomic_exchange (&configurationEpoch,
+            std::make_shared<ConfigurationEpoch> ());
+    bumpConfigurationGeneration ();
+    {
+        thread::MutexGuard guard (hashtable_mutex);
+        root.value->resetEffectiveAppenders ();
+        for (auto & entry : loggerPtrs)
+            entry.second.value->resetEffectiveAppenders ();
+    }
+
+    // Appender lists of dispatches in flight keep the old epoch alive.
+    previous_epoch->drained = &dispatchDrained;
+    previous_epoch.reset ();
+    dispatchDrained.wait();
+
+    dispatchHolderPrevious = ptd->dispatch_hierarchy;
+    ptd->dispatch_hierarchy = this;
+    return true;
+
+#else
+    return false;
+
+#endif
+}
+
+
+void
+Hierarchy::releaseDispatch()
+{
+#if ! defined (LOG4CPLUS_SINGLE_THREADED)
+    internal::get_ptd ()->dispatch_hierarchy = dispatchHolderPrevious;
+    dispatchHeld.store(false);
+    dispatchReleased.signal();
+    dispatchHoldMutex.unlock();
+#endif
+}
+
+
 } // namespace log4cplus
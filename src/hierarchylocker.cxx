@@ -24,6 +24,16 @@
 #include <log4cplus/spi/loggerimpl.h>
 #include <log4cplus/thread/syncprims-pub-impl.h>
 
+#if defined (LOG4CPLUS_WITH_UNIT_TESTS) \
+    && ! defined (LOG4CPLUS_SINGLE_THREADED)
+#include <catch.hpp>
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <thread>
+#include <vector>
+#endif
+
 
 namespace log4cplus
 {
@@ -35,16 +45,21 @@ namespace log4cplus
 
 HierarchyLocker::HierarchyLocker(Hierarchy& _h)
 : h(_h),
-  hierarchyLocker(h.hashtable_mutex)
+  // Wait for events being dispatched to finish first; their appenders
+  // may need the mutexes locked below.
+  dispatchHeld(h.holdDispatch())
 {
-    // Get a copy of all of the Hierarchy's Loggers (except the Root Logger)
-    h.initializeLoggerList(loggerList);
-
-    // Lock all of the Hierarchy's Loggers' mutexs
-    LoggerList::iterator it;
+    LoggerList::iterator it = loggerList.begin();
     try
     {
-        for (it = loggerList.begin(); it != loggerList.end(); ++it)
+        hierarchyLocker.attach_and_lock (h.hashtable_mutex);
+
+        // Get a copy of all of the Hierarchy's Loggers (except the Root Logger)
+        h.initializeLoggerList(loggerList);
+        it = loggerList.begin();
+
+        // Lock all of the Hierarchy's Loggers' mutexs
+        for (; it != loggerList.end(); ++it)
             it->value->appender_list_mutex.lock ();
     }
     catch (...)
@@ -55,6 +70,8 @@ HierarchyLocker::HierarchyLocker(Hierarchy& _h)
         auto range_end = it;
         for (it = loggerList.begin (); it != range_end; ++it)
             it->value->appender_list_mutex.unlock ();
+        if (dispatchHeld)
+            h.releaseDispatch();
         throw;
     }
 }
@@ -65,6 +82,10 @@ HierarchyLocker::~HierarchyLocker() LOG4CPLUS_NOEXCEPT_FALSE
     try {
         for (auto & logger : loggerList)
             logger.value->appender_list_mutex.unlock ();
+        hierarchyLocker.unlock ();
+        hierarchyLocker.detach ();
+        if (dispatchHeld)
+            h.releaseDispatch();
     }
     catch(...) {
         helpers::getLogLog().error(LOG4CPLUS_TEXT("HierarchyLocker::dtor()- An error occurred while unlocking"));
@@ -129,4 +150,96 @@ HierarchyLocker::addAppender(Logger& logger, SharedAppenderPtr& appender)
 }
 
 
+
+#if defined (LOG4CPLUS_WITH_UNIT_TESTS) \
+    && ! defined (LOG4CPLUS_SINGLE_THREADED)
+namespace
+{
+
+//! Counts appends which overlap with or follow close().
+class SlowAppender
+    : public Appender
+{
+public:
+    SlowAppender ()
+        : appends (0)
+        , late (0)
+        , closing (false)
+    { }
+
+    virtual ~SlowAppender ()
+    {
+        destructorImpl ();
+    }
+
+    virtual void close ()
+    {
+        closing = true;
+        closed = true;
+    }
+
+    std::atomic<int> appends;
+    std::atomic<int> late;
+    std::atomic<bool> closing;
+
+protected:
+    virtual void append (const spi::InternalLoggingEvent &)
+    {
+        if (closing)
+            ++late;
+        std::this_thread::sleep_for (std::chrono::microseconds (200));
+        if (closing)
+            ++late;
+        ++appends;
+    }
+};
+
+} // namespace
+
+
+CATCH_TEST_CASE ("HierarchyLocker", "[hierarchy]")
+{
+    Hierarchy h;
+    Logger logger = h.getInstance (LOG4CPLUS_TEXT ("test"));
+    helpers::SharedObjectPtr<SlowAppender> app (new SlowAppender);
+    h.getRoot ().addAppender (SharedAppenderPtr (app.get ()));
+
+    std::atomic<bool> stop (false);
+    std::vector<std::thread> threads;
+    for (int i = 0; i != 4; ++i)
+        threads.emplace_back ([&]
+            {
+                while (! stop)
+                    logger.forcedLog (INFO_LOG_LEVEL, LOG4CPLUS_TEXT ("msg"));
+            });
+
+    while (app->appends < 20)
+        std::this_thread::yield ();
+
+    {
+        // Closing the appender waits for appends in progress and logging
+        // does not reach it while the hierarchy is locked.
+        HierarchyLocker locker (h);
+        locker.resetConfiguration ();
+
+        // Level checks do not wait for the locker.
+        auto enabled = std::async (std::launch::async,
+            [&] { return logger.isEnabledFor (INFO_LOG_LEVEL); });
+        CATCH_REQUIRE (enabled.wait_for (std::chrono::seconds (10))
+            == std::future_status::ready);
+        CATCH_REQUIRE (enabled.get ());
+    }
+
+    stop = true;
+    for (auto & thread : threads)
+        thread.join ();
+
+    CATCH_REQUIRE (app->closing);
+    CATCH_REQUIRE (app->late == 0);
+    h.shutdown ();
+}
+
+#endif
+
+
 } // namespace log4cplus
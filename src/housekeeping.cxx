@@ -0,0 +1,253 @@
+// -*- C++ -*-
+//
+//  Copyright (C) 2026, Vaclav Zeman. All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without modifica-
+//  tion, are permitted provided that the following conditions are met:
+//
+//  1. Redistributions of  source code must  retain the above copyright  notice,
+//     this list of conditions and the following disclaimer.
+//
+//  2. Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//
+//  THIS SOFTWARE IS PROVIDED ``AS IS'' AND ANY EXPRESSED OR IMPLIED WARRANTIES,
+//  INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+//  FITNESS  FOR A PARTICULAR  PURPOSE ARE  DISCLAIMED.  IN NO  EVENT SHALL  THE
+//  APACHE SOFTWARE  FOUNDATION  OR ITS CONTRIBUTORS  BE LIABLE FOR  ANY DIRECT,
+//  INDIRECT, INCIDENTAL, SPECIAL,  EXEMPLARY, OR CONSEQUENTIAL  DAMAGES (INCLU-
+//  DING, BUT NOT LIMITED TO, PROCUREMENT  OF SUBSTITUTE GOODS OR SERVICES; LOSS
+//  OF USE, DATA, OR  PROFITS; OR BUSINESS  INTERRUPTION)  HOWEVER CAUSED AND ON
+//  ANY  THEORY OF LIABILITY,  WHETHER  IN CONTRACT,  STRICT LIABILITY,  OR TORT
+//  (INCLUDING  NEGLIGENCE OR  OTHERWISE) ARISING IN  ANY WAY OUT OF THE  USE OF
+//  THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <log4cplus/config.hxx>
+
+#if ! defined (LOG4CPLUS_SINGLE_THREADED)
+
+#include <log4cplus/helpers/housekeeping.h>
+#include <log4cplus/helpers/loglog.h>
+#include <log4cplus/thread/threads.h>
+#include <log4cplus/internal/internal.h>
+#include <algorithm>
+#include <exception>
+
+#if defined (LOG4CPLUS_WITH_UNIT_TESTS)
+#include <catch.hpp>
+#endif
+
+
+namespace log4cplus {
+
+
+namespace internal {
+
+
+housekeeper::housekeeper ()
+    : next_id (1)
+    , running_id (0)
+    , exit_flag (false)
+{ }
+
+
+housekeeper::~housekeeper ()
+{
+    {
+        std::unique_lock<std::mutex> lock (mtx);
+        exit_flag = true;
+    }
+    cond.notify_all ();
+
+    if (thread.joinable ())
+        thread.join ();
+}
+
+
+housekeeper::task_id
+housekeeper::schedule (std::chrono::milliseconds period,
+    std::function<void ()> func)
+{
+    period = (std::max) (period, std::chrono::milliseconds (1));
+    auto task = std::make_shared<task_type> (
+        task_type {period, std::move (func)});
+
+    std::unique_lock<std::mutex> lock (mtx);
+    task_id const id = next_id++;
+    tasks.emplace (id, std::move (task));
+    schedule_queue.emplace (clock_type::now () + period, id);
+
+    if (! thread.joinable ())
+    {
+        thread::SignalsBlocker sb;
+        thread = std::thread ([this] { run (); });
+    }
+
+    lock.unlock ();
+    cond.notify_all ();
+
+    return id;
+}
+
+
+void
+housekeeper::cancel (task_id id)
+{
+    std::unique_lock<std::mutex> lock (mtx);
+    auto const it = tasks.find (id);
+    if (it == tasks.end ())
+        return;
+
+    tasks.erase (it);
+    auto const queued = std::find_if (schedule_queue.begin (),
+        schedule_queue.end (),
+        [id] (auto const & entry) { return entry.second == id; });
+    if (queued != schedule_queue.end ())
+        schedule_queue.erase (queued);
+
+    // Wait for running task to finish unless it is cancelling itself.
+    if (std::this_thread::get_id () != thread.get_id ())
+        cond.wait (lock, [&] { return running_id != id; });
+}
+
+
+void
+housekeeper::run ()
+{
+    std::unique_lock<std::mutex> lock (mtx);
+    while (! exit_flag)
+    {
+        if (schedule_queue.empty ())
+        {
+            cond.wait (lock);
+            continue;
+        }
+
+        auto const first = schedule_queue.begin ();
+        if (first->first > clock_type::now ())
+        {
+            cond.wait_until (lock, first->first);
+            continue;
+        }
+
+        task_id const id = first->second;
+        schedule_queue.erase (first);
+        std::shared_ptr<task_type> task = tasks.at (id);
+        std::chrono::milliseconds const period = task->period;
+        running_id = id;
+        lock.unlock ();
+
+        try
+        {
+            task->func ();
+        }
+        catch (std::exception const & e)
+        {
+            helpers::getLogLog ().error (
+                LOG4CPLUS_TEXT ("Housekeeping task has thrown exception: ")
+                + LOG4CPLUS_C_STR_TO_TSTRING (e.what ()));
+        }
+        catch (...)
+        {
+            helpers::getLogLog ().error (
+                LOG4CPLUS_TEXT ("Housekeeping task has thrown exception."));
+        }
+
+        // Release the task outside of the lock; it could be the last
+        // reference if the task has been cancelled meanwhile.
+        task.reset ();
+
+        lock.lock ();
+        running_id = 0;
+        if (tasks.find (id) != tasks.end ())
+            schedule_queue.emplace (clock_type::now () + period, id);
+
+        cond.notify_all ();
+    }
+}
+
+
+} // namespace internal
+
+
+namespace helpers {
+
+
+HousekeepingTaskId
+scheduleHousekeepingTask (std::chrono::milliseconds period,
+    std::function<void ()> task)
+{
+    return internal::get_housekeeper ()->schedule (period, std::move (task));
+}
+
+
+void
+cancelHousekeepingTask (HousekeepingTaskId id)
+{
+    // Tasks cannot outlive the default context.
+    if (internal::housekeeper * hk = internal::get_housekeeper (false))
+        hk->cancel (id);
+}
+
+
+#if defined (LOG4CPLUS_WITH_UNIT_TESTS)
+CATCH_TEST_CASE ("Housekeeping", "[housekeeping]")
+{
+    using namespace std::chrono_literals;
+
+    std::mutex mtx;
+    std::condition_variable cond;
+    unsigned count = 0;
+
+    auto wait_for_count = [&] (unsigned expected)
+    {
+        std::unique_lock<std::mutex> lock (mtx);
+        return cond.wait_for (lock, 10s, [&] { return count >= expected; });
+    };
+
+    CATCH_SECTION ("periodic task runs until cancelled")
+    {
+        HousekeepingTaskId const id = scheduleHousekeepingTask (1ms,
+            [&]
+            {
+                std::unique_lock<std::mutex> lock (mtx);
+                ++count;
+                cond.notify_all ();
+            });
+        CATCH_REQUIRE (wait_for_count (3));
+        cancelHousekeepingTask (id);
+
+        unsigned const cancelled_count = count;
+        std::this_thread::sleep_for (20ms);
+        CATCH_REQUIRE (count == cancelled_count);
+    }
+
+    CATCH_SECTION ("task can cancel itself")
+    {
+        HousekeepingTaskId id = 0;
+        {
+            std::unique_lock<std::mutex> lock (mtx);
+            id = scheduleHousekeepingTask (1ms,
+                [&]
+                {
+                    std::unique_lock<std::mutex> lock (mtx);
+                    ++count;
+                    cancelHousekeepingTask (id);
+                    cond.notify_all ();
+                });
+        }
+        CATCH_REQUIRE (wait_for_count (1));
+        std::this_thread::sleep_for (20ms);
+        CATCH_REQUIRE (count == 1);
+    }
+}
+
+#endif
+
+
+} // namespace helpers
+
+} // namespace log4cplus
+
+#endif // ! defined (LOG4CPLUS_SINGLE_THREADED)
@@ -49,27 +49,142 @@ formatRelativeTimestamp (log4cplus::tostream & output,
 
 Layout::Layout ()
     : llmCache(getLogLevelManager())
+    , requiredThreadSpecificData(spi::InternalLoggingEvent::TSD_ALL)
 { }
 
 
 Layout::Layout (const log4cplus::helpers::Properties&)
     : llmCache(getLogLevelManager())
+    , requiredThreadSpecificData(spi::InternalLoggingEvent::TSD_ALL)
 { }
 
 
 Layout::~Layout() = default;
 
 
+void
+Layout::formatSegments(LayoutSegments & output,
+    const log4cplus::spi::InternalLoggingEvent& event)
+{
+    tostringstream oss;
+    formatAndAppend (oss, event);
+    output.appendText (oss.str ());
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+// log4cplus::LayoutSegments
+///////////////////////////////////////////////////////////////////////////////
+
+LayoutSegments::LayoutSegments() = default;
+
+
+LayoutSegments::~LayoutSegments() = default;
+
+
+void
+LayoutSegments::clear()
+{
+    scratch.clear ();
+    segments.clear ();
+}
+
+
+LayoutSegments::Segment &
+LayoutSegments::scratchSegment()
+{
+    // Extend the last segment if it ends at the end of scratch buffer.
+    if (segments.empty () || segments.back ().ptr
+        || segments.back ().offset + segments.back ().length
+            != scratch.size ())
+        segments.push_back (Segment {nullptr, scratch.size (), 0});
+
+    return segments.back ();
+}
+
+
+void
+LayoutSegments::appendText(tstring_view const & text)
+{
+    if (text.empty ())
+        return;
+
+    scratchSegment ().length += text.size ();
+    scratch.append (text);
+}
+
+
+void
+LayoutSegments::appendFill(std::size_t count, tchar ch)
+{
+    if (count == 0)
+        return;
+
+    scratchSegment ().length += count;
+    scratch.append (count, ch);
+}
+
+
+void
+LayoutSegments::appendReference(tstring_view const & text)
+{
+    if (text.size () < referenceThreshold)
+        appendText (text);
+    else
+        segments.push_back (Segment {text.data (), 0, text.size ()});
+}
+
+
+tstring_view
+LayoutSegments::operator [] (std::size_t i) const
+{
+    Segment const & segment = segments[i];
+    if (segment.ptr)
+        return tstring_view (segment.ptr, segment.length);
+    else
+        return tstring_view (scratch).substr (segment.offset, segment.length);
+}
+
+
+void
+LayoutSegments::writeTo(tostream & output) const
+{
+    for (std::size_t i = 0; i != segments.size (); ++i)
+    {
+        tstring_view const text = (*this)[i];
+        output.write (text.data (), static_cast<std::streamsize>(text.size ()));
+    }
+}
+
+
+tstring
+LayoutSegments::str() const
+{
+    tstring result;
+    for (std::size_t i = 0; i != segments.size (); ++i)
+        result.append ((*this)[i]);
+
+    return result;
+}
+
+
 ///////////////////////////////////////////////////////////////////////////////
 // log4cplus::SimpleLayout public methods
 ///////////////////////////////////////////////////////////////////////////////
 
-SimpleLayout::SimpleLayout () = default;
+SimpleLayout::SimpleLayout ()
+{
+    fingerprint = LOG4CPLUS_TEXT ("log4cplus::SimpleLayout");
+    requiredThreadSpecificData = 0;
+}
 
 
 SimpleLayout::SimpleLayout (const helpers::Properties& properties)
     : Layout (properties)
-{ }
+{
+    fingerprint = LOG4CPLUS_TEXT ("log4cplus::SimpleLayout");
+    requiredThreadSpecificData = 0;
+}
 
 
 SimpleLayout::~SimpleLayout() = default;
@@ -98,6 +213,7 @@ SimpleLayout::formatAndAppend(log4cplus::tostream& output,
     , category_prefixing (category_prefixing_)
     , context_printing (context_printing_)
 {
+    updateFingerprint ();
 }
 
 
@@ -110,6 +226,7 @@ TTCCLayout::TTCCLayout(const log4cplus::helpers::Properties& properties)
     properties.getBool (thread_printing, LOG4CPLUS_TEXT("ThreadPrinting"));
     properties.getBool (category_prefixing, LOG4CPLUS_TEXT("CategoryPrefixing"));
     properties.getBool (context_printing, LOG4CPLUS_TEXT("ContextPrinting"));
+    updateFingerprint ();
 }
 
 
@@ -128,8 +245,12 @@ TTCCLayout::formatAndAppend(log4cplus::tostream& output,
      if (dateFormat.empty ())
          formatRelativeTimestamp (output, event);
      else
-         output << helpers::getFormattedTime(dateFormat, event.getTimestamp(),
-             use_gmtime);
+     {
+         tstring & str = internal::get_gft_scratch_pad ().ret;
+         str.clear ();
+         dateFormatter.append (str, event.getTimestamp(), use_gmtime);
+         output << str;
+     }
 
      if (getThreadPrinting ())
          output << LOG4CPLUS_TEXT(" [")
@@ -167,6 +288,7 @@ void
 TTCCLayout::setThreadPrinting(bool thread_printing_)
 {
     thread_printing = thread_printing_;
+    updateFingerprint ();
 }
 
 
@@ -181,6 +303,7 @@ void
 TTCCLayout::setCategoryPrefixing(bool category_prefixing_)
 {
     category_prefixing = category_prefixing_;
+    updateFingerprint ();
 }
 
 
@@ -195,6 +318,28 @@ void
 TTCCLayout::setContextPrinting(bool context_printing_)
 {
     context_printing = context_printing_;
+    updateFingerprint ();
+}
+
+
+void
+TTCCLayout::updateFingerprint()
+{
+    fingerprint = LOG4CPLUS_TEXT ("log4cplus::TTCCLayout|");
+    fingerprint += use_gmtime ? LOG4CPLUS_TEXT ('1') : LOG4CPLUS_TEXT ('0');
+    fingerprint += thread_printing ? LOG4CPLUS_TEXT ('1') : LOG4CPLUS_TEXT ('0');
+    fingerprint += category_prefixing ? LOG4CPLUS_TEXT ('1') : LOG4CPLUS_TEXT ('0');
+    fingerprint += context_printing ? LOG4CPLUS_TEXT ('1') : LOG4CPLUS_TEXT ('0');
+    fingerprint += LOG4CPLUS_TEXT ('|');
+    fingerprint += dateFormat;
+
+    if (dateFormatter.getFormat () != dateFormat)
+        dateFormatter.setFormat (dateFormat);
+
+    requiredThreadSpecificData
+        = (thread_printing ? spi::InternalLoggingEvent::TSD_THREAD : 0)
+        | (context_printing ? spi::InternalLoggingEvent::TSD_NDC : 0);
+    internal::bumpAppenderConfigGeneration ();
 }
 
 
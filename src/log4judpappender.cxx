@@ -138,7 +138,7 @@ Log4jUdpAppender::Log4jUdpAppender(const tstring& host_, int port_, bool ipv6_)
     , port(port_)
     , ipv6(ipv6_)
 {
-    layout = std::make_unique<PatternLayout> (LOG4CPLUS_TEXT ("%m"));
+    setLayout (std::make_unique<PatternLayout> (LOG4CPLUS_TEXT ("%m")));
     openSocket();
 }
 
@@ -196,6 +196,9 @@ Log4jUdpAppender::openSocket()
 void
 Log4jUdpAppender::append(const spi::InternalLoggingEvent& event)
 {
+    static helpers::TimeFormatter const log4jTimeFormatter (
+        LOG4CPLUS_TEXT("%s%q"));
+
     if(!socket.isOpen()) {
         openSocket();
         if(!socket.isOpen()) {
@@ -220,8 +223,7 @@ Log4jUdpAppender::append(const spi::InternalLoggingEvent& event)
            << outputXMLEscaped (getLogLevelManager()
                .toString(event.getLogLevel()))
            << LOG4CPLUS_TEXT("\" timestamp=\"")
-           << helpers::getFormattedTime(LOG4CPLUS_TEXT("%s%q"),
-               event.getTimestamp())
+           << log4jTimeFormatter.format (event.getTimestamp())
            << LOG4CPLUS_TEXT("\" thread=\"") << event.getThread()
            << LOG4CPLUS_TEXT("\">")
 
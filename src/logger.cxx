@@ -23,7 +23,9 @@
 #include <log4cplus/hierarchy.h>
 #include <log4cplus/helpers/loglog.h>
 #include <log4cplus/spi/loggerimpl.h>
+#include <log4cplus/spi/loggingevent.h>
 #include <utility>
+#include <vector>
 
 
 namespace log4cplus
@@ -260,6 +262,18 @@ Logger::log (spi::InternalLoggingEvent const & ev) const
 }
 
 
+void
+Logger::logBinary (LogLevel ll, const log4cplus::tstring_view& message,
+    void const * data, std::size_t size, const char* file, int line,
+    const char* function) const
+{
+    if (value->isEnabledFor (ll))
+        value->forcedLogBinary (ll, message,
+            std::string_view (static_cast<char const *>(data), size), file,
+            line, function ? function : "");
+}
+
+
 void
 Logger::forcedLog (LogLevel ll, const log4cplus::tstring_view& message,
     const char* file, int line, const char* function) const
@@ -282,6 +296,19 @@ Logger::callAppenders (const spi::InternalLoggingEvent& event) const
 }
 
 
+void
+Logger::logBatch (spi::InternalLoggingEvent const * events,
+    std::size_t count) const
+{
+    std::vector<spi::InternalLoggingEvent const *> batch;
+    batch.reserve (count);
+    for (std::size_t i = 0; i != count; ++i)
+        batch.push_back (&events[i]);
+
+    value->callAppendersBatch (batch.data (), batch.size ());
+}
+
+
 LogLevel
 Logger::getChainedLogLevel () const
 {
@@ -303,6 +330,27 @@ Logger::setLogLevel (LogLevel ll)
 }
 
 
+std::size_t
+Logger::getChainedMaxMessageSize () const
+{
+    return value->getChainedMaxMessageSize ();
+}
+
+
+std::size_t
+Logger::getMaxMessageSize () const
+{
+    return value->getMaxMessageSize ();
+}
+
+
+void
+Logger::setMaxMessageSize (std::size_t size)
+{
+    value->setMaxMessageSize (size);
+}
+
+
 Hierarchy &
 Logger::getHierarchy () const
 {
@@ -26,6 +26,19 @@
 #include <log4cplus/spi/loggingevent.h>
 #include <log4cplus/spi/rootlogger.h>
 #include <log4cplus/thread/syncprims-pub-impl.h>
+#include <algorithm>
+#include <limits>
+
+#if defined (LOG4CPLUS_WITH_UNIT_TESTS)
+#include <log4cplus/logger.h>
+#include <log4cplus/layout.h>
+#include <log4cplus/loggingmacros.h>
+#include <log4cplus/helpers/property.h>
+#include <log4cplus/spi/filter.h>
+#include <catch.hpp>
+#include <chrono>
+#include <thread>
+#endif
 
 
 namespace log4cplus::spi {
@@ -38,7 +51,13 @@ LoggerImpl::LoggerImpl(const log4cplus::tstring_view& name_, Hierarchy& h)
     ll(NOT_SET_LOG_LEVEL),
     parent(nullptr),
     additive(true),
-    hierarchy(h)
+    maxMessageSize(0),
+    hierarchy(h),
+    effective_appenders_generation(0),
+    effective_appenders_app_generation(0),
+    lowest_accepted_log_level(NOT_SET_LOG_LEVEL),
+    effective_log_level(NOT_SET_LOG_LEVEL),
+    effective_max_message_size(0)
 {
 }
 
@@ -50,19 +69,125 @@ LoggerImpl::~LoggerImpl() = default;
 // Logger Methods
 //////////////////////////////////////////////////////////////////////////////
 
+namespace
+{
+
+//! Marker appended to truncated messages.
+static tchar const truncation_marker[] = LOG4CPLUS_TEXT ("...[truncated]");
+
+
+//! Copies at most <code>max_size</code> characters of <code>message</code>
+//! into <code>buf</code>, including truncation marker.
+static
+tstring_view
+truncateMessage (tstring & buf, tstring_view message, std::size_t max_size)
+{
+    std::size_t const marker_size
+        = sizeof (truncation_marker) / sizeof (tchar) - 1;
+    std::size_t cut = max_size > marker_size ? max_size - marker_size : 0;
+
+#if ! defined (UNICODE)
+    // Do not split UTF-8 multi-byte sequences.
+    while (cut != 0
+        && (static_cast<unsigned char>(message[cut]) & 0xC0) == 0x80)
+        --cut;
+#endif
+
+    buf.assign (message.data (), cut);
+    buf.append (truncation_marker, (std::min) (marker_size, max_size));
+    return buf;
+}
+
+
+//! Enables sharing of layout output and of asynchronous event copies among
+//! appenders for the duration of dispatch of one event. Nested dispatches
+//! do not share.
+struct dispatch_cache_guard
+{
+    dispatch_cache_guard (InternalLoggingEvent const & event,
+        std::vector<tstring> const & shared_fingerprints)
+        : cache (internal::get_dispatch_cache ())
+        , active (! cache.event)
+    {
+        if (active)
+        {
+            cache.event = &event;
+            cache.shared_fingerprints = &shared_fingerprints;
+            cache.size = 0;
+        }
+    }
+
+    ~dispatch_cache_guard ()
+    {
+        if (active)
+        {
+            cache.event = nullptr;
+            cache.shared_fingerprints = nullptr;
+            cache.shared_event.reset ();
+        }
+    }
+
+    internal::dispatch_cache & cache;
+    bool const active;
+};
+
+} // namespace
+
+
+struct LoggerImpl::EffectiveAppenders
+{
+    SharedAppenderPtrList list;
+    std::shared_ptr<Hierarchy::ConfigurationEpoch> epoch;
+    //! Non-empty layout fingerprints appearing more than once in `list`.
+    std::vector<tstring> sharedLayoutFingerprints;
+};
+
+
 void
 LoggerImpl::callAppenders(const InternalLoggingEvent& event)
 {
-    int writes = 0;
-    for(const LoggerImpl* c = this; c != nullptr; c=c->parent.get()) {
-        writes += c->appendLoopOnAppenders(event);
-        if(!c->additive) {
-            break;
-        }
+    // The list is taken before the thread is marked as dispatching, so
+    // that it is held back by HierarchyLocker.
+    std::shared_ptr<EffectiveAppenders const> const state
+        = getEffectiveState();
+    SharedAppenderPtrList const & appenders = state->list;
+    Hierarchy::DispatchGuard gate (hierarchy);
+    if (appenders.size() > 1)
+    {
+        dispatch_cache_guard guard (event, state->sharedLayoutFingerprints);
+        for (auto & appender : appenders)
+            appender->doAppend(event);
     }
+    else
+        for (auto & appender : appenders)
+            appender->doAppend(event);
+
+    checkNoAppenders(appenders);
+}
+
 
+void
+LoggerImpl::callAppendersBatch(InternalLoggingEvent const * const * events,
+    std::size_t count)
+{
+    if (count == 0)
+        return;
+
+    std::shared_ptr<SharedAppenderPtrList const> const appenders
+        = getEffectiveAppenders();
+    Hierarchy::DispatchGuard gate (hierarchy);
+    for (auto & appender : *appenders)
+        appender->doAppendBatch(events, count);
+
+    checkNoAppenders(*appenders);
+}
+
+
+void
+LoggerImpl::checkNoAppenders(SharedAppenderPtrList const & appenders)
+{
     // No appenders in hierarchy, warn user only once.
-    if(!hierarchy.emittedNoAppenderWarning && writes == 0) {
+    if(!hierarchy.emittedNoAppenderWarning && appenders.empty()) {
         helpers::getLogLog().error(
             LOG4CPLUS_TEXT("No appenders could be found for logger (")
             + getName()
@@ -74,6 +199,242 @@ LoggerImpl::callAppenders(const InternalLoggingEvent& event)
 }
 
 
+std::shared_ptr<SharedAppenderPtrList const>
+LoggerImpl::getEffectiveAppenders() const
+{
+    std::shared_ptr<EffectiveAppenders const> state = getEffectiveState();
+    return std::shared_ptr<SharedAppenderPtrList const>(state, &state->list);
+}
+
+
+std::shared_ptr<LoggerImpl::EffectiveAppenders const>
+LoggerImpl::getEffectiveState() const
+{
+    unsigned const generation = hierarchy.getConfigurationGeneration();
+    unsigned const app_generation = internal::getAppenderConfigGeneration();
+
+    if (LOG4CPLUS_LIKELY (
+            isEffectiveStateFresh(generation, app_generation)))
+    {
+        std::shared_ptr<EffectiveAppenders const> list
+            = std::atomic_load(&effective_appenders);
+        if (LOG4CPLUS_LIKELY (list != nullptr))
+            return list;
+    }
+
+    EffectiveState state;
+    buildEffectiveState(generation, app_generation, true, state);
+    return std::move(state.appenders);
+}
+
+
+LogLevel
+LoggerImpl::getLowestAcceptedLogLevel() const
+{
+    EffectiveState state;
+    if (refreshEffectiveState(state))
+        return state.lowestAcceptedLogLevel;
+
+    return lowest_accepted_log_level.load(std::memory_order_relaxed);
+}
+
+
+bool
+LoggerImpl::isEffectiveStateFresh(unsigned generation,
+    unsigned app_generation) const
+{
+    return effective_appenders_generation.load(std::memory_order_acquire)
+            == generation
+        && effective_appenders_app_generation.load(
+            std::memory_order_acquire) == app_generation;
+}
+
+
+bool
+LoggerImpl::refreshEffectiveState(EffectiveState & state) const
+{
+    unsigned const generation = hierarchy.getConfigurationGeneration();
+    unsigned const app_generation = internal::getAppenderConfigGeneration();
+
+    if (LOG4CPLUS_LIKELY (
+            isEffectiveStateFresh(generation, app_generation)))
+        return false;
+
+    if (! buildEffectiveState(generation, app_generation, false, state))
+    {
+        // Appender lists cannot be built while a HierarchyLocker holds
+        // the hierarchy. Level checks do not wait for it; they use the
+        // assigned log levels only.
+        state.lowestAcceptedLogLevel
+            = (std::numeric_limits<LogLevel>::min) ();
+        state.logLevel = getChainedLogLevel();
+        state.maxMessageSize = findChainedMaxMessageSize();
+    }
+
+    return true;
+}
+
+
+void
+LoggerImpl::resetEffectiveAppenders()
+{
+    thread::MutexGuard guard (effective_appenders_mutex);
+    std::atomic_store(&effective_appenders,
+        std::shared_ptr<EffectiveAppenders const>());
+}
+
+
+std::size_t
+LoggerImpl::findChainedMaxMessageSize() const
+{
+    for(const LoggerImpl *c=this; c != nullptr; c=c->parent.get()) {
+        std::size_t const c_size
+            = c->maxMessageSize.load(std::memory_order_relaxed);
+        if(c_size != 0) {
+            return c_size;
+        }
+    }
+
+    return 0;
+}
+
+
+bool
+LoggerImpl::buildEffectiveState(unsigned generation,
+    unsigned app_generation, bool wait, EffectiveState & state) const
+{
+    // The list keeps the configuration epoch alive, so that appenders
+    // replaced by Hierarchy::publishConfiguration() are not closed while
+    // it is in use. The epoch has to be taken before the appenders; a
+    // list taken in the new epoch then never holds replaced appenders.
+    auto holder = std::make_shared<EffectiveAppenders>();
+    bool held;
+    for (;;)
+    {
+        holder->epoch = hierarchy.getConfigurationEpoch();
+        held = hierarchy.dispatchHeld.load();
+        if (! held || hierarchy.isDispatchingThread())
+            break;
+
+        // A HierarchyLocker is being acquired or is held. The epoch must
+        // not be kept while waiting, it is waited for by the locker.
+        holder->epoch.reset();
+        if (! wait)
+            return false;
+
+        hierarchy.dispatchReleased.wait();
+        generation = hierarchy.getConfigurationGeneration();
+        app_generation = internal::getAppenderConfigGeneration();
+    }
+
+    // The list is built without effective_appenders_mutex, which would
+    // otherwise be held while appender_list_mutex of each ancestor is
+    // locked.
+    SharedAppenderPtrList * const list = &holder->list;
+    for(LoggerImpl* c = const_cast<LoggerImpl *>(this); c != nullptr;
+        c = c->parent.get())
+    {
+        for (auto & appender : c->getAllAppenders())
+        {
+            if (std::find(list->begin(), list->end(), appender)
+                == list->end())
+                list->push_back(appender);
+        }
+
+        if(!c->additive.load(std::memory_order_relaxed)) {
+            break;
+        }
+    }
+
+    LogLevel lowest = (std::numeric_limits<LogLevel>::min) ();
+    if (! list->empty())
+    {
+        lowest = (std::numeric_limits<LogLevel>::max) ();
+        for (auto const & appender : *list)
+            lowest = (std::min) (lowest, appender->getLowestAcceptedLogLevel());
+    }
+
+    // Layout output is cached during dispatch only for fingerprints which
+    // more than one appender uses; the others format directly.
+    std::vector<tstring> fingerprints;
+    if (list->size() > 1)
+    {
+        fingerprints.reserve(list->size());
+        for (auto const & appender : *list)
+        {
+            tstring fp = appender->getLayoutFingerprint();
+            if (fp.empty())
+                continue;
+
+            if (std::find(fingerprints.begin(), fingerprints.end(), fp)
+                == fingerprints.end())
+                fingerprints.push_back(std::move(fp));
+            else if (std::find(holder->sharedLayoutFingerprints.begin(),
+                    holder->sharedLayoutFingerprints.end(), fp)
+                == holder->sharedLayoutFingerprints.end())
+                holder->sharedLayoutFingerprints.push_back(std::move(fp));
+        }
+    }
+
+    state.appenders = std::move(holder);
+    state.lowestAcceptedLogLevel = lowest;
+    state.logLevel = getChainedLogLevel();
+    state.maxMessageSize = findChainedMaxMessageSize();
+
+    // Lists taken while the hierarchy is held or in an epoch which has
+    // ended already are used only by the calling thread. Caching them
+    // would let other threads pass a HierarchyLocker or keep the old
+    // epoch alive.
+    thread::MutexGuard guard (effective_appenders_mutex);
+    if (held || hierarchy.getConfigurationEpoch() != state.appenders->epoch)
+        return true;
+
+    std::atomic_store(&effective_appenders, state.appenders);
+    lowest_accepted_log_level.store(state.lowestAcceptedLogLevel,
+        std::memory_order_relaxed);
+    effective_log_level.store(state.logLevel, std::memory_order_relaxed);
+    effective_max_message_size.store(state.maxMessageSize,
+        std::memory_order_relaxed);
+    effective_appenders_generation.store(generation,
+        std::memory_order_release);
+    effective_appenders_app_generation.store(app_generation,
+        std::memory_order_release);
+    return true;
+}
+
+
+void
+LoggerImpl::addAppender(SharedAppenderPtr newAppender)
+{
+    helpers::AppenderAttachableImpl::addAppender(std::move(newAppender));
+    hierarchy.bumpConfigurationGeneration();
+}
+
+
+void
+LoggerImpl::removeAllAppenders()
+{
+    helpers::AppenderAttachableImpl::removeAllAppenders();
+    hierarchy.bumpConfigurationGeneration();
+}
+
+
+void
+LoggerImpl::removeAppender(SharedAppenderPtr appender)
+{
+    helpers::AppenderAttachableImpl::removeAppender(std::move(appender));
+    hierarchy.bumpConfigurationGeneration();
+}
+
+
+void
+LoggerImpl::removeAppender(const log4cplus::tstring& appenderName)
+{
+    helpers::AppenderAttachableImpl::removeAppender(appenderName);
+    hierarchy.bumpConfigurationGeneration();
+}
+
+
 void
 LoggerImpl::closeNestedAppenders()
 {
@@ -90,10 +451,51 @@ LoggerImpl::closeNestedAppenders()
 bool
 LoggerImpl::isEnabledFor(LogLevel loglevel) const
 {
-    if(hierarchy.disableValue >= loglevel) {
-        return false;
+    auto const check = [this, loglevel]
+    {
+        if(hierarchy.disableValue >= loglevel) {
+            return false;
+        }
+        EffectiveState state;
+        if (refreshEffectiveState(state))
+            return loglevel >= state.logLevel
+                && loglevel >= state.lowestAcceptedLogLevel;
+
+        return loglevel >= effective_log_level.load(std::memory_order_relaxed)
+            && loglevel >= lowest_accepted_log_level.load(
+                std::memory_order_relaxed);
+    };
+
+#if defined (LOG4CPLUS_ENABLE_STAGE_PROFILER) \
+    || defined (LOG4CPLUS_ENABLE_CALLSITE_PROFILER)
+    internal::per_thread_data * ptd = internal::get_ptd();
+#endif
+
+#if defined (LOG4CPLUS_ENABLE_STAGE_PROFILER)
+    internal::stage_profiler_data & prof = ptd->profiler;
+    if (LOG4CPLUS_UNLIKELY (prof.start_event ()))
+    {
+        std::uint64_t const start = internal::profiler_ticks ();
+        bool const enabled = check ();
+        prof.mark = prof.lap_logger (name, internal::STAGE_ENABLED_CHECK,
+            start);
+        prof.sampling = enabled;
+#  if defined (LOG4CPLUS_ENABLE_CALLSITE_PROFILER)
+        if (enabled)
+            ptd->callsites.mark = prof.mark;
+#  endif
+        return enabled;
     }
-    return loglevel >= getChainedLogLevel();
+#endif
+
+#if defined (LOG4CPLUS_ENABLE_CALLSITE_PROFILER)
+    bool const enabled = check ();
+    if (enabled)
+        ptd->callsites.mark = internal::profiler_ticks ();
+    return enabled;
+#else
+    return check ();
+#endif
 }
 
 
@@ -122,8 +524,9 @@ LogLevel
 LoggerImpl::getChainedLogLevel() const
 {
     for(const LoggerImpl *c=this; c != nullptr; c=c->parent.get()) {
-        if(c->ll != NOT_SET_LOG_LEVEL) {
-            return c->ll;
+        LogLevel const c_ll = c->ll.load(std::memory_order_relaxed);
+        if(c_ll != NOT_SET_LOG_LEVEL) {
+            return c_ll;
         }
     }
 
@@ -134,6 +537,25 @@ LoggerImpl::getChainedLogLevel() const
 }
 
 
+std::size_t
+LoggerImpl::getChainedMaxMessageSize() const
+{
+    EffectiveState state;
+    if (refreshEffectiveState(state))
+        return state.maxMessageSize;
+
+    return effective_max_message_size.load(std::memory_order_relaxed);
+}
+
+
+void
+LoggerImpl::setMaxMessageSize(std::size_t size)
+{
+    maxMessageSize.store(size, std::memory_order_relaxed);
+    hierarchy.bumpConfigurationGeneration();
+}
+
+
 Hierarchy&
 LoggerImpl::getHierarchy() const
 {
@@ -141,17 +563,26 @@ LoggerImpl::getHierarchy() const
 }
 
 
+void
+LoggerImpl::setLogLevel(LogLevel _ll)
+{
+    ll.store(_ll, std::memory_order_relaxed);
+    hierarchy.bumpConfigurationGeneration();
+}
+
+
 bool
 LoggerImpl::getAdditivity() const
 {
-    return additive;
+    return additive.load(std::memory_order_relaxed);
 }
 
 
 void
 LoggerImpl::setAdditivity(bool additive_)
 {
-    additive = additive_;
+    additive.store(additive_, std::memory_order_relaxed);
+    hierarchy.bumpConfigurationGeneration();
 }
 
 
@@ -162,11 +593,69 @@ LoggerImpl::forcedLog(LogLevel loglevel,
                       int line,
                       const char* function)
 {
-    spi::InternalLoggingEvent & ev = internal::get_ptd ()->forced_log_ev;
-    assert (function);
-    ev.setLoggingEvent (this->getName(), loglevel, message, file, line,
+    forcedLogBinary(loglevel, message, std::string_view(), file, line,
         function);
+}
+
+
+void
+LoggerImpl::forcedLogBinary(LogLevel loglevel,
+                            const log4cplus::tstring_view& message,
+                            std::string_view payload,
+                            const char* file,
+                            int line,
+                            const char* function)
+{
+    internal::per_thread_data * ptd = internal::get_ptd ();
+    spi::InternalLoggingEvent & ev = ptd->forced_log_ev;
+    assert (function);
+
+#if defined (LOG4CPLUS_ENABLE_CALLSITE_PROFILER)
+    internal::callsite_profiler_data & sites = ptd->callsites;
+    std::uint64_t const build_ticks
+        = sites.mark ? internal::profiler_ticks () - sites.mark : 0;
+    sites.mark = 0;
+    sites.layout_ticks = 0;
+#endif
+
+#if defined (LOG4CPLUS_ENABLE_STAGE_PROFILER)
+    internal::stage_profiler_data & prof = ptd->profiler;
+    std::uint64_t stamp = 0;
+    if (prof.sampling)
+        stamp = prof.lap_logger (name, internal::STAGE_MESSAGE_BUILD,
+            prof.mark);
+#endif
+
+    std::size_t const max_size = getChainedMaxMessageSize();
+    if (LOG4CPLUS_UNLIKELY (max_size != 0 && message.size() > max_size))
+    {
+        ev.setLoggingEvent (this->getName(), loglevel,
+            truncateMessage (ptd->truncated_message, message, max_size),
+            file, line, function);
+        hierarchy.truncatedMessages.fetch_add(1, std::memory_order_relaxed);
+    }
+    else
+        ev.setLoggingEvent (this->getName(), loglevel, message, file, line,
+            function);
+
+    if (! payload.empty ())
+        ev.borrowPayload (payload.data (), payload.size ());
+
+#if defined (LOG4CPLUS_ENABLE_STAGE_PROFILER)
+    if (prof.sampling)
+        prof.lap_logger (name, internal::STAGE_EVENT_CONSTRUCTION, stamp);
+#endif
+
     callAppenders(ev);
+
+#if defined (LOG4CPLUS_ENABLE_STAGE_PROFILER)
+    prof.sampling = false;
+#endif
+
+#if defined (LOG4CPLUS_ENABLE_CALLSITE_PROFILER)
+    sites.record (internal::callsite_key (file ? file : function, line),
+        message.size () * sizeof (tchar), build_ticks + sites.layout_ticks);
+#endif
 }
 
 
@@ -174,7 +663,347 @@ void
 LoggerImpl::forcedLog(spi::InternalLoggingEvent const & ev)
 {
     callAppenders(ev);
+
+#if defined (LOG4CPLUS_ENABLE_STAGE_PROFILER)
+    internal::get_ptd()->profiler.sampling = false;
+#endif
 }
 
 
+#if defined (LOG4CPLUS_WITH_UNIT_TESTS)
+namespace
+{
+
+class CountingAppender
+    : public Appender
+{
+public:
+    CountingAppender ()
+        : count (0)
+        , closes (0)
+    { }
+
+    virtual ~CountingAppender ()
+    {
+        destructorImpl ();
+    }
+
+    virtual void close ()
+    {
+        ++closes;
+    }
+
+    int count;
+
+    std::atomic<int> closes;
+
+    tostringstream output;
+
+protected:
+    virtual void append (const InternalLoggingEvent & event)
+    {
+        ++count;
+        formatAndAppend (output, event);
+    }
+};
+
+
+class CountingLayout
+    : public Layout
+{
+public:
+    explicit CountingLayout (tstring const & fp)
+        : count (0)
+        , stream (nullptr)
+    {
+        fingerprint = fp;
+    }
+
+    virtual void formatAndAppend (tostream & os,
+        const InternalLoggingEvent & event)
+    {
+        ++count;
+        stream = &os;
+        os << event.getMessage ();
+    }
+
+    int count;
+    tostream * stream;
+};
+
+
+LoggerImpl *
+getImpl (Logger const & logger)
+{
+    struct Access
+        : Logger
+    {
+        static LoggerImpl * Logger::*
+        member ()
+        {
+            return &Access::value;
+        }
+    };
+
+    return logger.*Access::member ();
+}
+
+} // namespace
+
+
+CATCH_TEST_CASE ("LoggerImpl", "[logger]")
+{
+    Hierarchy h;
+    Logger root = h.getRoot ();
+    Logger child = h.getInstance (LOG4CPLUS_TEXT ("a.b"));
+    helpers::SharedObjectPtr<CountingAppender> app (new CountingAppender);
+    SharedAppenderPtr app_base (app.get ());
+
+    CATCH_SECTION ("appender reached through parent")
+    {
+        root.addAppender (app_base);
+        child.forcedLog (INFO_LOG_LEVEL, LOG4CPLUS_TEXT ("msg"));
+        CATCH_REQUIRE (app->count == 1);
+    }
+
+    CATCH_SECTION ("appender attached twice is called once")
+    {
+        root.addAppender (app_base);
+        child.addAppender (app_base);
+        child.forcedLog (INFO_LOG_LEVEL, LOG4CPLUS_TEXT ("msg"));
+        CATCH_REQUIRE (app->count == 1);
+    }
+
+    CATCH_SECTION ("additivity change is picked up")
+    {
+        root.addAppender (app_base);
+        child.forcedLog (INFO_LOG_LEVEL, LOG4CPLUS_TEXT ("msg"));
+        child.setAdditivity (false);
+        child.forcedLog (INFO_LOG_LEVEL, LOG4CPLUS_TEXT ("msg"));
+        CATCH_REQUIRE (app->count == 1);
+    }
+
+    CATCH_SECTION ("intermediate logger created later is picked up")
+    {
+        child.forcedLog (INFO_LOG_LEVEL, LOG4CPLUS_TEXT ("msg"));
+        Logger parent = h.getInstance (LOG4CPLUS_TEXT ("a"));
+        parent.addAppender (app_base);
+        child.forcedLog (INFO_LOG_LEVEL, LOG4CPLUS_TEXT ("msg"));
+        CATCH_REQUIRE (app->count == 1);
+    }
+
+    CATCH_SECTION ("appender thresholds limit enabled levels")
+    {
+        CATCH_REQUIRE (child.isEnabledFor (DEBUG_LOG_LEVEL));
+        app->setThreshold (WARN_LOG_LEVEL);
+        root.addAppender (app_base);
+        CATCH_REQUIRE (! child.isEnabledFor (INFO_LOG_LEVEL));
+        CATCH_REQUIRE (child.isEnabledFor (WARN_LOG_LEVEL));
+        app->setThreshold (INFO_LOG_LEVEL);
+        CATCH_REQUIRE (child.isEnabledFor (INFO_LOG_LEVEL));
+    }
+
+    CATCH_SECTION ("chained log level change is picked up")
+    {
+        Logger parent = h.getInstance (LOG4CPLUS_TEXT ("a"));
+        root.addAppender (app_base);
+        CATCH_REQUIRE (child.isEnabledFor (DEBUG_LOG_LEVEL));
+        parent.setLogLevel (ERROR_LOG_LEVEL);
+        CATCH_REQUIRE (! child.isEnabledFor (WARN_LOG_LEVEL));
+        child.setLogLevel (INFO_LOG_LEVEL);
+        CATCH_REQUIRE (child.isEnabledFor (INFO_LOG_LEVEL));
+        child.setLogLevel (NOT_SET_LOG_LEVEL);
+        CATCH_REQUIRE (! child.isEnabledFor (INFO_LOG_LEVEL));
+    }
+
+    CATCH_SECTION ("published configuration replaces old one")
+    {
+        root.addAppender (app_base);
+        child.setAdditivity (false);
+        child.forcedLog (INFO_LOG_LEVEL, LOG4CPLUS_TEXT ("msg"));
+        CATCH_REQUIRE (app->count == 0);
+
+        Hierarchy staged;
+        helpers::SharedObjectPtr<CountingAppender> app2 (
+            new CountingAppender);
+        staged.getRoot ().addAppender (SharedAppenderPtr (app2.get ()));
+        staged.getInstance (LOG4CPLUS_TEXT ("a.b"))
+            .setLogLevel (WARN_LOG_LEVEL);
+        h.publishConfiguration (staged);
+
+        CATCH_REQUIRE (staged.getRoot ().getAllAppenders ().empty ());
+        CATCH_REQUIRE (child.getAdditivity ());
+        CATCH_REQUIRE (! child.isEnabledFor (INFO_LOG_LEVEL));
+        child.forcedLog (WARN_LOG_LEVEL, LOG4CPLUS_TEXT ("msg"));
+        CATCH_REQUIRE (app->count == 0);
+        CATCH_REQUIRE (app2->count == 1);
+    }
+
+    CATCH_SECTION ("replaced appender is closed when no longer used")
+    {
+        root.addAppender (app_base);
+        std::shared_ptr<SharedAppenderPtrList const> in_use
+            = getImpl (root)->getEffectiveAppenders ();
+
+        Hierarchy staged;
+        h.publishConfiguration (staged);
+        std::this_thread::sleep_for (std::chrono::milliseconds (50));
+        CATCH_REQUIRE (app->closes == 0);
+
+        in_use.reset ();
+        for (int i = 0; i != 500 && app->closes == 0; ++i)
+            std::this_thread::sleep_for (std::chrono::milliseconds (10));
+        CATCH_REQUIRE (app->closes == 1);
+    }
+
+    CATCH_SECTION ("lazy macros call callable only when enabled")
+    {
+        int calls = 0;
+        auto const dump = [&calls]
+        {
+            ++calls;
+            return tstring (LOG4CPLUS_TEXT ("dump"));
+        };
+        app->setThreshold (INFO_LOG_LEVEL);
+        root.addAppender (app_base);
+        LOG4CPLUS_DEBUG_LAZY (child, dump);
+        CATCH_REQUIRE (calls == 0);
+        LOG4CPLUS_INFO_LAZY (child, dump);
+        CATCH_REQUIRE (calls == 1);
+        LOG4CPLUS_WARN_LAZY (child, [&calls] { return ++calls; });
+        CATCH_REQUIRE (calls == 2);
+        CATCH_REQUIRE (app->output.str ()
+            == LOG4CPLUS_TEXT ("INFO - dump\nWARN - 2\n"));
+    }
+
+    CATCH_SECTION ("log level filters limit enabled levels")
+    {
+        root.addAppender (app_base);
+        helpers::Properties props;
+        props.setProperty (LOG4CPLUS_TEXT ("LogLevelMin"),
+            LOG4CPLUS_TEXT ("ERROR"));
+        props.setProperty (LOG4CPLUS_TEXT ("AcceptOnMatch"),
+            LOG4CPLUS_TEXT ("false"));
+        app->addFilter (FilterPtr (new LogLevelRangeFilter (props)));
+        CATCH_REQUIRE (! child.isEnabledFor (WARN_LOG_LEVEL));
+        CATCH_REQUIRE (child.isEnabledFor (ERROR_LOG_LEVEL));
+
+        app->addFilter (FilterPtr (new StringMatchFilter));
+        CATCH_REQUIRE (! child.isEnabledFor (WARN_LOG_LEVEL));
+    }
+
+    CATCH_SECTION ("equivalent layouts format event once")
+    {
+        helpers::SharedObjectPtr<CountingAppender> app2 (
+            new CountingAppender);
+        auto layout1 = new CountingLayout (LOG4CPLUS_TEXT ("fp"));
+        auto layout2 = new CountingLayout (LOG4CPLUS_TEXT ("fp"));
+        app->setLayout (std::unique_ptr<Layout> (layout1));
+        app2->setLayout (std::unique_ptr<Layout> (layout2));
+        root.addAppender (app_base);
+        child.addAppender (SharedAppenderPtr (app2.get ()));
+        child.forcedLog (INFO_LOG_LEVEL, LOG4CPLUS_TEXT ("msg"));
+        CATCH_REQUIRE (layout1->count + layout2->count == 1);
+        CATCH_REQUIRE (app->output.str () == LOG4CPLUS_TEXT ("msg"));
+        CATCH_REQUIRE (app2->output.str () == LOG4CPLUS_TEXT ("msg"));
+    }
+
+    CATCH_SECTION ("distinct layouts format directly")
+    {
+        helpers::SharedObjectPtr<CountingAppender> app2 (
+            new CountingAppender);
+        auto layout1 = new CountingLayout (LOG4CPLUS_TEXT ("fp1"));
+        auto layout2 = new CountingLayout (LOG4CPLUS_TEXT ("fp2"));
+        app->setLayout (std::unique_ptr<Layout> (layout1));
+        app2->setLayout (std::unique_ptr<Layout> (layout2));
+        root.addAppender (app_base);
+        child.addAppender (SharedAppenderPtr (app2.get ()));
+        child.forcedLog (INFO_LOG_LEVEL, LOG4CPLUS_TEXT ("msg"));
+        CATCH_REQUIRE (layout1->stream == &app->output);
+        CATCH_REQUIRE (layout2->stream == &app2->output);
+    }
+
+    CATCH_SECTION ("layouts without fingerprint are not shared")
+    {
+        helpers::SharedObjectPtr<CountingAppender> app2 (
+            new CountingAppender);
+        auto layout1 = new CountingLayout (tstring ());
+        auto layout2 = new CountingLayout (tstring ());
+        app->setLayout (std::unique_ptr<Layout> (layout1));
+        app2->setLayout (std::unique_ptr<Layout> (layout2));
+        root.addAppender (app_base);
+        child.addAppender (SharedAppenderPtr (app2.get ()));
+        child.forcedLog (INFO_LOG_LEVEL, LOG4CPLUS_TEXT ("msg"));
+        CATCH_REQUIRE (layout1->count == 1);
+        CATCH_REQUIRE (layout2->count == 1);
+    }
+
+    CATCH_SECTION ("long messages are truncated")
+    {
+        app->setLayout (std::unique_ptr<Layout> (new CountingLayout (
+            tstring ())));
+        root.addAppender (app_base);
+        root.setMaxMessageSize (20);
+        CATCH_REQUIRE (child.getMaxMessageSize () == 0);
+        CATCH_REQUIRE (child.getChainedMaxMessageSize () == 20);
+
+        child.forcedLog (INFO_LOG_LEVEL, LOG4CPLUS_TEXT ("short"));
+        CATCH_REQUIRE (app->output.str () == LOG4CPLUS_TEXT ("short"));
+        CATCH_REQUIRE (h.getTruncatedMessageCount () == 0);
+
+        app->output.str (tstring ());
+        child.forcedLog (INFO_LOG_LEVEL, tstring (100, LOG4CPLUS_TEXT ('a')));
+        CATCH_REQUIRE (app->output.str ()
+            == LOG4CPLUS_TEXT ("aaaaaa...[truncated]"));
+        CATCH_REQUIRE (h.getTruncatedMessageCount () == 1);
+
+        app->output.str (tstring ());
+        tstring const long_str (100, LOG4CPLUS_TEXT ('b'));
+        LOG4CPLUS_INFO_FMT (child, LOG4CPLUS_TEXT ("%s"), long_str.c_str ());
+        CATCH_REQUIRE (app->output.str ()
+            == LOG4CPLUS_TEXT ("bbbbbb...[truncated]"));
+        CATCH_REQUIRE (h.getTruncatedMessageCount () == 2);
+
+        app->output.str (tstring ());
+        child.setMaxMessageSize (200);
+        child.forcedLog (INFO_LOG_LEVEL, tstring (100, LOG4CPLUS_TEXT ('a')));
+        CATCH_REQUIRE (app->output.str ().size () == 100);
+    }
+
+    CATCH_SECTION ("batches are routed by logger name in order")
+    {
+        helpers::SharedObjectPtr<CountingAppender> app2 (
+            new CountingAppender);
+        app->setLayout (std::unique_ptr<Layout> (new CountingLayout (
+            tstring ())));
+        app2->setLayout (std::unique_ptr<Layout> (new CountingLayout (
+            tstring ())));
+        app2->setThreshold (WARN_LOG_LEVEL);
+        root.addAppender (app_base);
+        child.addAppender (SharedAppenderPtr (app2.get ()));
+
+        InternalLoggingEvent const events[] = {
+            {LOG4CPLUS_TEXT ("a.b"), WARN_LOG_LEVEL, LOG4CPLUS_TEXT ("1"),
+                __FILE__, __LINE__},
+            {LOG4CPLUS_TEXT ("x"), ERROR_LOG_LEVEL, LOG4CPLUS_TEXT ("2"),
+                __FILE__, __LINE__},
+            {LOG4CPLUS_TEXT ("a.b"), INFO_LOG_LEVEL, LOG4CPLUS_TEXT ("3"),
+                __FILE__, __LINE__},
+            {LOG4CPLUS_TEXT ("a.b"), ERROR_LOG_LEVEL, LOG4CPLUS_TEXT ("4"),
+                __FILE__, __LINE__}};
+        h.logBatch (events, 4);
+        CATCH_REQUIRE (app->output.str () == LOG4CPLUS_TEXT ("1234"));
+        CATCH_REQUIRE (app2->output.str () == LOG4CPLUS_TEXT ("14"));
+
+        child.logBatch (events, 3);
+        CATCH_REQUIRE (app->count == 7);
+        CATCH_REQUIRE (app2->output.str () == LOG4CPLUS_TEXT ("1412"));
+    }
+
+    h.shutdown ();
+}
+
+#endif
+
+
 } // namespace log4cplus::spi
@@ -22,6 +22,12 @@
 #include <log4cplus/internal/internal.h>
 #include <algorithm>
 
+#if defined (LOG4CPLUS_WITH_UNIT_TESTS)
+#include <log4cplus/ndc.h>
+#include <log4cplus/helpers/queue.h>
+#include <catch.hpp>
+#endif
+
 
 namespace log4cplus::spi {
 
@@ -48,6 +54,7 @@ InternalLoggingEvent::InternalLoggingEvent(
         ? LOG4CPLUS_C_STR_TO_TSTRING(function_)
         : log4cplus::tstring())
     , line(line_)
+    , payloadBorrowed(false)
     , threadCached(false)
     , thread2Cached(false)
     , ndcCached(false)
@@ -77,6 +84,7 @@ InternalLoggingEvent::InternalLoggingEvent(
         ? function_
         : log4cplus::tstring())
     , line(line_)
+    , payloadBorrowed(false)
     , threadCached(true)
     , thread2Cached(true)
     , ndcCached(true)
@@ -108,6 +116,7 @@ InternalLoggingEvent::InternalLoggingEvent(
         ? function_
         : log4cplus::tstring())
     , line(line_)
+    , payloadBorrowed(false)
     , threadCached(true)
     , thread2Cached(true)
     , ndcCached(true)
@@ -119,6 +128,7 @@ InternalLoggingEvent::InternalLoggingEvent(
 InternalLoggingEvent::InternalLoggingEvent ()
     : ll (NOT_SET_LOG_LEVEL)
     , line (0)
+    , payloadBorrowed (false)
     , threadCached(false)
     , thread2Cached(false)
     , ndcCached(false)
@@ -139,11 +149,40 @@ InternalLoggingEvent::InternalLoggingEvent(
     , file(rhs.getFile())
     , function(rhs.getFunction())
     , line(rhs.getLine())
+    , payload(rhs.getPayload())
+    , payloadBorrowed(false)
+    , threadCached(true)
+    , thread2Cached(true)
+    , ndcCached(true)
+    , mdcCached(true)
+{
+}
+
+
+InternalLoggingEvent::InternalLoggingEvent(
+    const log4cplus::spi::InternalLoggingEvent& rhs, unsigned fields)
+    : message(rhs.getMessage())
+    , loggerName(rhs.getLoggerName())
+    , ll(rhs.getLogLevel())
+    , timestamp(rhs.getTimestamp())
+    , file(rhs.getFile())
+    , function(rhs.getFunction())
+    , line(rhs.getLine())
+    , payload(rhs.getPayload())
+    , payloadBorrowed(false)
     , threadCached(true)
     , thread2Cached(true)
     , ndcCached(true)
     , mdcCached(true)
 {
+    if (fields & TSD_NDC)
+        ndc = rhs.getNDC ();
+    if (fields & TSD_MDC)
+        mdc = rhs.getMDCCopy ();
+    if (fields & TSD_THREAD)
+        thread = rhs.getThread ();
+    if (fields & TSD_THREAD2)
+        thread2 = rhs.getThread2 ();
 }
 
 
@@ -195,6 +234,9 @@ InternalLoggingEvent::setLoggingEvent (const log4cplus::tstring_view & logger,
         function.clear ();
 
     line = fline;
+    payload.clear ();
+    payloadView = std::string_view ();
+    payloadBorrowed = false;
     threadCached = false;
     thread2Cached = false;
     ndcCached = false;
@@ -222,6 +264,24 @@ InternalLoggingEvent::setFunction (log4cplus::tstring_view const & func)
 }
 
 
+void
+InternalLoggingEvent::setPayload (void const * data, std::size_t size)
+{
+    payload.assign (static_cast<char const *>(data), size);
+    payloadView = std::string_view ();
+    payloadBorrowed = false;
+}
+
+
+void
+InternalLoggingEvent::borrowPayload (void const * data, std::size_t size)
+{
+    payload.clear ();
+    payloadView = std::string_view (static_cast<char const *>(data), size);
+    payloadBorrowed = true;
+}
+
+
 const log4cplus::tstring&
 InternalLoggingEvent::getMessage() const
 {
@@ -276,6 +336,46 @@ InternalLoggingEvent::gatherThreadSpecificData () const
 }
 
 
+void
+InternalLoggingEvent::gatherThreadSpecificData (unsigned fields) const
+{
+    if (fields & TSD_NDC)
+        getNDC ();
+    if (fields & TSD_MDC)
+        getMDCCopy ();
+    if (fields & TSD_THREAD)
+        getThread ();
+    if (fields & TSD_THREAD2)
+        getThread2 ();
+}
+
+
+void
+InternalLoggingEvent::discardThreadSpecificData (unsigned fields)
+{
+    if (fields & TSD_NDC)
+    {
+        ndc.clear ();
+        ndcCached = true;
+    }
+    if (fields & TSD_MDC)
+    {
+        mdc.clear ();
+        mdcCached = true;
+    }
+    if (fields & TSD_THREAD)
+    {
+        thread.clear ();
+        threadCached = true;
+    }
+    if (fields & TSD_THREAD2)
+    {
+        thread2.clear ();
+        thread2Cached = true;
+    }
+}
+
+
 void
 InternalLoggingEvent::swap (InternalLoggingEvent & other)
 {
@@ -292,10 +392,85 @@ InternalLoggingEvent::swap (InternalLoggingEvent & other)
     swap (file, other.file);
     swap (function, other.function);
     swap (line, other.line);
+    swap (payload, other.payload);
+    swap (payloadView, other.payloadView);
+    swap (payloadBorrowed, other.payloadBorrowed);
     swap (threadCached, other.threadCached);
     swap (thread2Cached, other.thread2Cached);
     swap (ndcCached, other.ndcCached);
+    swap (mdcCached, other.mdcCached);
 }
 
 
 } // namespace log4cplus::spi
+
+
+#if defined (LOG4CPLUS_WITH_UNIT_TESTS)
+namespace log4cplus
+{
+
+namespace
+{
+
+// Exposes which thread specific data of an event have been gathered.
+class ProbeEvent
+    : public spi::InternalLoggingEvent
+{
+public:
+    using spi::InternalLoggingEvent::InternalLoggingEvent;
+
+    unsigned
+    gathered () const
+    {
+        return (ndcCached ? static_cast<unsigned>(TSD_NDC) : 0u)
+            | (mdcCached ? static_cast<unsigned>(TSD_MDC) : 0u)
+            | (threadCached ? static_cast<unsigned>(TSD_THREAD) : 0u)
+            | (thread2Cached ? static_cast<unsigned>(TSD_THREAD2) : 0u);
+    }
+};
+
+} // namespace
+
+
+CATCH_TEST_CASE ("InternalLoggingEvent field masked copy",
+    "[loggingevent]")
+{
+    using spi::InternalLoggingEvent;
+
+    NDCContextCreator ndc_guard (LOG4CPLUS_TEXT ("ndc"));
+    ProbeEvent source (LOG4CPLUS_TEXT ("test"), INFO_LOG_LEVEL,
+        LOG4CPLUS_TEXT ("message"), __FILE__, __LINE__);
+    unsigned const fields = InternalLoggingEvent::TSD_THREAD;
+
+    CATCH_SECTION ("copy constructor")
+    {
+        InternalLoggingEvent const copy (source, fields);
+        CATCH_REQUIRE (source.gathered () == fields);
+        CATCH_REQUIRE (copy.getMessage () == source.getMessage ());
+        CATCH_REQUIRE (copy.getThread () == source.getThread ());
+        CATCH_REQUIRE (copy.getNDC ().empty ());
+        CATCH_REQUIRE (copy.getMDCCopy ().empty ());
+        CATCH_REQUIRE (copy.getThread2 ().empty ());
+    }
+
+#if ! defined (LOG4CPLUS_SINGLE_THREADED)
+    CATCH_SECTION ("queued event")
+    {
+        thread::Queue queue (1);
+        CATCH_REQUIRE ((queue.put_event (source, fields, 42)
+                & thread::Queue::ERROR_BIT) == 0);
+        CATCH_REQUIRE (source.gathered () == fields);
+
+        thread::Queue::queue_storage_type events;
+        queue.get_events (&events);
+        CATCH_REQUIRE (events.size () == 1);
+        CATCH_REQUIRE (events.front ().event.getNDC ().empty ());
+        CATCH_REQUIRE (events.front ().event.getThread ()
+            == source.getThread ());
+        CATCH_REQUIRE (events.front ().reserved == 42);
+    }
+#endif
+}
+
+} // namespace log4cplus
+#endif
@@ -67,6 +67,15 @@ get_macro_body_oss ()
 }
 
 
+log4cplus::helpers::MessageBuilder &
+get_macro_body_builder ()
+{
+    helpers::MessageBuilder & builder = internal::get_ptd ()->macros_builder;
+    builder.reset ();
+    return builder;
+}
+
+
 log4cplus::helpers::snprintf_buf &
 get_macro_body_snprintf_buf ()
 {
@@ -79,8 +88,8 @@ macro_forced_log (log4cplus::Logger const & logger,
     log4cplus::LogLevel log_level, log4cplus::tchar const * msg,
     char const * filename, int line, char const * func)
 {
-    macro_forced_log (logger, log_level,
-        internal::get_ptd ()->macros_str = msg, filename, line, func);
+    macro_forced_log (logger, log_level, tstring_view (msg), filename, line,
+        func);
 }
 
 
@@ -89,11 +98,7 @@ macro_forced_log (log4cplus::Logger const & logger,
     log4cplus::LogLevel log_level, log4cplus::tstring_view const & msg,
     char const * filename, int line, char const * func)
 {
-    log4cplus::spi::InternalLoggingEvent & ev
-        = internal::get_ptd ()->forced_log_ev;
-    ev.setLoggingEvent (logger.getName (), log_level, msg, filename, line,
-        func);
-    logger.forcedLog (ev);
+    logger.forcedLog (log_level, msg, filename, line, func);
 }
 
 
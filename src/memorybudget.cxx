@@ -0,0 +1,273 @@
+// -*- C++ -*-
+//
+//  Copyright (C) 2026, Vaclav Zeman. All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without modifica-
+//  tion, are permitted provided that the following conditions are met:
+//
+//  1. Redistributions of  source code must  retain the above copyright  notice,
+//     this list of conditions and the following disclaimer.
+//
+//  2. Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//
+//  THIS SOFTWARE IS PROVIDED ``AS IS'' AND ANY EXPRESSED OR IMPLIED WARRANTIES,
+//  INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+//  FITNESS  FOR A PARTICULAR  PURPOSE ARE  DISCLAIMED.  IN NO  EVENT SHALL  THE
+//  APACHE SOFTWARE  FOUNDATION  OR ITS CONTRIBUTORS  BE LIABLE FOR  ANY DIRECT,
+//  INDIRECT, INCIDENTAL, SPECIAL,  EXEMPLARY, OR CONSEQUENTIAL  DAMAGES (INCLU-
+//  DING, BUT NOT LIMITED TO, PROCUREMENT  OF SUBSTITUTE GOODS OR SERVICES; LOSS
+//  OF USE, DATA, OR  PROFITS; OR BUSINESS  INTERRUPTION)  HOWEVER CAUSED AND ON
+//  ANY  THEORY OF LIABILITY,  WHETHER  IN CONTRACT,  STRICT LIABILITY,  OR TORT
+//  (INCLUDING  NEGLIGENCE OR  OTHERWISE) ARISING IN  ANY WAY OUT OF THE  USE OF
+//  THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <log4cplus/helpers/memorybudget.h>
+#include <log4cplus/spi/loggingevent.h>
+
+#if defined (LOG4CPLUS_WITH_UNIT_TESTS)
+#include <log4cplus/ndc.h>
+#include <catch.hpp>
+#endif
+
+
+namespace log4cplus::helpers {
+
+
+MemoryBudget::MemoryBudget ()
+    : limit (0)
+    , total (0)
+{
+    for (int c = 0; c != COMPONENT_COUNT; ++c)
+    {
+        usage[c].store (0, std::memory_order_relaxed);
+        overflows[c].store (0, std::memory_order_relaxed);
+        policies[c].store (OVERFLOW_SYNC, std::memory_order_relaxed);
+    }
+}
+
+
+MemoryBudget::~MemoryBudget () = default;
+
+
+void
+MemoryBudget::setLimit (std::size_t bytes)
+{
+    limit.store (bytes, std::memory_order_relaxed);
+}
+
+
+std::size_t
+MemoryBudget::getLimit () const
+{
+    return limit.load (std::memory_order_relaxed);
+}
+
+
+void
+MemoryBudget::setOverflowPolicy (Component c, OverflowPolicy policy)
+{
+    policies[c].store (policy, std::memory_order_relaxed);
+}
+
+
+MemoryBudget::OverflowPolicy
+MemoryBudget::getOverflowPolicy (Component c) const
+{
+    return policies[c].load (std::memory_order_relaxed);
+}
+
+
+bool
+MemoryBudget::tryAcquire (Component c, std::size_t bytes)
+{
+    std::size_t const max = limit.load (std::memory_order_relaxed);
+    std::size_t current = total.load (std::memory_order_relaxed);
+    do
+    {
+        if (max != 0 && (bytes > max || current > max - bytes))
+        {
+            overflows[c].fetch_add (1, std::memory_order_relaxed);
+            return false;
+        }
+    }
+    while (! total.compare_exchange_weak (current, current + bytes,
+            std::memory_order_relaxed, std::memory_order_relaxed));
+
+    usage[c].fetch_add (bytes, std::memory_order_relaxed);
+    return true;
+}
+
+
+void
+MemoryBudget::release (Component c, std::size_t bytes)
+{
+    usage[c].fetch_sub (bytes, std::memory_order_relaxed);
+    total.fetch_sub (bytes, std::memory_order_relaxed);
+}
+
+
+std::size_t
+MemoryBudget::getUsage (Component c) const
+{
+    return usage[c].load (std::memory_order_relaxed);
+}
+
+
+std::size_t
+MemoryBudget::getTotalUsage () const
+{
+    return total.load (std::memory_order_relaxed);
+}
+
+
+std::size_t
+MemoryBudget::getOverflowCount (Component c) const
+{
+    return overflows[c].load (std::memory_order_relaxed);
+}
+
+
+tchar const *
+MemoryBudget::getComponentName (Component c)
+{
+    switch (c)
+    {
+    case THREAD_POOL_QUEUE:
+        return LOG4CPLUS_TEXT ("ThreadPoolQueue");
+
+    case ASYNC_APPENDER_QUEUE:
+        return LOG4CPLUS_TEXT ("AsyncAppenderQueue");
+
+    case FILE_BUFFER:
+        return LOG4CPLUS_TEXT ("FileBuffer");
+
+    default:
+        return LOG4CPLUS_TEXT ("");
+    }
+}
+
+
+std::size_t
+MemoryBudget::estimateEventSize (spi::InternalLoggingEvent const & ev,
+    unsigned fields)
+{
+    typedef spi::InternalLoggingEvent IE;
+
+    std::size_t size = sizeof (spi::InternalLoggingEvent)
+        + (ev.getMessage ().size ()
+            + ev.getLoggerName ().size ()
+            + ((fields & IE::TSD_NDC) ? ev.getNDC ().size () : 0)
+            + ((fields & IE::TSD_THREAD) ? ev.getThread ().size () : 0)
+            + ((fields & IE::TSD_THREAD2) ? ev.getThread2 ().size () : 0)
+            + ev.getFile ().size ()
+            + ev.getFunction ().size ()) * sizeof (tchar)
+        + ev.getPayload ().size ();
+
+    if (fields & IE::TSD_MDC)
+        for (auto const & kv : ev.getMDCCopy ())
+            size += 4 * sizeof (void *)
+                + (kv.first.size () + kv.second.size ()) * sizeof (tchar);
+
+    return size;
+}
+
+
+#if defined (LOG4CPLUS_HAVE_MEMORY_RESOURCE)
+namespace
+{
+
+std::atomic<std::pmr::memory_resource *> async_event_resource {nullptr};
+
+} // namespace
+
+
+void
+setAsyncEventMemoryResource (std::pmr::memory_resource * resource)
+{
+    async_event_resource.store (resource, std::memory_order_release);
+}
+
+
+std::pmr::memory_resource *
+getAsyncEventMemoryResource ()
+{
+    std::pmr::memory_resource * resource
+        = async_event_resource.load (std::memory_order_acquire);
+    return resource ? resource : std::pmr::new_delete_resource ();
+}
+
+#endif
+
+
+#if defined (LOG4CPLUS_WITH_UNIT_TESTS)
+CATCH_TEST_CASE ("MemoryBudget", "[memorybudget]")
+{
+    MemoryBudget budget;
+
+    CATCH_SECTION ("unlimited")
+    {
+        CATCH_REQUIRE (budget.tryAcquire (MemoryBudget::FILE_BUFFER, 1000));
+        CATCH_REQUIRE (budget.getUsage (MemoryBudget::FILE_BUFFER) == 1000);
+        CATCH_REQUIRE (budget.getTotalUsage () == 1000);
+        budget.release (MemoryBudget::FILE_BUFFER, 1000);
+        CATCH_REQUIRE (budget.getTotalUsage () == 0);
+    }
+
+    CATCH_SECTION ("limit is shared by components")
+    {
+        budget.setLimit (100);
+        CATCH_REQUIRE (budget.tryAcquire (MemoryBudget::FILE_BUFFER, 60));
+        CATCH_REQUIRE (
+            ! budget.tryAcquire (MemoryBudget::ASYNC_APPENDER_QUEUE, 50));
+        CATCH_REQUIRE (
+            budget.getOverflowCount (MemoryBudget::ASYNC_APPENDER_QUEUE) == 1);
+        CATCH_REQUIRE (
+            budget.tryAcquire (MemoryBudget::ASYNC_APPENDER_QUEUE, 40));
+        CATCH_REQUIRE (budget.getTotalUsage () == 100);
+        CATCH_REQUIRE (! budget.tryAcquire (MemoryBudget::FILE_BUFFER,
+                static_cast<std::size_t>(-1)));
+
+        budget.release (MemoryBudget::FILE_BUFFER, 60);
+        CATCH_REQUIRE (budget.getUsage (MemoryBudget::FILE_BUFFER) == 0);
+        CATCH_REQUIRE (
+            budget.getUsage (MemoryBudget::ASYNC_APPENDER_QUEUE) == 40);
+        CATCH_REQUIRE (budget.tryAcquire (MemoryBudget::THREAD_POOL_QUEUE, 60));
+    }
+
+    CATCH_SECTION ("event size estimate grows with message")
+    {
+        spi::InternalLoggingEvent small (LOG4CPLUS_TEXT ("test"),
+            INFO_LOG_LEVEL, LOG4CPLUS_TEXT ("a"), nullptr, 0);
+        spi::InternalLoggingEvent large (LOG4CPLUS_TEXT ("test"),
+            INFO_LOG_LEVEL, tstring (1000, LOG4CPLUS_TEXT ('a')), nullptr, 0);
+        CATCH_REQUIRE (MemoryBudget::estimateEventSize (large)
+            >= MemoryBudget::estimateEventSize (small)
+                + 999 * sizeof (tchar));
+    }
+
+    CATCH_SECTION ("discarded thread specific data are not counted")
+    {
+        NDCContextCreator ndc (tstring (1000, LOG4CPLUS_TEXT ('n')));
+        spi::InternalLoggingEvent ev (LOG4CPLUS_TEXT ("test"),
+            INFO_LOG_LEVEL, LOG4CPLUS_TEXT ("a"), nullptr, 0);
+        unsigned const fields = spi::InternalLoggingEvent::TSD_THREAD;
+        ev.gatherThreadSpecificData (fields);
+        std::size_t const bytes = MemoryBudget::estimateEventSize (ev, fields);
+
+        spi::InternalLoggingEvent copy (ev);
+        copy.discardThreadSpecificData (~fields
+            & spi::InternalLoggingEvent::TSD_ALL);
+        CATCH_REQUIRE (copy.getNDC ().empty ());
+        CATCH_REQUIRE (copy.getThread () == ev.getThread ());
+        CATCH_REQUIRE (MemoryBudget::estimateEventSize (copy) == bytes);
+        CATCH_REQUIRE (MemoryBudget::estimateEventSize (ev)
+            >= bytes + 1000 * sizeof (tchar));
+    }
+}
+
+#endif
+
+
+} // namespace log4cplus::helpers
@@ -0,0 +1,184 @@
+// -*- C++ -*-
+//
+//  Copyright (C) 2026, Vaclav Zeman. All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without modifica-
+//  tion, are permitted provided that the following conditions are met:
+//
+//  1. Redistributions of  source code must  retain the above copyright  notice,
+//     this list of conditions and the following disclaimer.
+//
+//  2. Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//
+//  THIS SOFTWARE IS PROVIDED ``AS IS'' AND ANY EXPRESSED OR IMPLIED WARRANTIES,
+//  INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+//  FITNESS  FOR A PARTICULAR  PURPOSE ARE  DISCLAIMED.  IN NO  EVENT SHALL  THE
+//  APACHE SOFTWARE  FOUNDATION  OR ITS CONTRIBUTORS  BE LIABLE FOR  ANY DIRECT,
+//  INDIRECT, INCIDENTAL, SPECIAL,  EXEMPLARY, OR CONSEQUENTIAL  DAMAGES (INCLU-
+//  DING, BUT NOT LIMITED TO, PROCUREMENT  OF SUBSTITUTE GOODS OR SERVICES; LOSS
+//  OF USE, DATA, OR  PROFITS; OR BUSINESS  INTERRUPTION)  HOWEVER CAUSED AND ON
+//  ANY  THEORY OF LIABILITY,  WHETHER  IN CONTRACT,  STRICT LIABILITY,  OR TORT
+//  (INCLUDING  NEGLIGENCE OR  OTHERWISE) ARISING IN  ANY WAY OUT OF THE  USE OF
+//  THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <log4cplus/helpers/messagebuilder.h>
+#include <log4cplus/loggingmacros.h>
+
+#if defined (LOG4CPLUS_WITH_UNIT_TESTS)
+#include <iomanip>
+#include <catch.hpp>
+#endif
+
+
+namespace log4cplus::helpers {
+
+
+MessageBuilder::MessageBuilder ()
+    : streaming (false)
+{ }
+
+
+MessageBuilder::~MessageBuilder () = default;
+
+
+void
+MessageBuilder::reset ()
+{
+    buf.clear ();
+    if (streaming)
+    {
+        log4cplus::detail::clear_tostringstream (*oss);
+        streaming = false;
+    }
+}
+
+
+tstring const &
+MessageBuilder::str ()
+{
+    if (streaming)
+        buf = oss->str ();
+
+    return buf;
+}
+
+
+MessageBuilder &
+MessageBuilder::operator << (tostream & (* manip) (tostream &))
+{
+    manip (stream ());
+    return *this;
+}
+
+
+MessageBuilder &
+MessageBuilder::operator << (
+    std::basic_ios<tchar> & (* manip) (std::basic_ios<tchar> &))
+{
+    manip (stream ());
+    return *this;
+}
+
+
+MessageBuilder &
+MessageBuilder::operator << (std::ios_base & (* manip) (std::ios_base &))
+{
+    manip (stream ());
+    return *this;
+}
+
+
+tostream &
+MessageBuilder::stream ()
+{
+    if (! streaming)
+    {
+        if (! oss)
+            oss = std::make_unique<tostringstream> ();
+
+        oss->write (buf.data (), static_cast<std::streamsize>(buf.size ()));
+        buf.clear ();
+        streaming = true;
+    }
+
+    return *oss;
+}
+
+
+#if defined (LOG4CPLUS_WITH_UNIT_TESTS)
+namespace
+{
+
+struct Point
+{
+    int x;
+    int y;
+};
+
+tostream &
+operator << (tostream & os, Point const & p)
+{
+    return os << LOG4CPLUS_TEXT ('(') << p.x << LOG4CPLUS_TEXT (',') << p.y
+        << LOG4CPLUS_TEXT (')');
+}
+
+} // namespace
+
+
+CATCH_TEST_CASE ("MessageBuilder", "[messagebuilder]")
+{
+    MessageBuilder mb;
+    tostringstream oss;
+
+    CATCH_SECTION ("arithmetic types match streams")
+    {
+        mb << LOG4CPLUS_TEXT ("x=") << 42 << LOG4CPLUS_TEXT (' ')
+           << -7L << LOG4CPLUS_TEXT (' ') << 18446744073709551615ull
+           << LOG4CPLUS_TEXT (' ') << true << LOG4CPLUS_TEXT (' ')
+           << 3.25 << LOG4CPLUS_TEXT (' ') << 1e20 << LOG4CPLUS_TEXT (' ')
+           << 0.1f << LOG4CPLUS_TEXT (' ') << short (-3);
+        oss << LOG4CPLUS_TEXT ("x=") << 42 << LOG4CPLUS_TEXT (' ')
+            << -7L << LOG4CPLUS_TEXT (' ') << 18446744073709551615ull
+            << LOG4CPLUS_TEXT (' ') << true << LOG4CPLUS_TEXT (' ')
+            << 3.25 << LOG4CPLUS_TEXT (' ') << 1e20 << LOG4CPLUS_TEXT (' ')
+            << 0.1f << LOG4CPLUS_TEXT (' ') << short (-3);
+        CATCH_REQUIRE (mb.str () == oss.str ());
+    }
+
+    CATCH_SECTION ("strings are copied")
+    {
+        tstring const s (LOG4CPLUS_TEXT ("string"));
+        tchar const * const null_str = nullptr;
+        mb << s << LOG4CPLUS_TEXT (' ') << tstring_view (s).substr (0, 3)
+           << null_str;
+        CATCH_REQUIRE (mb.str () == LOG4CPLUS_TEXT ("string str"));
+
+        tchar array[] = LOG4CPLUS_TEXT ("array");
+        mb << LOG4CPLUS_TEXT (' ') << array << LOG4CPLUS_TEXT (" literal");
+        CATCH_REQUIRE (mb.str ()
+            == LOG4CPLUS_TEXT ("string str array literal"));
+    }
+
+    CATCH_SECTION ("user types and manipulators use fallback stream")
+    {
+        mb << LOG4CPLUS_TEXT ("p=") << Point {1, 2} << LOG4CPLUS_TEXT (' ')
+           << std::hex << 255 << LOG4CPLUS_TEXT (' ') << std::setw (4)
+           << std::setfill (LOG4CPLUS_TEXT ('0')) << 7;
+        CATCH_REQUIRE (mb.str () == LOG4CPLUS_TEXT ("p=(1,2) ff 0007"));
+
+        mb.reset ();
+        mb << 255;
+        CATCH_REQUIRE (mb.str () == LOG4CPLUS_TEXT ("255"));
+
+        mb.reset ();
+        mb << Point {3, 4} << 16;
+        CATCH_REQUIRE (mb.str () == LOG4CPLUS_TEXT ("(3,4)16"));
+    }
+}
+
+#endif
+
+
+} // namespace log4cplus::helpers
@@ -57,6 +57,13 @@ NullAppender::close()
 }
 
 
+unsigned
+NullAppender::getRequiredThreadSpecificData() const
+{
+    return getLayoutRequiredThreadSpecificData ();
+}
+
+
 
 ///////////////////////////////////////////////////////////////////////////////
 // NullAppender protected methods
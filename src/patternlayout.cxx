@@ -31,6 +31,10 @@
 #include <cstdlib>
 #include <memory>
 
+#if defined (LOG4CPLUS_WITH_UNIT_TESTS)
+#include <catch.hpp>
+#endif
+
 
 namespace
 {
@@ -98,12 +102,27 @@ class PatternConverter
 public:
     explicit PatternConverter(const FormattingInfo& info);
     virtual ~PatternConverter() = default;
-    void formatAndAppend(tostream& output,
+    void appendSegments(LayoutSegments & output,
         const spi::InternalLoggingEvent& event);
 
     virtual void convert(tstring & result,
         const spi::InternalLoggingEvent& event) = 0;
 
+    //! Returns string owned by the event that convert() would copy, or
+    //! NULL if the field has to be converted.
+    virtual tstring const * getReference(
+        const spi::InternalLoggingEvent&) const
+    {
+        return nullptr;
+    }
+
+    //! Returns spi::InternalLoggingEvent::ThreadSpecificData flags
+    //! selecting thread specific data used by convert().
+    virtual unsigned getRequiredThreadSpecificData() const
+    {
+        return 0;
+    }
+
 private:
     int minLen;
     std::size_t maxLen;
@@ -157,6 +176,9 @@ public:
     BasicPatternConverter(const FormattingInfo& info, Type type);
     void convert(tstring & result,
         const spi::InternalLoggingEvent& event) override;
+    tstring const * getReference(
+        const spi::InternalLoggingEvent& event) const override;
+    unsigned getRequiredThreadSpecificData() const override;
 
 private:
   // Disable copy
@@ -169,6 +191,22 @@ private:
 
 
 
+/**
+ * This PatternConverter is used to format the binary payload of the
+ * InternalLoggingEvent object, encoded either in hexadecimal or in Base64.
+ */
+class PayloadPatternConverter : public PatternConverter {
+public:
+    PayloadPatternConverter(const FormattingInfo& info, bool base64);
+    void convert(tstring & result,
+        const spi::InternalLoggingEvent& event) override;
+
+private:
+    bool base64;
+};
+
+
+
 /**
  * This PatternConverter is used to format the Logger field found in
  * the InternalLoggingEvent object.
@@ -200,7 +238,7 @@ public:
 
 private:
     bool use_gmtime;
-    tstring format;
+    helpers::TimeFormatter formatter;
 };
 
 
@@ -254,6 +292,12 @@ public:
     MDCPatternConverter(const FormattingInfo& info, tstring const & k);
     void convert(tstring & result,
         const spi::InternalLoggingEvent& event) override;
+    tstring const * getReference(
+        const spi::InternalLoggingEvent& event) const override;
+    unsigned getRequiredThreadSpecificData() const override
+    {
+        return spi::InternalLoggingEvent::TSD_MDC;
+    }
 
 private:
     tstring key;
@@ -270,6 +314,10 @@ public:
     NDCPatternConverter(const FormattingInfo& info, int precision);
     void convert(tstring & result,
         const spi::InternalLoggingEvent& event) override;
+    unsigned getRequiredThreadSpecificData() const override
+    {
+        return spi::InternalLoggingEvent::TSD_NDC;
+    }
 
 private:
     int precision;
@@ -354,33 +402,41 @@ PatternConverter::PatternConverter(const FormattingInfo& i)
 
 
 void
-PatternConverter::formatAndAppend(
-    tostream& output, const spi::InternalLoggingEvent& event)
+PatternConverter::appendSegments(
+    LayoutSegments & output, const spi::InternalLoggingEvent& event)
 {
-    tstring & s = internal::get_ptd ()->faa_str;
-    convert (s, event);
+    tstring const * ref = getReference (event);
+    bool const referenced = ref != nullptr;
+    if (! referenced)
+    {
+        tstring & s = internal::get_ptd ()->faa_str;
+        convert (s, event);
+        ref = &s;
+    }
+
+    tstring_view const s (*ref);
     std::size_t len = s.length();
 
     if (len > maxLen)
     {
         if (trimStart)
-            output << s.substr(len - maxLen);
+            output.appendText (s.substr(len - maxLen));
         else
-            output << s.substr(0, maxLen);
+            output.appendText (s.substr(0, maxLen));
     }
     else if (static_cast<int>(len) < minLen)
     {
-        std::ios_base::fmtflags const original_flags = output.flags ();
-        tchar const fill = output.fill (LOG4CPLUS_TEXT(' '));
-        output.setf (leftAlign ? std::ios_base::left : std::ios_base::right,
-            std::ios_base::adjustfield);
-        output.width (minLen);
-        output << s;
-        output.fill (fill);
-        output.flags (original_flags);
+        std::size_t const fill = static_cast<std::size_t>(minLen) - len;
+        if (! leftAlign)
+            output.appendFill (fill, LOG4CPLUS_TEXT(' '));
+        output.appendText (s);
+        if (leftAlign)
+            output.appendFill (fill, LOG4CPLUS_TEXT(' '));
     }
+    else if (referenced)
+        output.appendReference (s);
     else
-        output << s;
+        output.appendText (s);
 }
 
 
@@ -491,6 +547,37 @@ BasicPatternConverter::convert(tstring & result,
 }
 
 
+tstring const *
+BasicPatternConverter::getReference(
+    const spi::InternalLoggingEvent& event) const
+{
+    if (type == MESSAGE_CONVERTER)
+        return &event.getMessage ();
+    else
+        return nullptr;
+}
+
+
+unsigned
+BasicPatternConverter::getRequiredThreadSpecificData() const
+{
+    switch(type)
+    {
+    case NDC_CONVERTER:
+        return spi::InternalLoggingEvent::TSD_NDC;
+
+    case THREAD_CONVERTER:
+        return spi::InternalLoggingEvent::TSD_THREAD;
+
+    case THREAD2_CONVERTER:
+        return spi::InternalLoggingEvent::TSD_THREAD2;
+
+    default:
+        return 0;
+    }
+}
+
+
 
 ////////////////////////////////////////////////
 // LoggerPatternConverter methods:
@@ -544,7 +631,7 @@ DatePatternConverter::DatePatternConverter(
     bool use_gmtime_)
     : PatternConverter(info)
     , use_gmtime(use_gmtime_)
-    , format(pattern)
+    , formatter(pattern)
 {
 }
 
@@ -554,8 +641,8 @@ void
 DatePatternConverter::convert(tstring & result,
     const spi::InternalLoggingEvent& event)
 {
-    result = helpers::getFormattedTime(format, event.getTimestamp(),
-        use_gmtime);
+    result.clear ();
+    formatter.append (result, event.getTimestamp(), use_gmtime);
 }
 
 
@@ -603,6 +690,30 @@ RelativeTimestampConverter::convert (tstring & result,
 }
 
 
+////////////////////////////////////////////////
+// PayloadPatternConverter methods:
+////////////////////////////////////////////////
+
+PayloadPatternConverter::PayloadPatternConverter (
+    const FormattingInfo& info, bool base64_)
+    : PatternConverter(info)
+    , base64 (base64_)
+{ }
+
+
+void
+PayloadPatternConverter::convert (tstring & result,
+    const spi::InternalLoggingEvent& event)
+{
+    std::string_view const payload = event.getPayload ();
+    result.clear ();
+    if (base64)
+        helpers::appendBase64 (result, payload.data (), payload.size ());
+    else
+        helpers::appendHex (result, payload.data (), payload.size ());
+}
+
+
 ////////////////////////////////////////////////
 // HostnamePatternConverter methods:
 ////////////////////////////////////////////////
@@ -634,6 +745,17 @@ log4cplus::pattern::MDCPatternConverter::MDCPatternConverter (
 { }
 
 
+tstring const *
+log4cplus::pattern::MDCPatternConverter::getReference (
+    const spi::InternalLoggingEvent& event) const
+{
+    if (! key.empty ())
+        return &event.getMDC (key);
+    else
+        return nullptr;
+}
+
+
 void
 log4cplus::pattern::MDCPatternConverter::convert (tstring & result,
     const spi::InternalLoggingEvent& event)
@@ -878,6 +1000,19 @@ PatternParser::finalizeConverter(tchar c)
             //formattingInfo.dump(getLogLog());
             break;
 
+        case LOG4CPLUS_TEXT('B'):
+            {
+                tstring const encoding = extractOption();
+                bool const base64 = encoding == LOG4CPLUS_TEXT("base64");
+                if (! base64 && ! encoding.empty ()
+                    && encoding != LOG4CPLUS_TEXT("hex"))
+                    helpers::getLogLog().error(
+                        LOG4CPLUS_TEXT("Unknown payload encoding \"")
+                        + encoding + LOG4CPLUS_TEXT("\", using hex."));
+                pc = new PayloadPatternConverter(formattingInfo, base64);
+            }
+            break;
+
         case LOG4CPLUS_TEXT('c'):
             pc = new LoggerPatternConverter(formattingInfo,
                                             extractPrecisionOption());
@@ -1085,6 +1220,11 @@ PatternLayout::init(const tstring& pattern_, unsigned ndcMaxDepth)
     pattern = pattern_;
     parsedPattern = pattern::PatternParser(pattern, ndcMaxDepth).parse();
 
+    fingerprint = LOG4CPLUS_TEXT ("log4cplus::PatternLayout|");
+    fingerprint += helpers::convertIntegerToString (ndcMaxDepth);
+    fingerprint += LOG4CPLUS_TEXT ('|');
+    fingerprint += pattern;
+
     // Let's validate that our parser didn't give us any NULLs.  If it did,
     // we will convert them to a valid PatternConverter that does nothing so
     // at least we don't core.
@@ -1107,6 +1247,10 @@ PatternLayout::init(const tstring& pattern_, unsigned ndcMaxDepth)
                 new pattern::BasicPatternConverter(pattern::FormattingInfo(),
                     pattern::BasicPatternConverter::MESSAGE_CONVERTER)));
     }
+
+    requiredThreadSpecificData = 0;
+    for (auto const & pc : parsedPattern)
+        requiredThreadSpecificData |= pc->getRequiredThreadSpecificData ();
 }
 
 
@@ -1118,12 +1262,112 @@ PatternLayout::~PatternLayout() = default;
 void
 PatternLayout::formatAndAppend(tostream& output,
                                const spi::InternalLoggingEvent& event)
+{
+    LayoutSegments & segments = internal::get_ptd ()->layout_segments;
+    segments.clear ();
+    formatSegments (segments, event);
+    segments.writeTo (output);
+}
+
+
+
+void
+PatternLayout::formatSegments(LayoutSegments & output,
+                              const spi::InternalLoggingEvent& event)
 {
     for (auto const & pc : parsedPattern)
     {
-        pc->formatAndAppend(output, event);
+        pc->appendSegments(output, event);
     }
 }
 
 
+
+#if defined (LOG4CPLUS_WITH_UNIT_TESTS)
+CATCH_TEST_CASE ("Layout required thread specific data",
+    "[layout]")
+{
+    using IE = spi::InternalLoggingEvent;
+
+    CATCH_SECTION ("simple layout")
+    {
+        SimpleLayout layout;
+        CATCH_REQUIRE (layout.getRequiredThreadSpecificData () == 0);
+    }
+
+    CATCH_SECTION ("TTCC layout")
+    {
+        TTCCLayout layout;
+        CATCH_REQUIRE (layout.getRequiredThreadSpecificData ()
+            == (IE::TSD_THREAD | IE::TSD_NDC));
+        layout.setThreadPrinting (false);
+        CATCH_REQUIRE (layout.getRequiredThreadSpecificData ()
+            == IE::TSD_NDC);
+        layout.setContextPrinting (false);
+        CATCH_REQUIRE (layout.getRequiredThreadSpecificData () == 0);
+    }
+
+    CATCH_SECTION ("pattern layout")
+    {
+        PatternLayout plain (LOG4CPLUS_TEXT ("%d %-5p %c - %m%n"));
+        CATCH_REQUIRE (plain.getRequiredThreadSpecificData () == 0);
+
+        PatternLayout thread (LOG4CPLUS_TEXT ("%t %T %m"));
+        CATCH_REQUIRE (thread.getRequiredThreadSpecificData ()
+            == (IE::TSD_THREAD | IE::TSD_THREAD2));
+
+        PatternLayout context (LOG4CPLUS_TEXT ("%x %X{key} %m"));
+        CATCH_REQUIRE (context.getRequiredThreadSpecificData ()
+            == (IE::TSD_NDC | IE::TSD_MDC));
+    }
+}
+
+
+CATCH_TEST_CASE ("Pattern layout segments", "[layout]")
+{
+    tstring const message (LayoutSegments::referenceThreshold * 2,
+        LOG4CPLUS_TEXT ('m'));
+    spi::InternalLoggingEvent ev (LOG4CPLUS_TEXT ("test"),
+        INFO_LOG_LEVEL, message, nullptr, 0);
+    LayoutSegments segments;
+
+    CATCH_SECTION ("long message is referenced")
+    {
+        PatternLayout layout (LOG4CPLUS_TEXT ("[%c] %m%n"));
+        layout.formatSegments (segments, ev);
+        CATCH_REQUIRE (segments.size () == 3);
+        CATCH_REQUIRE (segments[0] == LOG4CPLUS_TEXT ("[test] "));
+        CATCH_REQUIRE (segments[1].data () == ev.getMessage ().data ());
+        CATCH_REQUIRE (segments[2] == LOG4CPLUS_TEXT ("\n"));
+
+        tostringstream oss;
+        layout.formatAndAppend (oss, ev);
+        CATCH_REQUIRE (segments.str () == oss.str ());
+        CATCH_REQUIRE (oss.str ()
+            == LOG4CPLUS_TEXT ("[test] ") + message + LOG4CPLUS_TEXT ("\n"));
+    }
+
+    CATCH_SECTION ("short fields are copied")
+    {
+        PatternLayout layout (LOG4CPLUS_TEXT ("%c:%5p|%-6c|%.3m"));
+        layout.formatSegments (segments, ev);
+        CATCH_REQUIRE (segments.size () == 1);
+        CATCH_REQUIRE (segments.str ()
+            == LOG4CPLUS_TEXT ("test: INFO|test  |mmm"));
+    }
+
+    CATCH_SECTION ("binary payload is encoded")
+    {
+        unsigned char const bytes[] = { 0x01, 0xfe, 0x7f };
+        ev.borrowPayload (bytes, sizeof (bytes));
+        PatternLayout layout (LOG4CPLUS_TEXT ("%B %B{base64}|%.2B"));
+        layout.formatSegments (segments, ev);
+        CATCH_REQUIRE (segments.str ()
+            == LOG4CPLUS_TEXT ("01fe7f Af5/|7f"));
+    }
+}
+
+#endif
+
+
 } // namespace log4cplus
@@ -46,12 +46,13 @@ Queue::~Queue () = default;
 
 
 Queue::flags_type
-Queue::put_event (spi::InternalLoggingEvent const & ev)
+Queue::put_event (spi::InternalLoggingEvent const & ev, unsigned fields,
+    std::size_t reserved)
 {
     flags_type ret_flags = ERROR_BIT;
     try
     {
-        ev.gatherThreadSpecificData ();
+        ev.gatherThreadSpecificData (fields);
 
         SemaphoreGuard semguard (sem);
         MutexGuard mguard (mutex);
@@ -65,7 +66,7 @@ Queue::put_event (spi::InternalLoggingEvent const & ev)
         }
         else
         {
-            queue.push_back (ev);
+            queue.emplace_back (ev, fields, reserved);
             ret_flags |= ERROR_AFTER;
             semguard.detach ();
             flags |= QUEUE;
@@ -191,9 +191,38 @@ snprintf_buf::print (tchar const * fmt, ...)
 }
 
 
+tchar const *
+snprintf_buf::print_capped (std::size_t max_len, tchar const * fmt, ...)
+{
+    assert (fmt);
+
+    tchar const * str = nullptr;
+    int ret = 0;
+    std::va_list args;
+
+    do
+    {
+        va_start (args, fmt);
+        ret = print_va_list (max_len, str, fmt, args);
+        va_end (args);
+    }
+    while (ret == -1);
+
+    return str;
+}
+
+
 int
 snprintf_buf::print_va_list (tchar const * & str, tchar const * fmt,
     std::va_list args)
+{
+    return print_va_list (0, str, fmt, args);
+}
+
+
+int
+snprintf_buf::print_va_list (std::size_t max_len, tchar const * & str,
+    tchar const * fmt, std::va_list args)
 {
     int printed;
     std::size_t const fmt_len = std::char_traits<tchar>::length (fmt);
@@ -230,8 +259,21 @@ snprintf_buf::print_va_list (tchar const * & str, tchar const * fmt,
 
     buf[sprinted] = 0;
 
+    if (max_len != 0 && static_cast<std::size_t>(printed) > max_len + 1)
+    {
+        printed = static_cast<int>(max_len + 1);
+        buf[printed] = 0;
+    }
+
 #else
-    printed = vsntprintf (&buf[0], buf_size - 1, fmt, args);
+    // With max_len set, the output is cut off after max_len + 1
+    // characters instead of growing the buffer.
+    std::size_t dest_size = buf_size - 1;
+    if (max_len != 0 && dest_size > max_len + 2)
+        dest_size = max_len + 2;
+    bool const at_cap = max_len != 0 && dest_size == max_len + 2;
+
+    printed = vsntprintf (&buf[0], dest_size, fmt, args);
     if (printed == -1)
     {
 #if defined (EILSEQ)
@@ -245,14 +287,30 @@ snprintf_buf::print_va_list (tchar const * & str, tchar const * fmt,
         }
 #endif
 
-        buf_size *= 2;
-        buf.resize (buf_size);
+        if (at_cap)
+        {
+            printed = static_cast<int>(dest_size - 1);
+            buf[printed] = 0;
+        }
+        else
+        {
+            buf_size *= 2;
+            buf.resize (buf_size);
+        }
     }
-    else if (printed >= static_cast<int>(buf_size - 1))
+    else if (printed >= static_cast<int>(dest_size))
     {
-        buf_size = printed + 2;
-        buf.resize (buf_size);
-        printed = -1;
+        if (at_cap)
+        {
+            printed = static_cast<int>(dest_size - 1);
+            buf[printed] = 0;
+        }
+        else
+        {
+            buf_size = printed + 2;
+            buf.resize (buf_size);
+            printed = -1;
+        }
     }
     else
         buf[printed] = 0;
@@ -280,6 +338,21 @@ CATCH_TEST_CASE ("snprintf_buf", "[snprintf_buf]")
                 len)
             == 0);
     }
+
+    CATCH_SECTION ("capped")
+    {
+        tstring const long_str (1000, LOG4CPLUS_TEXT ('a'));
+        tchar const * result = buf.print_capped (10, LOG4CPLUS_TEXT ("%s"),
+            long_str.c_str ());
+        CATCH_REQUIRE (tstring (result) == tstring (11, LOG4CPLUS_TEXT ('a')));
+
+        result = buf.print_capped (10, LOG4CPLUS_TEXT ("%d"), 123);
+        CATCH_REQUIRE (tstring (result) == LOG4CPLUS_TEXT ("123"));
+
+        result = buf.print_capped (0, LOG4CPLUS_TEXT ("%s"),
+            long_str.c_str ());
+        CATCH_REQUIRE (tstring (result) == long_str);
+    }
 }
 
 #endif
@@ -380,6 +380,19 @@ read(SOCKET_TYPE sock, SocketBuffer& buffer)
 }
 
 
+long
+readAvailable(SOCKET_TYPE sock, SocketBuffer& buffer)
+{
+    long res;
+    while ((res = ::read(to_os_socket (sock), buffer.getBuffer(),
+                buffer.getMaxSize())) == -1
+        && errno == EINTR)
+        ;
+
+    return res;
+}
+
+
 
 long
 write(SOCKET_TYPE sock, const SocketBuffer& buffer)
@@ -442,6 +455,27 @@ write(SOCKET_TYPE sock, const std::string & buffer)
 }
 
 
+bool
+hasPendingInput (SOCKET_TYPE sock)
+{
+    struct pollfd pfd;
+    pfd.fd = to_os_socket (sock);
+    pfd.events = POLLIN;
+    pfd.revents = 0;
+
+    int ret;
+    while ((ret = poll (&pfd, 1, 0)) == -1 && errno == EINTR)
+        ;
+
+    if (ret == -1)
+        set_last_socket_error (errno);
+
+    // Errors and hang-ups are reported as pending input so that the
+    // following read() fails and closes the socket.
+    return ret != 0;
+}
+
+
 tstring
 getHostname (bool fqdn)
 {
@@ -560,6 +594,23 @@ error:;
         ::close (fds[1]);
 }
 
+unsigned short
+ServerSocket::getLocalPort () const
+{
+    struct sockaddr_storage addr;
+    socklen_t len = sizeof (addr);
+    if (getsockname (to_os_socket (sock),
+            reinterpret_cast<struct sockaddr *>(&addr), &len) != 0)
+        return 0;
+
+    if (addr.ss_family == AF_INET6)
+        return ntohs (reinterpret_cast<struct sockaddr_in6 *>(&addr)
+            ->sin6_port);
+    else
+        return ntohs (reinterpret_cast<struct sockaddr_in *>(&addr)
+            ->sin_port);
+}
+
 Socket
 ServerSocket::accept ()
 {
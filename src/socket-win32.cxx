@@ -348,6 +348,18 @@ read(SOCKET_TYPE sock, SocketBuffer& buffer)
 }
 
 
+long
+readAvailable(SOCKET_TYPE sock, SocketBuffer& buffer)
+{
+    long const res = ::recv(to_os_socket (sock), buffer.getBuffer(),
+        static_cast<int>(buffer.getMaxSize()), 0);
+    if (res == SOCKET_ERROR)
+        set_last_socket_error (WSAGetLastError ());
+
+    return res;
+}
+
+
 
 long
 write(SOCKET_TYPE sock, const SocketBuffer& buffer)
@@ -485,6 +497,24 @@ getHostname (bool fqdn)
 }
 
 
+bool
+hasPendingInput (SOCKET_TYPE sock)
+{
+    fd_set readfds;
+    FD_ZERO (&readfds);
+    FD_SET (to_os_socket (sock), &readfds);
+    timeval const timeout = { 0, 0 };
+
+    int const ret = ::select (0, &readfds, nullptr, nullptr, &timeout);
+    if (ret == SOCKET_ERROR)
+        set_last_socket_error (WSAGetLastError ());
+
+    // Errors are reported as pending input so that the following read()
+    // fails and closes the socket.
+    return ret != 0;
+}
+
+
 int
 setTCPNoDelay (SOCKET_TYPE sock, bool val)
 {
@@ -584,6 +614,23 @@ ServerSocket::ServerSocket(unsigned short port, bool udp /*= false*/,
     }
 }
 
+unsigned short
+ServerSocket::getLocalPort () const
+{
+    struct sockaddr_storage addr;
+    int len = sizeof (addr);
+    if (getsockname (to_os_socket (sock),
+            reinterpret_cast<struct sockaddr *>(&addr), &len) != 0)
+        return 0;
+
+    if (addr.ss_family == AF_INET6)
+        return ntohs (reinterpret_cast<struct sockaddr_in6 *>(&addr)
+            ->sin6_port);
+    else
+        return ntohs (reinterpret_cast<struct sockaddr_in *>(&addr)
+            ->sin_port);
+}
+
 Socket
 ServerSocket::accept ()
 {
@@ -222,6 +222,28 @@ Socket::write(const std::string & buffer)
 }
 
 
+bool
+Socket::hasPendingInput()
+{
+    return isOpen () && helpers::hasPendingInput (sock);
+}
+
+
+bool
+Socket::readAvailable(SocketBuffer& buffer)
+{
+    long retval = helpers::readAvailable(sock, buffer);
+    if(retval <= 0) {
+        close();
+    }
+    else {
+        buffer.setSize(retval);
+    }
+
+    return (retval > 0);
+}
+
+
 //
 //
 //
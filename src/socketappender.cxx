@@ -18,7 +18,10 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <algorithm>
 #include <cstdlib>
+#include <cstring>
+#include <random>
 #include <stdexcept>
 #include <log4cplus/socketappender.h>
 #include <log4cplus/layout.h>
@@ -28,10 +31,29 @@
 #include <log4cplus/thread/syncprims-pub-impl.h>
 #include <log4cplus/internal/internal.h>
 
+#if defined (LOG4CPLUS_WITH_UNIT_TESTS)
+#include <catch.hpp>
+#include <chrono>
+#include <thread>
+#endif
+
 
 namespace log4cplus {
 
-int const LOG4CPLUS_MESSAGE_VERSION = 3;
+namespace
+{
+
+//! Session identifiers let the server tell sequence numbers of this
+//! appender instance from those of other instances and processes.
+static
+unsigned int
+generateSession ()
+{
+    std::random_device rd;
+    return rd ();
+}
+
+} // namespace
 
 
 //////////////////////////////////////////////////////////////////////////////
@@ -39,11 +61,17 @@ int const LOG4CPLUS_MESSAGE_VERSION = 3;
 //////////////////////////////////////////////////////////////////////////////
 
 SocketAppender::SocketAppender(const tstring& host_,
-    unsigned short port_, const tstring& serverName_, bool ipv6_ /*= false*/)
+    unsigned short port_, const tstring& serverName_, bool ipv6_ /*= false*/,
+    bool acknowledged_ /*= false*/,
+    std::size_t maxUnacknowledgedEvents_ /*= 1000*/)
     : host(host_)
     , port(port_)
     , serverName(serverName_)
     , ipv6(ipv6_)
+    , acknowledged(acknowledged_)
+    , maxUnacknowledgedEvents((std::max) (maxUnacknowledgedEvents_,
+        std::size_t (1)))
+    , session(generateSession ())
 {
     openSocket();
     initConnector ();
@@ -53,12 +81,19 @@ SocketAppender::SocketAppender(const tstring& host_,
 
 SocketAppender::SocketAppender(const helpers::Properties & properties)
  : Appender(properties),
-   port(9998)
+   port(9998),
+   session(generateSession ())
 {
     host = properties.getProperty( LOG4CPLUS_TEXT("host") );
     properties.getUInt (port, LOG4CPLUS_TEXT("port"));
     serverName = properties.getProperty( LOG4CPLUS_TEXT("ServerName") );
     properties.getBool(ipv6, LOG4CPLUS_TEXT("IPv6"));
+    properties.getBool(acknowledged, LOG4CPLUS_TEXT("Acknowledged"));
+
+    unsigned maxUnacked = 1000;
+    properties.getUInt (maxUnacked,
+        LOG4CPLUS_TEXT("MaxUnacknowledgedEvents"));
+    maxUnacknowledgedEvents = (std::max) (maxUnacked, 1u);
 
     openSocket();
     initConnector ();
@@ -92,6 +127,20 @@ SocketAppender::close()
 }
 
 
+std::size_t
+SocketAppender::getUnacknowledgedEventCount() const
+{
+    return unacknowledgedCount.load (std::memory_order_relaxed);
+}
+
+
+unsigned long long
+SocketAppender::getDroppedEventCount() const
+{
+    return droppedEvents.load (std::memory_order_relaxed);
+}
+
+
 
 //////////////////////////////////////////////////////////////////////////////
 // SocketAppender protected methods
@@ -120,22 +169,34 @@ SocketAppender::initConnector ()
 void
 SocketAppender::append(const spi::InternalLoggingEvent& event)
 {
+    if (acknowledged)
+        readAcknowledgements ();
+
 #if ! defined (LOG4CPLUS_SINGLE_THREADED)
-    if (! connected)
+    bool const online = connected;
+    if (! online)
     {
         connector->trigger ();
-        return;
+        // Unacknowledged events are kept for sending after reconnection.
+        if (! acknowledged)
+            return;
     }
 
 #else
     if(!socket.isOpen()) {
+        partialAcknowledgement.clear ();
         openSocket();
-        if(!socket.isOpen()) {
-            helpers::getLogLog().error(
-                LOG4CPLUS_TEXT(
-                    "SocketAppender::append()- Cannot connect to server"));
+        if (socket.isOpen() && acknowledged)
+            resendUnacknowledged ();
+    }
+
+    bool const online = socket.isOpen();
+    if (! online) {
+        helpers::getLogLog().error(
+            LOG4CPLUS_TEXT(
+                "SocketAppender::append()- Cannot connect to server"));
+        if (! acknowledged)
             return;
-        }
     }
 #endif
 
@@ -144,6 +205,8 @@ SocketAppender::append(const spi::InternalLoggingEvent& event)
 
     try
     {
+        if (acknowledged)
+            helpers::appendSequenceHeader (msgBuffer, session, nextSequence);
         convertToBuffer (msgBuffer, event, serverName);
     }
     catch (std::runtime_error const &)
@@ -154,7 +217,31 @@ SocketAppender::append(const spi::InternalLoggingEvent& event)
     helpers::SocketBuffer buffer(sizeof(unsigned int));
     buffer.appendInt(static_cast<unsigned>(msgBuffer.getSize()));
 
-    bool ret = helpers::Socket::write(socket, buffer, msgBuffer);
+    bool ret;
+    if (acknowledged)
+    {
+        std::string message;
+        message.reserve (buffer.getSize () + msgBuffer.getSize ());
+        message.append (buffer.getBuffer (), buffer.getSize ());
+        message.append (msgBuffer.getBuffer (), msgBuffer.getSize ());
+
+        if (unacknowledged.size () >= maxUnacknowledgedEvents)
+        {
+            unacknowledged.pop_front ();
+            droppedEvents.fetch_add (1, std::memory_order_relaxed);
+        }
+        unacknowledged.emplace_back (nextSequence++, std::move (message));
+        unacknowledgedCount.store (unacknowledged.size (),
+            std::memory_order_relaxed);
+
+        if (! online)
+            return;
+
+        ret = socket.write (unacknowledged.back ().second);
+    }
+    else
+        ret = helpers::Socket::write(socket, buffer, msgBuffer);
+
     if (! ret)
     {
         helpers::getLogLog().error(
@@ -169,6 +256,79 @@ SocketAppender::append(const spi::InternalLoggingEvent& event)
 }
 
 
+void
+SocketAppender::readAcknowledgements ()
+{
+    std::size_t const ackSize
+        = sizeof (unsigned int) + LOG4CPLUS_SEQUENCE_HEADER_SIZE;
+
+    // Only input which has already arrived is read. An acknowledgement
+    // received in part is kept until the rest of it arrives.
+    helpers::SocketBuffer input (16 * ackSize);
+    while (socket.hasPendingInput ())
+    {
+        bool valid = socket.readAvailable (input);
+        if (valid)
+            partialAcknowledgement.append (input.getBuffer (),
+                input.getSize ());
+
+        std::size_t pos = 0;
+        for (; valid && partialAcknowledgement.size () - pos >= ackSize;
+            pos += ackSize)
+        {
+            helpers::SocketBuffer ackBuffer (ackSize);
+            std::memcpy (ackBuffer.getBuffer (),
+                partialAcknowledgement.data () + pos, ackSize);
+            ackBuffer.setSize (ackSize);
+            unsigned int ackSession = 0;
+            unsigned int ackSequence = 0;
+            valid = ackBuffer.readInt () == LOG4CPLUS_SEQUENCE_HEADER_SIZE
+                && helpers::readSequenceHeader (ackBuffer, ackSession,
+                    ackSequence)
+                && ackSession == session;
+            if (! valid)
+                break;
+
+            while (! unacknowledged.empty ()
+                && ! helpers::isSequenceAfter (unacknowledged.front ().first,
+                    ackSequence))
+                unacknowledged.pop_front ();
+        }
+
+        if (! valid)
+        {
+            helpers::getLogLog().error(
+                LOG4CPLUS_TEXT("SocketAppender::readAcknowledgements()")
+                LOG4CPLUS_TEXT("- Connection lost or invalid acknowledgement"));
+
+            partialAcknowledgement.clear ();
+            socket.close ();
+#if ! defined (LOG4CPLUS_SINGLE_THREADED)
+            connected = false;
+            connector->trigger ();
+#endif
+            break;
+        }
+
+        partialAcknowledgement.erase (0, pos);
+    }
+
+    unacknowledgedCount.store (unacknowledged.size (),
+        std::memory_order_relaxed);
+}
+
+
+bool
+SocketAppender::resendUnacknowledged ()
+{
+    for (auto const & message : unacknowledged)
+        if (! socket.write (message.second))
+            return false;
+
+    return true;
+}
+
+
 #if ! defined (LOG4CPLUS_SINGLE_THREADED)
 thread::Mutex const &
 SocketAppender::ctcGetAccessMutex () const
@@ -194,6 +354,17 @@ void
 SocketAppender::ctcSetConnected ()
 {
     connected = true;
+    partialAcknowledgement.clear ();
+
+    if (acknowledged && ! resendUnacknowledged ())
+    {
+        helpers::getLogLog().error(
+            LOG4CPLUS_TEXT(
+                "SocketAppender::ctcSetConnected()- Write failed"));
+
+        connected = false;
+        connector->trigger ();
+    }
 }
 
 #endif
@@ -232,6 +403,18 @@ convertToBuffer(SocketBuffer & buffer,
     buffer.appendString(event.getFile());
     buffer.appendInt(event.getLine());
     buffer.appendString(event.getFunction());
+
+    // Binary payload is an optional trailing field, so that readers which
+    // do not know it ignore it.
+    std::string_view const payload = event.getPayload();
+    if (! payload.empty()) {
+        if (buffer.getPos() + sizeof(unsigned int) + payload.size()
+            <= buffer.getMaxSize())
+            buffer.appendBytes(payload);
+        else
+            getLogLog().warn(LOG4CPLUS_TEXT("convertToBuffer()- binary")
+                LOG4CPLUS_TEXT(" payload does not fit into message, dropped"));
+    }
 }
 
 
@@ -265,17 +448,149 @@ readFromBuffer(SocketBuffer& buffer)
     tstring file = buffer.readString(sizeOfChar);
     int line = buffer.readInt();
     tstring function = buffer.readString(sizeOfChar);
+    std::string payload;
+    if (buffer.getPos() < buffer.getSize())
+        payload = buffer.readBytes();
 
     // TODO: Pass MDC through.
     spi::InternalLoggingEvent ev (loggerName, ll, ndc,
         MappedDiagnosticContextMap (), message, thread, internal::empty_str,
         from_time_t (sec) + chrono::microseconds (usec), file,
         line, function);
+    if (! payload.empty())
+        ev.setPayload(payload.data(), payload.size());
+
     return ev;
 }
 
 
+void
+appendSequenceHeader (SocketBuffer & buffer, unsigned int session,
+    unsigned int sequence)
+{
+    buffer.appendByte (LOG4CPLUS_SEQUENCED_MESSAGE_VERSION);
+    buffer.appendInt (session);
+    buffer.appendInt (sequence);
+}
+
+
+bool
+readSequenceHeader (SocketBuffer & buffer, unsigned int & session,
+    unsigned int & sequence)
+{
+    std::size_t const pos = buffer.getPos ();
+    if (buffer.getSize () - pos < LOG4CPLUS_SEQUENCE_HEADER_SIZE
+        || static_cast<unsigned char>(buffer.getBuffer ()[pos])
+            != LOG4CPLUS_SEQUENCED_MESSAGE_VERSION)
+        return false;
+
+    buffer.readByte ();
+    session = buffer.readInt ();
+    sequence = buffer.readInt ();
+    return true;
+}
+
+
 } // namespace helpers
 
 
+#if defined (LOG4CPLUS_WITH_UNIT_TESTS) \
+    && ! defined (LOG4CPLUS_SINGLE_THREADED)
+namespace
+{
+
+struct SequencedMessage
+{
+    unsigned int session;
+    unsigned int sequence;
+    tstring message;
+};
+
+
+static
+SequencedMessage
+readSequencedMessage (helpers::Socket & socket)
+{
+    SequencedMessage msg {0, 0, tstring ()};
+    helpers::SocketBuffer sizeBuffer (sizeof (unsigned int));
+    CATCH_REQUIRE (socket.read (sizeBuffer));
+    helpers::SocketBuffer msgBuffer (sizeBuffer.readInt ());
+    CATCH_REQUIRE (socket.read (msgBuffer));
+    CATCH_REQUIRE (helpers::readSequenceHeader (msgBuffer, msg.session,
+        msg.sequence));
+    msg.message = helpers::readFromBuffer (msgBuffer).getMessage ();
+    return msg;
+}
+
+} // namespace
+
+
+CATCH_TEST_CASE ("SocketAppender acknowledged mode", "[socketappender]")
+{
+    helpers::ServerSocket server (0, false, false,
+        LOG4CPLUS_TEXT ("127.0.0.1"));
+    unsigned short const port = server.getLocalPort ();
+    if (! server.isOpen () || port == 0)
+    {
+        CATCH_WARN ("SocketAppender test skipped, cannot listen");
+        return;
+    }
+
+    SocketAppender appender (LOG4CPLUS_TEXT ("127.0.0.1"), port, tstring (),
+        false, true);
+    helpers::Socket conn = server.accept ();
+    CATCH_REQUIRE (conn.isOpen ());
+
+    auto log = [&appender] (tchar const * msg)
+    {
+        spi::InternalLoggingEvent ev (LOG4CPLUS_TEXT ("ack"),
+            INFO_LOG_LEVEL, msg, nullptr, 0);
+        appender.doAppend (ev);
+    };
+
+    log (LOG4CPLUS_TEXT ("1"));
+    log (LOG4CPLUS_TEXT ("2"));
+    SequencedMessage const first = readSequencedMessage (conn);
+    SequencedMessage const second = readSequencedMessage (conn);
+    CATCH_REQUIRE (first.message == LOG4CPLUS_TEXT ("1"));
+    CATCH_REQUIRE (second.session == first.session);
+    CATCH_REQUIRE (second.sequence == first.sequence + 1);
+    CATCH_REQUIRE (appender.getUnacknowledgedEventCount () == 2);
+
+    // Acknowledge only the first event, in two parts. The appender does
+    // not wait for the rest of the acknowledgement.
+    helpers::SocketBuffer ack (sizeof (unsigned int)
+        + LOG4CPLUS_SEQUENCE_HEADER_SIZE);
+    ack.appendInt (LOG4CPLUS_SEQUENCE_HEADER_SIZE);
+    helpers::appendSequenceHeader (ack, first.session, first.sequence);
+    std::string const ack_bytes (ack.getBuffer (), ack.getSize ());
+    CATCH_REQUIRE (conn.write (ack_bytes.substr (0, 5)));
+    std::this_thread::sleep_for (std::chrono::milliseconds (50));
+    log (LOG4CPLUS_TEXT ("3"));
+    CATCH_REQUIRE (readSequencedMessage (conn).message
+        == LOG4CPLUS_TEXT ("3"));
+    CATCH_REQUIRE (appender.getUnacknowledgedEventCount () == 3);
+
+    // Complete the acknowledgement and drop the connection.
+    CATCH_REQUIRE (conn.write (ack_bytes.substr (5)));
+    conn.close ();
+
+    // The second and third events are sent again after reconnection,
+    // followed by the one logged while disconnected.
+    log (LOG4CPLUS_TEXT ("4"));
+    CATCH_REQUIRE (appender.getUnacknowledgedEventCount () == 3);
+    conn = server.accept ();
+    CATCH_REQUIRE (readSequencedMessage (conn).message
+        == LOG4CPLUS_TEXT ("2"));
+    CATCH_REQUIRE (readSequencedMessage (conn).message
+        == LOG4CPLUS_TEXT ("3"));
+    CATCH_REQUIRE (readSequencedMessage (conn).message
+        == LOG4CPLUS_TEXT ("4"));
+    CATCH_REQUIRE (appender.getDroppedEventCount () == 0);
+
+    appender.close ();
+}
+#endif
+
+
 } // namespace log4cplus
@@ -192,6 +192,25 @@ SocketBuffer::readString(unsigned char sizeOfChar)
 
 
 
+std::string
+SocketBuffer::readBytes()
+{
+    std::size_t len = readInt();
+    if(len == 0) {
+        return std::string();
+    }
+    if((pos + len) > maxsize) {
+        getLogLog().error(LOG4CPLUS_TEXT("SocketBuffer::readBytes()- Attempt to read beyond end of buffer"));
+        len = maxsize - pos;
+    }
+
+    std::string ret(&buffer[pos], len);
+    pos += len;
+    return ret;
+}
+
+
+
 void
 SocketBuffer::appendByte(unsigned char val)
 {
@@ -292,6 +311,26 @@ SocketBuffer::appendBuffer(const SocketBuffer& buf)
 }
 
 
+
+void
+SocketBuffer::appendBytes(std::string_view bytes)
+{
+    if((pos + sizeof(unsigned int) + bytes.size()) > maxsize)
+    {
+        getLogLog().error(
+            LOG4CPLUS_TEXT("SocketBuffer::appendBytes()-")
+            LOG4CPLUS_TEXT(" Attempt to write beyond end of buffer"),
+            true);
+        return;
+    }
+
+    appendInt(static_cast<unsigned>(bytes.size()));
+    std::memcpy(&buffer[pos], bytes.data(), bytes.size());
+    pos += bytes.size();
+    size = pos;
+}
+
+
 #if defined (LOG4CPLUS_WITH_UNIT_TESTS)
 CATCH_TEST_CASE ("SocketBuffer", "[sockets]")
 {
@@ -0,0 +1,479 @@
+// -*- C++ -*-
+//
+//  Copyright (C) 2026, Vaclav Zeman. All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without modifica-
+//  tion, are permitted provided that the following conditions are met:
+//
+//  1. Redistributions of  source code must  retain the above copyright  notice,
+//     this list of conditions and the following disclaimer.
+//
+//  2. Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//
+//  THIS SOFTWARE IS PROVIDED ``AS IS'' AND ANY EXPRESSED OR IMPLIED WARRANTIES,
+//  INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+//  FITNESS  FOR A PARTICULAR  PURPOSE ARE  DISCLAIMED.  IN NO  EVENT SHALL  THE
+//  APACHE SOFTWARE  FOUNDATION  OR ITS CONTRIBUTORS  BE LIABLE FOR  ANY DIRECT,
+//  INDIRECT, INCIDENTAL, SPECIAL,  EXEMPLARY, OR CONSEQUENTIAL  DAMAGES (INCLU-
+//  DING, BUT NOT LIMITED TO, PROCUREMENT  OF SUBSTITUTE GOODS OR SERVICES; LOSS
+//  OF USE, DATA, OR  PROFITS; OR BUSINESS  INTERRUPTION)  HOWEVER CAUSED AND ON
+//  ANY  THEORY OF LIABILITY,  WHETHER  IN CONTRACT,  STRICT LIABILITY,  OR TORT
+//  (INCLUDING  NEGLIGENCE OR  OTHERWISE) ARISING IN  ANY WAY OUT OF THE  USE OF
+//  THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <log4cplus/sockethubappender.h>
+
+#ifndef LOG4CPLUS_SINGLE_THREADED
+
+#include <log4cplus/socketappender.h>
+#include <log4cplus/spi/loggingevent.h>
+#include <log4cplus/helpers/housekeeping.h>
+#include <log4cplus/helpers/loglog.h>
+#include <log4cplus/helpers/property.h>
+#include <log4cplus/helpers/stringhelper.h>
+#include <log4cplus/thread/threads.h>
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <stdexcept>
+#include <string>
+
+#if defined (LOG4CPLUS_WITH_UNIT_TESTS)
+#include <catch.hpp>
+#endif
+
+
+namespace log4cplus
+{
+
+
+//! Connected client with its own queue and sending thread.
+class SocketHubAppender::Client
+{
+public:
+    using message_ptr = std::shared_ptr<std::string const>;
+
+    Client (helpers::Socket sock, std::size_t max_queued,
+        bool drop_when_full);
+    ~Client ();
+
+    //! Queues message for sending.
+    //! \return False if the client should be disconnected.
+    bool push (message_ptr const & msg,
+        std::atomic<unsigned long long> & dropped);
+
+    //! \return False if sending to the client has failed.
+    bool isAlive () const
+    {
+        return ! failed.load (std::memory_order_relaxed);
+    }
+
+    //! Stops sending thread and closes the connection.
+    void stop ();
+
+private:
+    void run ();
+
+    helpers::Socket socket;
+    std::size_t const max_queued;
+    bool const drop_when_full;
+
+    std::mutex mtx;
+    std::condition_variable cond;
+    std::deque<message_ptr> queue;
+    bool exit_flag;
+    std::atomic<bool> failed;
+    std::thread thread;
+};
+
+
+SocketHubAppender::Client::Client (helpers::Socket sock,
+    std::size_t max_queued_, bool drop_when_full_)
+    : socket (std::move (sock))
+    , max_queued ((std::max) (max_queued_, std::size_t (1)))
+    , drop_when_full (drop_when_full_)
+    , exit_flag (false)
+    , failed (false)
+{
+    thread::SignalsBlocker sb;
+    thread = std::thread ([this] { run (); });
+}
+
+
+SocketHubAppender::Client::~Client ()
+{
+    stop ();
+}
+
+
+bool
+SocketHubAppender::Client::push (message_ptr const & msg,
+    std::atomic<unsigned long long> & dropped)
+{
+    if (! isAlive ())
+        return false;
+
+    {
+        std::lock_guard<std::mutex> lock (mtx);
+        if (queue.size () >= max_queued)
+        {
+            if (drop_when_full)
+            {
+                // The queued events and this one are lost with the client.
+                dropped.fetch_add (queue.size () + 1,
+                    std::memory_order_relaxed);
+                failed.store (true, std::memory_order_relaxed);
+                return false;
+            }
+
+            // Let this client lag behind by dropping its oldest event.
+            queue.pop_front ();
+            dropped.fetch_add (1, std::memory_order_relaxed);
+        }
+
+        queue.push_back (msg);
+    }
+    cond.notify_one ();
+
+    return true;
+}
+
+
+void
+SocketHubAppender::Client::stop ()
+{
+    {
+        std::lock_guard<std::mutex> lock (mtx);
+        exit_flag = true;
+    }
+    cond.notify_one ();
+
+    // Unblock sending thread stuck in write to unresponsive client.
+    socket.shutdown ();
+
+    if (thread.joinable ())
+        thread.join ();
+
+    socket.close ();
+}
+
+
+void
+SocketHubAppender::Client::run ()
+{
+    std::deque<message_ptr> batch;
+    while (true)
+    {
+        {
+            std::unique_lock<std::mutex> lock (mtx);
+            cond.wait (lock, [this] { return exit_flag || ! queue.empty (); });
+            if (exit_flag)
+                return;
+
+            batch.swap (queue);
+        }
+
+        for (message_ptr const & msg : batch)
+        {
+            if (! socket.write (*msg))
+            {
+                helpers::getLogLog ().debug (
+                    LOG4CPLUS_TEXT ("SocketHubAppender- client disconnected"));
+                failed.store (true, std::memory_order_relaxed);
+                return;
+            }
+        }
+
+        batch.clear ();
+    }
+}
+
+
+//////////////////////////////////////////////////////////////////////////////
+// SocketHubAppender ctors and dtor
+//////////////////////////////////////////////////////////////////////////////
+
+SocketHubAppender::SocketHubAppender (unsigned short port_,
+    tstring const & serverName_, bool ipv6_, std::size_t maxQueuedEvents_,
+    bool dropSlowClients_)
+    : port (port_)
+    , serverName (serverName_)
+    , ipv6 (ipv6_)
+    , maxQueuedEvents (maxQueuedEvents_)
+    , dropSlowClients (dropSlowClients_)
+    , stopping (false)
+    , reaperTask (0)
+    , clientCount (0)
+    , droppedEvents (0)
+{
+    start (tstring ());
+}
+
+
+SocketHubAppender::SocketHubAppender (helpers::Properties const & props)
+    : Appender (props)
+    , port (4560)
+    , ipv6 (false)
+    , maxQueuedEvents (1000)
+    , dropSlowClients (false)
+    , stopping (false)
+    , reaperTask (0)
+    , clientCount (0)
+    , droppedEvents (0)
+{
+    unsigned int uport = port;
+    props.getUInt (uport, LOG4CPLUS_TEXT ("port"));
+    port = static_cast<unsigned short>(uport);
+    serverName = props.getProperty (LOG4CPLUS_TEXT ("ServerName"));
+    props.getBool (ipv6, LOG4CPLUS_TEXT ("IPv6"));
+    unsigned int max_queued = static_cast<unsigned int>(maxQueuedEvents);
+    props.getUInt (max_queued, LOG4CPLUS_TEXT ("MaxQueuedEvents"));
+    maxQueuedEvents = max_queued;
+    props.getBool (dropSlowClients, LOG4CPLUS_TEXT ("DropSlowClients"));
+
+    start (props.getProperty (LOG4CPLUS_TEXT ("host")));
+}
+
+
+SocketHubAppender::~SocketHubAppender ()
+{
+    destructorImpl ();
+}
+
+
+//////////////////////////////////////////////////////////////////////////////
+// SocketHubAppender public methods
+//////////////////////////////////////////////////////////////////////////////
+
+void
+SocketHubAppender::close ()
+{
+    helpers::getLogLog ().debug (
+        LOG4CPLUS_TEXT ("Entering SocketHubAppender::close()..."));
+
+    stopping = true;
+    if (serverSocket)
+        serverSocket->interruptAccept ();
+
+    if (acceptThread.joinable ())
+        acceptThread.join ();
+
+    helpers::cancelHousekeepingTask (reaperTask);
+    retireClients (true);
+    reapClients ();
+
+    if (serverSocket)
+        serverSocket->close ();
+
+    closed = true;
+}
+
+
+unsigned
+SocketHubAppender::getRequiredThreadSpecificData () const
+{
+    return getLayoutRequiredThreadSpecificData ()
+        | spi::InternalLoggingEvent::TSD_NDC
+        | spi::InternalLoggingEvent::TSD_THREAD;
+}
+
+
+unsigned short
+SocketHubAppender::getPort () const
+{
+    return port;
+}
+
+
+std::size_t
+SocketHubAppender::getClientCount () const
+{
+    return clientCount.load (std::memory_order_acquire);
+}
+
+
+unsigned long long
+SocketHubAppender::getDroppedEventCount () const
+{
+    return droppedEvents.load (std::memory_order_relaxed);
+}
+
+
+//////////////////////////////////////////////////////////////////////////////
+// SocketHubAppender protected and private methods
+//////////////////////////////////////////////////////////////////////////////
+
+void
+SocketHubAppender::append (spi::InternalLoggingEvent const & event)
+{
+    // Do not serialize events nobody is listening to.
+    if (clientCount.load (std::memory_order_acquire) == 0)
+        return;
+
+    helpers::SocketBuffer msgBuffer (LOG4CPLUS_MAX_MESSAGE_SIZE
+        - sizeof (unsigned int));
+
+    try
+    {
+        helpers::convertToBuffer (msgBuffer, event, serverName);
+    }
+    catch (std::runtime_error const &)
+    {
+        return;
+    }
+
+    helpers::SocketBuffer sizeBuffer (sizeof (unsigned int));
+    sizeBuffer.appendInt (static_cast<unsigned>(msgBuffer.getSize ()));
+
+    auto msg = std::make_shared<std::string> ();
+    msg->reserve (sizeBuffer.getSize () + msgBuffer.getSize ());
+    msg->append (sizeBuffer.getBuffer (), sizeBuffer.getSize ());
+    msg->append (msgBuffer.getBuffer (), msgBuffer.getSize ());
+    Client::message_ptr const shared (std::move (msg));
+
+    bool disconnect = false;
+    {
+        std::lock_guard<std::mutex> lock (clientsMutex);
+        for (auto const & client : clients)
+            disconnect |= ! client->push (shared, droppedEvents);
+    }
+
+    // Joining the clients' threads is left to the reaper task, so that it
+    // does not happen while the appender is locked.
+    if (disconnect)
+        retireClients (false);
+}
+
+
+void
+SocketHubAppender::start (tstring const & host)
+{
+    serverSocket = std::make_unique<helpers::ServerSocket> (port, false, ipv6,
+        host);
+    if (! serverSocket->isOpen ())
+    {
+        helpers::getLogLog ().error (
+            LOG4CPLUS_TEXT ("SocketHubAppender- Cannot listen on port ")
+            + helpers::convertIntegerToString (port));
+        return;
+    }
+
+    if (port == 0)
+        port = serverSocket->getLocalPort ();
+
+    thread::SignalsBlocker sb;
+    acceptThread = std::thread ([this] { acceptLoop (); });
+    reaperTask = helpers::scheduleHousekeepingTask (std::chrono::seconds (1),
+        [this] { reapClients (); });
+}
+
+
+void
+SocketHubAppender::acceptLoop ()
+{
+    while (! stopping)
+    {
+        helpers::Socket sock = serverSocket->accept ();
+        if (! sock.isOpen ())
+        {
+            if (! stopping)
+            {
+                helpers::getLogLog ().error (
+                    LOG4CPLUS_TEXT ("SocketHubAppender- accept() failed"));
+                std::this_thread::sleep_for (std::chrono::milliseconds (100));
+            }
+
+            continue;
+        }
+
+        helpers::getLogLog ().debug (
+            LOG4CPLUS_TEXT ("SocketHubAppender- client connected"));
+
+        retireClients (false);
+        reapClients ();
+
+        auto client = std::make_shared<Client> (std::move (sock),
+            maxQueuedEvents, dropSlowClients);
+        std::lock_guard<std::mutex> lock (clientsMutex);
+        clients.push_back (std::move (client));
+        clientCount.store (clients.size (), std::memory_order_release);
+    }
+}
+
+
+void
+SocketHubAppender::retireClients (bool all)
+{
+    std::lock_guard<std::mutex> lock (clientsMutex);
+    auto const dead = all
+        ? clients.begin ()
+        : std::stable_partition (clients.begin (), clients.end (),
+            [] (std::shared_ptr<Client> const & client)
+            { return client->isAlive (); });
+    retiredClients.insert (retiredClients.end (),
+        std::make_move_iterator (dead),
+        std::make_move_iterator (clients.end ()));
+    clients.erase (dead, clients.end ());
+    clientCount.store (clients.size (), std::memory_order_release);
+}
+
+
+void
+SocketHubAppender::reapClients ()
+{
+    std::vector<std::shared_ptr<Client> > removed;
+    {
+        std::lock_guard<std::mutex> lock (clientsMutex);
+        removed.swap (retiredClients);
+    }
+
+    // Stop the removed clients' threads outside of the lock.
+    for (auto const & client : removed)
+        client->stop ();
+}
+
+
+#if defined (LOG4CPLUS_WITH_UNIT_TESTS)
+CATCH_TEST_CASE ("SocketHubAppender", "[sockethub]")
+{
+    SocketHubAppender hub (0);
+    unsigned short const port = hub.getPort ();
+    if (port == 0)
+    {
+        CATCH_WARN ("SocketHubAppender test skipped, cannot listen");
+        return;
+    }
+    CATCH_REQUIRE (hub.getClientCount () == 0);
+
+    helpers::Socket viewer (LOG4CPLUS_TEXT ("127.0.0.1"), port);
+    CATCH_REQUIRE (viewer.isOpen ());
+    for (int i = 0; i != 500 && hub.getClientCount () == 0; ++i)
+        std::this_thread::sleep_for (std::chrono::milliseconds (10));
+    CATCH_REQUIRE (hub.getClientCount () == 1);
+
+    spi::InternalLoggingEvent ev (LOG4CPLUS_TEXT ("hub"),
+        INFO_LOG_LEVEL, LOG4CPLUS_TEXT ("live tail"), nullptr, 0);
+    hub.doAppend (ev);
+
+    helpers::SocketBuffer sizeBuffer (sizeof (unsigned int));
+    CATCH_REQUIRE (viewer.read (sizeBuffer));
+    helpers::SocketBuffer msgBuffer (sizeBuffer.readInt ());
+    CATCH_REQUIRE (viewer.read (msgBuffer));
+    spi::InternalLoggingEvent const received
+        = helpers::readFromBuffer (msgBuffer);
+    CATCH_REQUIRE (received.getLoggerName () == LOG4CPLUS_TEXT ("hub"));
+    CATCH_REQUIRE (received.getMessage () == LOG4CPLUS_TEXT ("live tail"));
+    CATCH_REQUIRE (hub.getDroppedEventCount () == 0);
+
+    hub.close ();
+    CATCH_REQUIRE (hub.getClientCount () == 0);
+}
+#endif
+
+
+} // namespace log4cplus
+
+#endif // LOG4CPLUS_SINGLE_THREADED
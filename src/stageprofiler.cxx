@@ -0,0 +1,344 @@
+// -*- C++ -*-
+//
+//  Copyright (C) 2026, Vaclav Zeman. All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without modifica-
+//  tion, are permitted provided that the following conditions are met:
+//
+//  1. Redistributions of  source code must  retain the above copyright  notice,
+//     this list of conditions and the following disclaimer.
+//
+//  2. Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//
+//  THIS SOFTWARE IS PROVIDED ``AS IS'' AND ANY EXPRESSED OR IMPLIED WARRANTIES,
+//  INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+//  FITNESS  FOR A PARTICULAR  PURPOSE ARE  DISCLAIMED.  IN NO  EVENT SHALL  THE
+//  APACHE SOFTWARE  FOUNDATION  OR ITS CONTRIBUTORS  BE LIABLE FOR  ANY DIRECT,
+//  INDIRECT, INCIDENTAL, SPECIAL,  EXEMPLARY, OR CONSEQUENTIAL  DAMAGES (INCLU-
+//  DING, BUT NOT LIMITED TO, PROCUREMENT  OF SUBSTITUTE GOODS OR SERVICES; LOSS
+//  OF USE, DATA, OR  PROFITS; OR BUSINESS  INTERRUPTION)  HOWEVER CAUSED AND ON
+//  ANY  THEORY OF LIABILITY,  WHETHER  IN CONTRACT,  STRICT LIABILITY,  OR TORT
+//  (INCLUDING  NEGLIGENCE OR  OTHERWISE) ARISING IN  ANY WAY OUT OF THE  USE OF
+//  THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <log4cplus/helpers/stageprofiler.h>
+#include <log4cplus/internal/internal.h>
+#include <log4cplus/thread/syncprims-pub-impl.h>
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+#if defined (LOG4CPLUS_WITH_UNIT_TESTS)
+#include <log4cplus/hierarchy.h>
+#include <log4cplus/logger.h>
+#include <log4cplus/loggingmacros.h>
+#include <log4cplus/nullappender.h>
+#include <catch.hpp>
+#endif
+
+
+namespace log4cplus {
+
+
+#if defined (LOG4CPLUS_ENABLE_STAGE_PROFILER)
+
+namespace internal {
+
+
+std::atomic<unsigned> stage_profiler_interval (64);
+
+
+namespace {
+
+
+//! Names of stages in the order of profiled_stage.
+static tchar const * const stage_names[STAGE_COUNT] = {
+    LOG4CPLUS_TEXT ("enabled check"),
+    LOG4CPLUS_TEXT ("message build"),
+    LOG4CPLUS_TEXT ("event construction"),
+    LOG4CPLUS_TEXT ("filter"),
+    LOG4CPLUS_TEXT ("lock wait"),
+    LOG4CPLUS_TEXT ("layout"),
+    LOG4CPLUS_TEXT ("sink I/O")};
+
+
+//! Accumulators of live threads and totals of finished threads.
+struct stage_profiler_registry
+{
+    thread::Mutex mutex;
+    std::vector<stage_profiler_data *> threads;
+    stage_table loggers;
+    stage_table appenders;
+};
+
+
+static
+stage_profiler_registry &
+get_registry ()
+{
+    // Intentionally leaked; threads can end after static destructors
+    // have run.
+    static stage_profiler_registry * const registry
+        = new stage_profiler_registry;
+    return *registry;
+}
+
+
+static
+void
+merge (stage_table & dest, stage_table const & src)
+{
+    for (auto const & row : src)
+    {
+        stage_row & dest_row = dest[row.first];
+        for (std::size_t i = 0; i != STAGE_COUNT; ++i)
+        {
+            dest_row[i].samples += row.second[i].samples;
+            dest_row[i].ticks += row.second[i].ticks;
+        }
+    }
+}
+
+
+static
+void
+dump_table (tostream & os, tchar const * kind, stage_table const & table,
+    std::uint64_t total)
+{
+    for (auto const & row : table)
+        for (std::size_t i = 0; i != STAGE_COUNT; ++i)
+        {
+            stage_stats const & stats = row.second[i];
+            if (stats.samples == 0)
+                continue;
+
+            os << std::left << std::setw (9) << kind
+                << std::setw (30) << row.first
+                << std::setw (20) << stage_names[i]
+                << std::right << std::setw (10) << stats.samples
+                << std::setw (14) << stats.ticks / stats.samples
+                << std::setw (7) << std::fixed << std::setprecision (1)
+                << (total ? 100.0 * stats.ticks / total : 0.0)
+                << LOG4CPLUS_TEXT ('%') << std::endl;
+        }
+}
+
+
+static
+std::uint64_t
+total_ticks (stage_table const & table)
+{
+    std::uint64_t total = 0;
+    for (auto const & row : table)
+        for (stage_stats const & stats : row.second)
+            total += stats.ticks;
+    return total;
+}
+
+
+} // namespace
+
+
+stage_profiler_data::stage_profiler_data ()
+    : countdown (stage_profiler_interval.load (std::memory_order_relaxed))
+    , sampling (false)
+    , mark (0)
+    , layout_ticks (0)
+{
+    stage_profiler_registry & registry = get_registry ();
+    thread::MutexGuard guard (registry.mutex);
+    registry.threads.push_back (this);
+}
+
+
+stage_profiler_data::~stage_profiler_data ()
+{
+    stage_profiler_registry & registry = get_registry ();
+    thread::MutexGuard guard (registry.mutex);
+    registry.threads.erase (std::find (registry.threads.begin (),
+        registry.threads.end (), this));
+    merge (registry.loggers, loggers);
+    merge (registry.appenders, appenders);
+}
+
+
+void
+stage_profiler_data::record (stage_table & table, tstring const & name,
+    profiled_stage stage, std::uint64_t ticks)
+{
+    thread::MutexGuard guard (mutex);
+    stage_stats & stats = table[name][stage];
+    stats.samples += 1;
+    stats.ticks += ticks;
+}
+
+
+void
+dump_stage_profile_at_exit ()
+{
+    bool empty;
+    {
+        stage_profiler_registry & registry = get_registry ();
+        thread::MutexGuard guard (registry.mutex);
+        empty = registry.loggers.empty () && registry.appenders.empty ()
+            && std::all_of (registry.threads.begin (), registry.threads.end (),
+                [] (stage_profiler_data * data) {
+                    thread::MutexGuard data_guard (data->mutex);
+                    return data->loggers.empty ()
+                        && data->appenders.empty (); });
+    }
+
+    if (! empty)
+        helpers::dumpStageProfile (tcerr);
+}
+
+
+} // namespace internal
+
+
+namespace helpers {
+
+
+bool
+isStageProfilerEnabled ()
+{
+    return true;
+}
+
+
+void
+setStageProfilerSampleInterval (unsigned interval)
+{
+    interval = (std::max) (interval, 1u);
+    internal::stage_profiler_interval.store (interval,
+        std::memory_order_relaxed);
+    internal::get_ptd ()->profiler.countdown = interval;
+}
+
+
+void
+resetStageProfile ()
+{
+    internal::stage_profiler_registry & registry = internal::get_registry ();
+    thread::MutexGuard guard (registry.mutex);
+    registry.loggers.clear ();
+    registry.appenders.clear ();
+    for (internal::stage_profiler_data * data : registry.threads)
+    {
+        thread::MutexGuard data_guard (data->mutex);
+        data->loggers.clear ();
+        data->appenders.clear ();
+    }
+}
+
+
+void
+dumpStageProfile (tostream & os)
+{
+    internal::stage_table loggers;
+    internal::stage_table appenders;
+    {
+        internal::stage_profiler_registry & registry
+            = internal::get_registry ();
+        thread::MutexGuard guard (registry.mutex);
+        loggers = registry.loggers;
+        appenders = registry.appenders;
+        for (internal::stage_profiler_data * data : registry.threads)
+        {
+            thread::MutexGuard data_guard (data->mutex);
+            internal::merge (loggers, data->loggers);
+            internal::merge (appenders, data->appenders);
+        }
+    }
+
+    std::uint64_t const total = internal::total_ticks (loggers)
+        + internal::total_ticks (appenders);
+
+    std::ios_base::fmtflags const flags = os.flags ();
+    os << LOG4CPLUS_TEXT ("log4cplus stage profile, 1 in ")
+        << internal::stage_profiler_interval.load (std::memory_order_relaxed)
+        << LOG4CPLUS_TEXT (" events sampled") << std::endl
+        << std::left << std::setw (9) << LOG4CPLUS_TEXT ("kind")
+        << std::setw (30) << LOG4CPLUS_TEXT ("name")
+        << std::setw (20) << LOG4CPLUS_TEXT ("stage")
+        << std::right << std::setw (10) << LOG4CPLUS_TEXT ("samples")
+        << std::setw (14) << LOG4CPLUS_TEXT ("avg ticks")
+        << std::setw (8) << LOG4CPLUS_TEXT ("share") << std::endl;
+    internal::dump_table (os, LOG4CPLUS_TEXT ("logger"), loggers, total);
+    internal::dump_table (os, LOG4CPLUS_TEXT ("appender"), appenders, total);
+    os.flags (flags);
+}
+
+
+} // namespace helpers
+
+
+#if defined (LOG4CPLUS_WITH_UNIT_TESTS)
+CATCH_TEST_CASE ("Stage profiler", "[stageprofiler]")
+{
+    Hierarchy h;
+    Logger logger = h.getInstance (LOG4CPLUS_TEXT ("profiled"));
+    SharedAppenderPtr app (new NullAppender);
+    app->setName (LOG4CPLUS_TEXT ("null"));
+    logger.addAppender (app);
+
+    helpers::setStageProfilerSampleInterval (1);
+    helpers::resetStageProfile ();
+    for (int i = 0; i != 10; ++i)
+        LOG4CPLUS_INFO (logger, LOG4CPLUS_TEXT ("message ") << i);
+    helpers::setStageProfilerSampleInterval (64);
+
+    tostringstream oss;
+    helpers::dumpStageProfile (oss);
+    tstring const profile = oss.str ();
+    CATCH_REQUIRE (profile.find (LOG4CPLUS_TEXT ("profiled")) != tstring::npos);
+    CATCH_REQUIRE (profile.find (LOG4CPLUS_TEXT ("message build"))
+        != tstring::npos);
+    CATCH_REQUIRE (profile.find (LOG4CPLUS_TEXT ("null")) != tstring::npos);
+    CATCH_REQUIRE (profile.find (LOG4CPLUS_TEXT ("sink I/O"))
+        != tstring::npos);
+
+    helpers::resetStageProfile ();
+    h.shutdown ();
+}
+#endif
+
+#else // defined (LOG4CPLUS_ENABLE_STAGE_PROFILER)
+
+namespace helpers {
+
+
+bool
+isStageProfilerEnabled ()
+{
+    return false;
+}
+
+
+void
+setStageProfilerSampleInterval (unsigned)
+{ }
+
+
+void
+resetStageProfile ()
+{ }
+
+
+void
+dumpStageProfile (tostream & os)
+{
+    os << LOG4CPLUS_TEXT ("log4cplus has been built without")
+        LOG4CPLUS_TEXT (" LOG4CPLUS_ENABLE_STAGE_PROFILER") << std::endl;
+}
+
+
+} // namespace helpers
+
+#endif // defined (LOG4CPLUS_ENABLE_STAGE_PROFILER)
+
+
+} // namespace log4cplus
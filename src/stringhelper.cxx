@@ -240,6 +240,96 @@ toLower(const tstring_view& s)
 }
 
 
+namespace
+{
+
+//! Pairs of hexadecimal digits of all byte values, so that each byte is
+//! encoded with a single table look up.
+struct hex_table
+{
+    constexpr
+    hex_table ()
+        : digits ()
+    {
+        char const hex[] = "0123456789abcdef";
+        for (unsigned i = 0; i != 256; ++i)
+        {
+            digits[i * 2] = hex[i >> 4];
+            digits[i * 2 + 1] = hex[i & 0xF];
+        }
+    }
+
+    char digits[512];
+};
+
+constexpr hex_table hex_digits;
+
+char const base64_digits[]
+    = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+} // namespace
+
+
+void
+appendHex (tstring & result, void const * data, std::size_t size)
+{
+    auto const * in = static_cast<unsigned char const *>(data);
+    std::size_t const pos = result.size ();
+    result.resize (pos + size * 2);
+    tchar * out = &result[pos];
+
+    for (std::size_t i = 0; i != size; ++i)
+    {
+        char const * digits = &hex_digits.digits[in[i] * 2];
+        out[i * 2] = static_cast<tchar>(digits[0]);
+        out[i * 2 + 1] = static_cast<tchar>(digits[1]);
+    }
+}
+
+
+void
+appendBase64 (tstring & result, void const * data, std::size_t size)
+{
+    auto const * in = static_cast<unsigned char const *>(data);
+    std::size_t const pos = result.size ();
+    result.resize (pos + (size + 2) / 3 * 4);
+    tchar * out = &result[pos];
+
+    auto const digit = [] (unsigned long group, unsigned shift)
+    {
+        return static_cast<tchar>(base64_digits[(group >> shift) & 0x3F]);
+    };
+
+    // Whole groups of three bytes first, then the padded tail.
+    std::size_t const whole = size / 3;
+    for (std::size_t i = 0; i != whole; ++i)
+    {
+        unsigned char const * b = in + i * 3;
+        unsigned long const group = (static_cast<unsigned long>(b[0]) << 16)
+            | (static_cast<unsigned long>(b[1]) << 8) | b[2];
+        out[i * 4] = digit (group, 18);
+        out[i * 4 + 1] = digit (group, 12);
+        out[i * 4 + 2] = digit (group, 6);
+        out[i * 4 + 3] = digit (group, 0);
+    }
+
+    std::size_t const rest = size - whole * 3;
+    if (rest != 0)
+    {
+        in += whole * 3;
+        out += whole * 4;
+        unsigned long group = static_cast<unsigned long>(in[0]) << 16;
+        if (rest == 2)
+            group |= static_cast<unsigned long>(in[1]) << 8;
+
+        out[0] = digit (group, 18);
+        out[1] = digit (group, 12);
+        out[2] = rest == 2 ? digit (group, 6) : LOG4CPLUS_TEXT ('=');
+        out[3] = LOG4CPLUS_TEXT ('=');
+    }
+}
+
+
 #if defined (LOG4CPLUS_WITH_UNIT_TESTS)
 
 namespace
@@ -510,6 +600,27 @@ CATCH_TEST_CASE( "Strings helpers", "[strings]" )
             CATCH_REQUIRE (result == LOG4CPLUS_TEXT ("1,2,3"));
         }
     }
+
+    CATCH_SECTION ("binary encoders")
+    {
+        unsigned char const bytes[] = { 0x00, 0x7f, 0xab, 0xff, 'a' };
+        tstring result;
+
+        appendHex (result, bytes, sizeof (bytes));
+        CATCH_REQUIRE (result == LOG4CPLUS_TEXT ("007fabff61"));
+
+        char const text[] = "foobar";
+        tstring const expected[] = { LOG4CPLUS_TEXT (""),
+            LOG4CPLUS_TEXT ("Zg=="), LOG4CPLUS_TEXT ("Zm8="),
+            LOG4CPLUS_TEXT ("Zm9v"), LOG4CPLUS_TEXT ("Zm9vYg=="),
+            LOG4CPLUS_TEXT ("Zm9vYmE="), LOG4CPLUS_TEXT ("Zm9vYmFy") };
+        for (std::size_t i = 0; i != 7; ++i)
+        {
+            result.clear ();
+            appendBase64 (result, text, i);
+            CATCH_REQUIRE (result == expected[i]);
+        }
+    }
 }
 #endif
 
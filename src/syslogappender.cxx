@@ -26,11 +26,27 @@
 #include <log4cplus/internal/internal.h>
 #include <log4cplus/internal/env.h>
 #include <log4cplus/thread/syncprims-pub-impl.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
 #include <cstring>
+#include <ctime>
+#include <vector>
+
+#if defined (LOG4CPLUS_WITH_UNIT_TESTS)
+#include <catch.hpp>
+#endif
 
 #if defined (LOG4CPLUS_HAVE_SYSLOG_H)
 #include <syslog.h>
 
+#if defined (LOG4CPLUS_HAVE_SYS_SOCKET_H)
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#define LOG4CPLUS_SYSLOG_LOCAL_SOCKET
+#endif
+
 #else // LOG4CPLUS_HAVE_SYSLOG_H
 
 // The following bits were derived from SUSv4 documentation and
@@ -92,6 +108,15 @@ useIdent (const std::string& string)
 }
 
 
+//! Default value of LocalSocket property.
+static tchar const default_local_socket[] =
+#if defined (__linux__)
+    LOG4CPLUS_TEXT ("/dev/log");
+#else
+    LOG4CPLUS_TEXT ("");
+#endif
+
+
 #ifdef LOG_USER
 int const fallback_facility = LOG_USER;
 
@@ -232,7 +257,8 @@ SysLogAppender::SysLogAppender(const tstring& id)
     , identStr(LOG4CPLUS_TSTRING_TO_STRING (id) )
     , hostname (helpers::getHostname (true))
 {
-    ::openlog(useIdent(identStr), 0, 0);
+    localSocketPath = default_local_socket;
+    initLocal ();
 }
 
 #endif
@@ -263,8 +289,10 @@ SysLogAppender::SysLogAppender(const helpers::Properties & properties)
     if (host.empty ())
     {
 #if defined (LOG4CPLUS_HAVE_SYSLOG_H)
-        appendFunc = &SysLogAppender::appendLocal;
-        ::openlog(useIdent(identStr), 0, 0);
+        localSocketPath = default_local_socket;
+        properties.getString (localSocketPath,
+            LOG4CPLUS_TEXT ("LocalSocket"));
+        initLocal ();
 
 #else
         helpers::getLogLog ().error (
@@ -328,7 +356,10 @@ SysLogAppender::close()
     if (host.empty ())
     {
 #if defined (LOG4CPLUS_HAVE_SYSLOG_H)
-        ::closelog();
+        if (appendFunc == &SysLogAppender::appendLocalSocket)
+            closeLocalSocket ();
+        else
+            ::closelog();
 #endif
     }
     else
@@ -343,6 +374,13 @@ SysLogAppender::close()
 }
 
 
+unsigned
+SysLogAppender::getRequiredThreadSpecificData() const
+{
+    return getLayoutRequiredThreadSpecificData ();
+}
+
+
 
 ///////////////////////////////////////////////////////////////////////////////
 // SysLogAppender protected methods
@@ -380,17 +418,238 @@ SysLogAppender::append(const spi::InternalLoggingEvent& event)
 }
 
 
+void
+SysLogAppender::appendBatch(spi::InternalLoggingEvent const * const * events,
+    std::size_t count)
+{
+#if defined (LOG4CPLUS_HAVE_SYSLOG_H)
+    if (appendFunc == &SysLogAppender::appendLocalSocket)
+    {
+        std::vector<std::string> datagrams (count);
+        for (std::size_t i = 0; i != count; ++i)
+            formatLocalDatagram (datagrams[i], *events[i]);
+
+        sendLocalDatagrams (datagrams.data (), count);
+        return;
+    }
+#endif
+
+    Appender::appendBatch (events, count);
+}
+
+
 #if defined (LOG4CPLUS_HAVE_SYSLOG_H)
 void
 SysLogAppender::appendLocal(const spi::InternalLoggingEvent& event)
 {
     int const level = getSysLogLevel(event.getLogLevel());
-    internal::appender_sratch_pad & appender_sp = internal::get_appender_sp ();
-    detail::clear_tostringstream (appender_sp.oss);
-    layout->formatAndAppend(appender_sp.oss, event);
-    appender_sp.str = appender_sp.oss.str ();
+    tstring const & str = formatEvent (event);
     ::syslog(facility | level, "%s",
-        LOG4CPLUS_TSTRING_TO_STRING(appender_sp.str).c_str());
+        LOG4CPLUS_TSTRING_TO_STRING(str).c_str());
+}
+
+
+void
+SysLogAppender::appendLocalSocket(const spi::InternalLoggingEvent& event)
+{
+    internal::appender_sratch_pad & appender_sp = internal::get_appender_sp ();
+    formatLocalDatagram (appender_sp.chstr, event);
+    sendLocalDatagrams (&appender_sp.chstr, 1);
+}
+
+
+void
+SysLogAppender::initLocal ()
+{
+    if (! localSocketPath.empty () && openLocalSocket ())
+    {
+        appendFunc = &SysLogAppender::appendLocalSocket;
+
+        if (! identStr.empty ())
+            localTag = identStr;
+#if defined (__GLIBC__)
+        else
+            localTag = program_invocation_short_name;
+#endif
+        if (! localTag.empty ())
+            localTag += ": ";
+    }
+    else
+    {
+        appendFunc = &SysLogAppender::appendLocal;
+        ::openlog(useIdent(identStr), 0, 0);
+    }
+}
+
+
+bool
+SysLogAppender::openLocalSocket ()
+{
+#if defined (LOG4CPLUS_SYSLOG_LOCAL_SOCKET)
+    closeLocalSocket ();
+
+    std::string const path = LOG4CPLUS_TSTRING_TO_STRING (localSocketPath);
+    struct sockaddr_un addr;
+    std::memset (&addr, 0, sizeof (addr));
+    if (path.size () >= sizeof (addr.sun_path))
+        return false;
+
+    addr.sun_family = AF_UNIX;
+    std::memcpy (addr.sun_path, path.c_str (), path.size ());
+
+    int type = SOCK_DGRAM;
+#if defined (SOCK_CLOEXEC)
+    type |= SOCK_CLOEXEC;
+#endif
+    int const fd = ::socket (AF_UNIX, type, 0);
+    if (fd == -1)
+        return false;
+
+    if (::connect (fd, reinterpret_cast<struct sockaddr *>(&addr),
+            sizeof (addr)) != 0)
+    {
+        ::close (fd);
+        return false;
+    }
+
+    localSocket = fd;
+    return true;
+
+#else
+    return false;
+
+#endif
+}
+
+
+void
+SysLogAppender::closeLocalSocket ()
+{
+#if defined (LOG4CPLUS_SYSLOG_LOCAL_SOCKET)
+    if (localSocket != -1)
+    {
+        ::close (localSocket);
+        localSocket = -1;
+    }
+#endif
+}
+
+
+void
+SysLogAppender::formatLocalDatagram (std::string & datagram,
+    const spi::InternalLoggingEvent& event)
+{
+    static char const months[12][4] = {
+        "Jan", "Feb", "Mar", "Apr", "May", "Jun",
+        "Jul", "Aug", "Sep", "Oct", "Nov", "Dec" };
+
+    // The timestamp changes only once per second.
+    long long const second = helpers::to_time_t (event.getTimestamp ());
+    if (second != localHeaderTime)
+    {
+        tm t;
+        helpers::localTime (&t, event.getTimestamp ());
+        char buf[32];
+        std::snprintf (buf, sizeof (buf), "%s %2d %02d:%02d:%02d ",
+            months[t.tm_mon % 12], t.tm_mday, t.tm_hour, t.tm_min,
+            t.tm_sec);
+        localHeaderTimestamp = buf;
+        localHeaderTime = second;
+    }
+
+    int pri = facility | getSysLogLevel (event.getLogLevel ());
+    // Like syslog(), use LOG_USER when no facility is given.
+    if ((pri & ~LOG_PRIMASK) == 0)
+        pri |= LOG_USER;
+
+    char prefix[16];
+    std::snprintf (prefix, sizeof (prefix), "<%d>", pri);
+
+    tstring const & str = formatEvent (event);
+    datagram.assign (prefix);
+    datagram += localHeaderTimestamp;
+    datagram += localTag;
+#if defined (UNICODE)
+    datagram += LOG4CPLUS_TSTRING_TO_STRING (str);
+#else
+    datagram += str;
+#endif
+}
+
+
+void
+SysLogAppender::sendLocalDatagrams (std::string const * datagrams,
+    std::size_t count)
+{
+#if defined (LOG4CPLUS_SYSLOG_LOCAL_SOCKET)
+#if defined (MSG_NOSIGNAL)
+    int const flags = MSG_NOSIGNAL;
+#else
+    int const flags = 0;
+#endif
+
+    bool reopened = false;
+    std::size_t sent = 0;
+    while (sent != count)
+    {
+        int ret;
+#if defined (__linux__)
+        // Send up to max_batch datagrams with single system call.
+        std::size_t const max_batch = 64;
+        struct mmsghdr msgs[max_batch];
+        struct iovec iovs[max_batch];
+        std::size_t const batch = (std::min) (count - sent, max_batch);
+        std::memset (msgs, 0, sizeof (msgs[0]) * batch);
+        for (std::size_t i = 0; i != batch; ++i)
+        {
+            std::string const & datagram = datagrams[sent + i];
+            iovs[i].iov_base = const_cast<char *>(datagram.data ());
+            iovs[i].iov_len = datagram.size ();
+            msgs[i].msg_hdr.msg_iov = &iovs[i];
+            msgs[i].msg_hdr.msg_iovlen = 1;
+        }
+
+        while ((ret = ::sendmmsg (localSocket, msgs,
+                    static_cast<unsigned>(batch), flags)) == -1
+            && errno == EINTR)
+            ;
+
+#else
+        std::string const & datagram = datagrams[sent];
+        ssize_t res;
+        while ((res = ::send (localSocket, datagram.data (),
+                    datagram.size (), flags)) == -1
+            && errno == EINTR)
+            ;
+        ret = res == -1 ? -1 : 1;
+
+#endif
+        if (ret > 0)
+        {
+            sent += static_cast<std::size_t>(ret);
+            continue;
+        }
+
+        // The syslog daemon might have been restarted. Try to reconnect
+        // once.
+        if (! reopened && openLocalSocket ())
+        {
+            reopened = true;
+            continue;
+        }
+
+        helpers::getLogLog ().warn (
+            LOG4CPLUS_TEXT ("SysLogAppender")
+            LOG4CPLUS_TEXT ("- failed to write to local syslog socket ")
+            + localSocketPath);
+        return;
+    }
+
+#else
+    (void) datagrams;
+    (void) count;
+
+#endif
 }
 
 #endif
@@ -424,6 +683,9 @@ SysLogAppender::appendRemote(const spi::InternalLoggingEvent& event)
 #endif
     }
 
+    static helpers::TimeFormatter const remoteTimeFormatter (
+        remoteTimeFormat);
+
     int const level = getSysLogLevel(event.getLogLevel());
     internal::appender_sratch_pad & appender_sp = internal::get_appender_sp ();
     detail::clear_tostringstream (appender_sp.oss);
@@ -435,8 +697,7 @@ SysLogAppender::appendRemote(const spi::InternalLoggingEvent& event)
         << 1
         // TIMESTAMP
         << LOG4CPLUS_TEXT (' ')
-        << helpers::getFormattedTime (remoteTimeFormat, event.getTimestamp (),
-            true)
+        << remoteTimeFormatter.format (event.getTimestamp (), true)
         // HOSTNAME
         << LOG4CPLUS_TEXT (' ') << hostname
         // APP-NAME
@@ -450,7 +711,7 @@ SysLogAppender::appendRemote(const spi::InternalLoggingEvent& event)
         << LOG4CPLUS_TEXT (" - ");
 
     // MSG
-    layout->formatAndAppend (appender_sp.oss, event);
+    formatAndAppend (appender_sp.oss, event);
 
     appender_sp.chstr = LOG4CPLUS_TSTRING_TO_STRING (appender_sp.oss.str ());
 
@@ -539,4 +800,64 @@ SysLogAppender::openSocket ()
 }
 
 
+#if defined (LOG4CPLUS_WITH_UNIT_TESTS) \
+    && defined (LOG4CPLUS_SYSLOG_LOCAL_SOCKET)
+CATCH_TEST_CASE ("SysLogAppender local socket", "[syslog]")
+{
+    std::string const path = "log4cplus-syslog-test-"
+        + helpers::convertIntegerToNarrowString (internal::get_process_id ())
+        + ".sock";
+    ::unlink (path.c_str ());
+
+    int const fd = ::socket (AF_UNIX, SOCK_DGRAM, 0);
+    CATCH_REQUIRE (fd != -1);
+    struct sockaddr_un addr;
+    std::memset (&addr, 0, sizeof (addr));
+    addr.sun_family = AF_UNIX;
+    std::strcpy (addr.sun_path, path.c_str ());
+    CATCH_REQUIRE (::bind (fd, reinterpret_cast<struct sockaddr *>(&addr),
+            sizeof (addr)) == 0);
+
+    auto receive = [fd]
+    {
+        char buf[1024];
+        ssize_t const size = ::recv (fd, buf, sizeof (buf), 0);
+        return std::string (buf, size > 0 ? size : 0);
+    };
+
+    helpers::Properties props;
+    props.setProperty (LOG4CPLUS_TEXT ("ident"), LOG4CPLUS_TEXT ("test"));
+    props.setProperty (LOG4CPLUS_TEXT ("facility"),
+        LOG4CPLUS_TEXT ("local0"));
+    props.setProperty (LOG4CPLUS_TEXT ("LocalSocket"),
+        LOG4CPLUS_STRING_TO_TSTRING (path));
+    SysLogAppender appender (props);
+
+    spi::InternalLoggingEvent const ev1 (LOG4CPLUS_TEXT ("syslog"),
+        INFO_LOG_LEVEL, LOG4CPLUS_TEXT ("first"), nullptr, 0);
+    spi::InternalLoggingEvent const ev2 (LOG4CPLUS_TEXT ("syslog"),
+        ERROR_LOG_LEVEL, LOG4CPLUS_TEXT ("second"), nullptr, 0);
+
+    appender.doAppend (ev1);
+    std::string datagram = receive ();
+    // <PRI>Mmm dd hh:mm:ss TAG: MSG
+    CATCH_REQUIRE (datagram.compare (0, 5, "<134>") == 0);
+    CATCH_REQUIRE (datagram.size () > 21);
+    CATCH_REQUIRE (datagram.compare (21, 6, "test: ") == 0);
+    CATCH_REQUIRE (datagram.find ("first") != std::string::npos);
+
+    spi::InternalLoggingEvent const * const events[] = { &ev1, &ev2 };
+    appender.doAppendBatch (events, 2);
+    CATCH_REQUIRE (receive ().find ("first") != std::string::npos);
+    datagram = receive ();
+    CATCH_REQUIRE (datagram.compare (0, 5, "<131>") == 0);
+    CATCH_REQUIRE (datagram.find ("second") != std::string::npos);
+
+    appender.close ();
+    ::close (fd);
+    ::unlink (path.c_str ());
+}
+#endif
+
+
 } // namespace log4cplus
@@ -29,6 +29,8 @@
 #include <iomanip>
 #include <cassert>
 #include <cerrno>
+#include <clocale>
+#include <cstring>
 #if defined (UNICODE)
 #include <cwchar>
 #endif
@@ -55,6 +57,10 @@
 
 #include <log4cplus/config/windowsh-inc.h>
 
+#if defined (LOG4CPLUS_WITH_UNIT_TESTS)
+#include <catch.hpp>
+#endif
+
 
 namespace log4cplus::helpers {
 
@@ -126,193 +132,580 @@ namespace
 {
 
 
-static log4cplus::tstring const padding_zeros[4] =
+//! Operations of TimeFormatter.
+enum TimeFormatterOperationCode
+{
+    TFO_LITERAL,
+    TFO_STRFTIME,
+    TFO_YEAR,
+    TFO_CENTURY,
+    TFO_YEAR2,
+    TFO_MONTH,
+    TFO_DAY,
+    TFO_DAY_SPACE,
+    TFO_HOUR24,
+    TFO_HOUR12,
+    TFO_MINUTE,
+    TFO_SECOND,
+    TFO_DAY_OF_YEAR,
+    TFO_WEEKDAY_MON1,
+    TFO_WEEKDAY_SUN0,
+    TFO_WEEKDAY_ABBR,
+    TFO_WEEKDAY_NAME,
+    TFO_MONTH_ABBR,
+    TFO_MONTH_NAME,
+    TFO_AM_PM,
+    TFO_TZ_OFFSET,
+    TFO_EPOCH,
+    TFO_MILLIS,
+    TFO_MICROS
+};
+
+
+static tchar const * const weekday_names[7] =
 {
-    { LOG4CPLUS_TEXT("000") },
-    { LOG4CPLUS_TEXT("00") },
-    { LOG4CPLUS_TEXT("0") },
-    { }
+    LOG4CPLUS_TEXT ("Sunday"), LOG4CPLUS_TEXT ("Monday"),
+    LOG4CPLUS_TEXT ("Tuesday"), LOG4CPLUS_TEXT ("Wednesday"),
+    LOG4CPLUS_TEXT ("Thursday"), LOG4CPLUS_TEXT ("Friday"),
+    LOG4CPLUS_TEXT ("Saturday")
 };
 
 
-static log4cplus::tstring const uc_q_padding_zeros[4] =
+static tchar const * const month_names[12] =
 {
-    { LOG4CPLUS_TEXT(".000") },
-    { LOG4CPLUS_TEXT(".00") },
-    { LOG4CPLUS_TEXT(".0") },
-    { LOG4CPLUS_TEXT(".") }
+    LOG4CPLUS_TEXT ("January"), LOG4CPLUS_TEXT ("February"),
+    LOG4CPLUS_TEXT ("March"), LOG4CPLUS_TEXT ("April"),
+    LOG4CPLUS_TEXT ("May"), LOG4CPLUS_TEXT ("June"),
+    LOG4CPLUS_TEXT ("July"), LOG4CPLUS_TEXT ("August"),
+    LOG4CPLUS_TEXT ("September"), LOG4CPLUS_TEXT ("October"),
+    LOG4CPLUS_TEXT ("November"), LOG4CPLUS_TEXT ("December")
 };
 
 
+//! Appends decimal representation of <code>value</code> padded to
+//! <code>width</code> characters using <code>pad</code>.
 static
 void
-build_q_value (log4cplus::tstring & q_str, long tv_usec)
+append_number (log4cplus::tstring & result, long long value, int width,
+    tchar pad = LOG4CPLUS_TEXT ('0'))
 {
-    convertIntegerToString(q_str, tv_usec / 1000);
-    std::size_t const len = q_str.length();
-    if (len <= 2)
-        q_str.insert (0, padding_zeros[q_str.length()]);
+    tchar digits[24];
+    tchar * const end = digits + sizeof (digits) / sizeof (digits[0]);
+    tchar * it = end;
+    unsigned long long uvalue = value < 0
+        ? 0ull - static_cast<unsigned long long>(value)
+        : static_cast<unsigned long long>(value);
+    do
+    {
+        *--it = static_cast<tchar>(LOG4CPLUS_TEXT ('0') + uvalue % 10);
+        uvalue /= 10;
+    }
+    while (uvalue != 0);
+
+    if (value < 0)
+        *--it = LOG4CPLUS_TEXT ('-');
+
+    for (auto len = end - it; len < width; ++len)
+        result.push_back (pad);
+
+    result.append (it, end);
 }
 
 
 static
 void
-build_uc_q_value (log4cplus::tstring & uc_q_str, long tv_usec,
-    log4cplus::tstring & tmp)
+append_name (log4cplus::tstring & result, tchar const * name, bool abbrev)
 {
-    build_q_value (uc_q_str, tv_usec);
+    if (abbrev)
+        result.append (name, 3);
+    else
+        result.append (name);
+}
+
 
-    convertIntegerToString(tmp, tv_usec % 1000);
-    std::size_t const usecs_len = tmp.length();
-    tmp.insert (0, usecs_len <= 3
-        ? uc_q_padding_zeros[usecs_len] : uc_q_padding_zeros[3]);
-    uc_q_str.append (tmp);
+static
+std::size_t
+tstrftime (tchar * buffer, std::size_t size, tchar const * spec,
+    tm const * time)
+{
+#if defined (UNICODE)
+    return helpers::wcsftime (buffer, size, spec, time);
+#else
+    return helpers::strftime (buffer, size, spec, time);
+#endif
+}
+
+
+//! Formats single conversion specification using strftime(). The
+//! specification is prefixed by a space, so that empty output of the
+//! conversion is not mistaken for an error.
+static
+void
+append_strftime (log4cplus::tstring & result, tchar const * spec,
+    tm const & time)
+{
+    tchar buffer[256];
+    errno = 0;
+    std::size_t len = tstrftime (buffer, sizeof (buffer) / sizeof (buffer[0]),
+        spec, &time);
+    if (len != 0)
+    {
+        result.append (buffer + 1, len - 1);
+        return;
+    }
+
+    // The output does not fit into the buffer. Limit how far can the
+    // buffer grow, some implementations of strftime() signal both too
+    // small buffer and invalid format string by returning 0 without
+    // changing errno.
+    std::vector<tchar> large_buffer;
+    for (std::size_t size = 1024; size <= 16 * 1024; size *= 2)
+    {
+        large_buffer.resize (size);
+        errno = 0;
+        len = tstrftime (&large_buffer[0], size, spec, &time);
+        if (len != 0)
+        {
+            result.append (&large_buffer[1], len - 1);
+            return;
+        }
+    }
+
+    int const eno = errno;
+    getLogLog ().error (LOG4CPLUS_TEXT ("Error in strftime(): ")
+        + convertIntegerToString (eno));
+}
+
+
+//! \return True if the locale used by strftime() for names is "C".
+static
+bool
+is_c_time_locale ()
+{
+    char const * const name = std::setlocale (LC_TIME, nullptr);
+    return name
+        && (std::strcmp (name, "C") == 0 || std::strcmp (name, "POSIX") == 0);
 }
 
 
 } // namespace
 
 
-log4cplus::tstring
-getFormattedTime(const log4cplus::tstring& fmt_orig,
-    Time const & the_time, bool use_gmtime)
+TimeFormatter::TimeFormatter ()
+    : needs_tm (false)
+    , needs_locale (false)
+{ }
+
+
+TimeFormatter::TimeFormatter (log4cplus::tstring const & fmt_)
+    : needs_tm (false)
+    , needs_locale (false)
 {
-    if (fmt_orig.empty () || fmt_orig[0] == 0)
-        return log4cplus::tstring ();
+    setFormat (fmt_);
+}
 
-    tm time;
 
-    if (use_gmtime)
-        gmTime (&time, the_time);
-    else
-        localTime (&time, the_time);
+TimeFormatter::~TimeFormatter () = default;
 
-    enum State
+
+void
+TimeFormatter::setFormat (log4cplus::tstring const & fmt_)
+{
+    fmt = fmt_;
+    literals.clear ();
+    ops.clear ();
+    needs_tm = false;
+    needs_locale = false;
+    compile (fmt);
+}
+
+
+void
+TimeFormatter::addLiteral (tchar ch)
+{
+    if (ops.empty () || ops.back ().code != TFO_LITERAL
+        || ops.back ().offset + ops.back ().length != literals.size ())
+        ops.push_back (Operation {TFO_LITERAL, literals.size (), 0});
+
+    literals.push_back (ch);
+    ops.back ().length += 1;
+}
+
+
+void
+TimeFormatter::addOperation (int code, log4cplus::tstring const & spec)
+{
+    Operation op {code, 0, 0};
+    if (code == TFO_STRFTIME || code == TFO_WEEKDAY_ABBR
+        || code == TFO_WEEKDAY_NAME || code == TFO_MONTH_ABBR
+        || code == TFO_MONTH_NAME || code == TFO_AM_PM)
     {
-        TEXT,
-        PERCENT_SIGN
-    };
+        // Specification is stored prefixed for append_strftime() and
+        // with terminating NUL for strftime().
+        op.offset = literals.size ();
+        op.length = spec.size () + 1;
+        literals.push_back (LOG4CPLUS_TEXT (' '));
+        literals.append (spec);
+        literals.push_back (0);
+    }
 
-    internal::gft_scratch_pad & gft_sp = internal::get_gft_scratch_pad ();
-    gft_sp.reset ();
+    if (code != TFO_STRFTIME && op.length != 0)
+        needs_locale = true;
 
-    std::size_t const fmt_orig_size = gft_sp.fmt.size ();
-    gft_sp.ret.reserve (fmt_orig_size + fmt_orig_size / 3);
-    State state = TEXT;
+    if (code != TFO_EPOCH && code != TFO_MILLIS && code != TFO_MICROS)
+        needs_tm = true;
 
-    // Walk the format string and process all occurences of %q, %Q and %s.
+    ops.push_back (op);
+}
 
-    long const tv_usec = microseconds_part (the_time);
-    time_t const tv_sec = to_time_t (the_time);
-    for (auto fmt_ch : fmt_orig)
+
+void
+TimeFormatter::compile (log4cplus::tstring const & format)
+{
+    std::size_t const size = format.size ();
+    for (std::size_t i = 0; i != size; ++i)
     {
-        switch (state)
+        tchar ch = format[i];
+        if (ch == 0)
+            // strftime() would stop here.
+            return;
+        else if (ch != LOG4CPLUS_TEXT ('%'))
         {
-        case TEXT:
+            addLiteral (ch);
+            continue;
+        }
+
+        // Skip flags, field width and E and O modifiers. Specifications
+        // using them are always passed to strftime().
+        std::size_t const spec_start = i++;
+        while (i != size
+            && (format[i] == LOG4CPLUS_TEXT ('_')
+                || format[i] == LOG4CPLUS_TEXT ('-')
+                || format[i] == LOG4CPLUS_TEXT ('^')
+                || format[i] == LOG4CPLUS_TEXT ('#')
+                || format[i] == LOG4CPLUS_TEXT ('E')
+                || format[i] == LOG4CPLUS_TEXT ('O')
+                || (format[i] >= LOG4CPLUS_TEXT ('0')
+                    && format[i] <= LOG4CPLUS_TEXT ('9'))))
+            ++i;
+
+        // Trailing incomplete specification is kept as it is.
+        if (i == size || format[i] == 0)
         {
-            if (fmt_ch == LOG4CPLUS_TEXT ('%'))
-                state = PERCENT_SIGN;
-            else
-                gft_sp.ret.push_back (fmt_ch);
+            for (std::size_t j = spec_start; j != i; ++j)
+                addLiteral (format[j]);
+
+            return;
         }
-        break;
 
-        case PERCENT_SIGN:
+        tstring const spec (format, spec_start, i + 1 - spec_start);
+        if (spec.size () != 2)
         {
-            switch (fmt_ch)
-            {
-            case LOG4CPLUS_TEXT ('q'):
-            {
-                if (! gft_sp.q_str_valid)
-                {
-                    build_q_value (gft_sp.q_str, tv_usec);
-                    gft_sp.q_str_valid = true;
-                }
-                gft_sp.ret.append (gft_sp.q_str);
-                state = TEXT;
-            }
+            addOperation (TFO_STRFTIME, spec);
+            continue;
+        }
+
+        switch (format[i])
+        {
+        case LOG4CPLUS_TEXT ('%'): addLiteral (LOG4CPLUS_TEXT ('%')); break;
+        case LOG4CPLUS_TEXT ('n'): addLiteral (LOG4CPLUS_TEXT ('\n')); break;
+        case LOG4CPLUS_TEXT ('t'): addLiteral (LOG4CPLUS_TEXT ('\t')); break;
+        case LOG4CPLUS_TEXT ('Y'): addOperation (TFO_YEAR, spec); break;
+        case LOG4CPLUS_TEXT ('C'): addOperation (TFO_CENTURY, spec); break;
+        case LOG4CPLUS_TEXT ('y'): addOperation (TFO_YEAR2, spec); break;
+        case LOG4CPLUS_TEXT ('m'): addOperation (TFO_MONTH, spec); break;
+        case LOG4CPLUS_TEXT ('d'): addOperation (TFO_DAY, spec); break;
+        case LOG4CPLUS_TEXT ('e'): addOperation (TFO_DAY_SPACE, spec); break;
+        case LOG4CPLUS_TEXT ('H'): addOperation (TFO_HOUR24, spec); break;
+        case LOG4CPLUS_TEXT ('I'): addOperation (TFO_HOUR12, spec); break;
+        case LOG4CPLUS_TEXT ('M'): addOperation (TFO_MINUTE, spec); break;
+        case LOG4CPLUS_TEXT ('S'): addOperation (TFO_SECOND, spec); break;
+        case LOG4CPLUS_TEXT ('j'): addOperation (TFO_DAY_OF_YEAR, spec); break;
+        case LOG4CPLUS_TEXT ('u'): addOperation (TFO_WEEKDAY_MON1, spec); break;
+        case LOG4CPLUS_TEXT ('w'): addOperation (TFO_WEEKDAY_SUN0, spec); break;
+        case LOG4CPLUS_TEXT ('z'): addOperation (TFO_TZ_OFFSET, spec); break;
+
+        // Windows do not support %s format specifier
+        // (seconds since epoch).
+        case LOG4CPLUS_TEXT ('s'): addOperation (TFO_EPOCH, spec); break;
+        case LOG4CPLUS_TEXT ('q'): addOperation (TFO_MILLIS, spec); break;
+        case LOG4CPLUS_TEXT ('Q'): addOperation (TFO_MICROS, spec); break;
+
+        case LOG4CPLUS_TEXT ('F'):
+            compile (LOG4CPLUS_TEXT ("%Y-%m-%d"));
             break;
 
-            case LOG4CPLUS_TEXT ('Q'):
-            {
-                if (! gft_sp.uc_q_str_valid)
-                {
-                    build_uc_q_value (gft_sp.uc_q_str, tv_usec, gft_sp.tmp);
-                    gft_sp.uc_q_str_valid = true;
-                }
-                gft_sp.ret.append (gft_sp.uc_q_str);
-                state = TEXT;
-            }
+        case LOG4CPLUS_TEXT ('T'):
+            compile (LOG4CPLUS_TEXT ("%H:%M:%S"));
             break;
 
-            // Windows do not support %s format specifier
-            // (seconds since epoch).
-            case LOG4CPLUS_TEXT ('s'):
-            {
-                if (! gft_sp.s_str_valid)
-                {
-                    convertIntegerToString (gft_sp.s_str, tv_sec);
-                    gft_sp.s_str_valid = true;
-                }
-                gft_sp.ret.append (gft_sp.s_str);
-                state = TEXT;
-            }
+        case LOG4CPLUS_TEXT ('R'):
+            compile (LOG4CPLUS_TEXT ("%H:%M"));
             break;
 
-            default:
-            {
-                gft_sp.ret.push_back (LOG4CPLUS_TEXT ('%'));
-                gft_sp.ret.push_back (fmt_ch);
-                state = TEXT;
-            }
-            }
-        }
-        break;
+        case LOG4CPLUS_TEXT ('D'):
+            compile (LOG4CPLUS_TEXT ("%m/%d/%y"));
+            break;
+
+        // Names depend on locale, they are formatted directly only while
+        // LC_TIME is the "C" locale.
+        case LOG4CPLUS_TEXT ('a'): addOperation (TFO_WEEKDAY_ABBR, spec); break;
+        case LOG4CPLUS_TEXT ('A'): addOperation (TFO_WEEKDAY_NAME, spec); break;
+        case LOG4CPLUS_TEXT ('b'):
+        case LOG4CPLUS_TEXT ('h'): addOperation (TFO_MONTH_ABBR, spec); break;
+        case LOG4CPLUS_TEXT ('B'): addOperation (TFO_MONTH_NAME, spec); break;
+        case LOG4CPLUS_TEXT ('p'): addOperation (TFO_AM_PM, spec); break;
+
+        default:
+            addOperation (TFO_STRFTIME, spec);
         }
     }
+}
+
 
-    // Finally call strftime/wcsftime to format the rest of the string.
+void
+TimeFormatter::append (log4cplus::tstring & result, Time const & the_time,
+    bool use_gmtime) const
+{
+    tm time {};
+    if (needs_tm)
+    {
+        if (use_gmtime)
+            gmTime (&time, the_time);
+        else
+            localTime (&time, the_time);
+    }
 
-    gft_sp.fmt.swap (gft_sp.ret);
-    std::size_t buffer_size = gft_sp.fmt.size () + 1;
-    std::size_t len;
+    time_t const tv_sec = to_time_t (the_time);
+    long const tv_usec = microseconds_part (the_time);
+    long long const year = time.tm_year + 1900LL;
 
-    // Limit how far can the buffer grow. This is necessary so that we
-    // catch bad format string. Some implementations of strftime() signal
-    // both too small buffer and invalid format string by returning 0
-    // without changing errno.
-    std::size_t const buffer_size_max
-        = (std::max) (static_cast<std::size_t>(1024), buffer_size * 16);
-    
-    buffer_size = (std::max) (buffer_size, gft_sp.buffer.capacity());
+    // The locale is checked on each call, so that setlocale() after the
+    // format has been compiled is respected.
+    bool const c_locale = needs_locale && is_c_time_locale ();
 
-    do
+    for (Operation const & op : ops)
     {
-        gft_sp.buffer.resize (buffer_size);
-        errno = 0;
-#ifdef UNICODE
-        len = helpers::wcsftime(&gft_sp.buffer[0], buffer_size,
-            gft_sp.fmt.c_str(), &time);
-#else
-        len = helpers::strftime(&gft_sp.buffer[0], buffer_size,
-            gft_sp.fmt.c_str(), &time);
-#endif
-        if (len == 0)
+        switch (op.code)
         {
-            int const eno = errno;
-            buffer_size *= 2;
-            if (buffer_size > buffer_size_max)
+        case TFO_LITERAL:
+            result.append (literals, op.offset, op.length);
+            break;
+
+        case TFO_STRFTIME:
+            append_strftime (result, literals.c_str () + op.offset, time);
+            break;
+
+        case TFO_YEAR:
+            append_number (result, year, 1);
+            break;
+
+        case TFO_CENTURY:
+            append_number (result, year / 100, 2);
+            break;
+
+        case TFO_YEAR2:
+            append_number (result, (year % 100 + 100) % 100, 2);
+            break;
+
+        case TFO_MONTH:
+            append_number (result, time.tm_mon + 1, 2);
+            break;
+
+        case TFO_DAY:
+            append_number (result, time.tm_mday, 2);
+            break;
+
+        case TFO_DAY_SPACE:
+            append_number (result, time.tm_mday, 2, LOG4CPLUS_TEXT (' '));
+            break;
+
+        case TFO_HOUR24:
+            append_number (result, time.tm_hour, 2);
+            break;
+
+        case TFO_HOUR12:
+            append_number (result,
+                time.tm_hour % 12 == 0 ? 12 : time.tm_hour % 12, 2);
+            break;
+
+        case TFO_MINUTE:
+            append_number (result, time.tm_min, 2);
+            break;
+
+        case TFO_SECOND:
+            append_number (result, time.tm_sec, 2);
+            break;
+
+        case TFO_DAY_OF_YEAR:
+            append_number (result, time.tm_yday + 1, 3);
+            break;
+
+        case TFO_WEEKDAY_MON1:
+            append_number (result, time.tm_wday == 0 ? 7 : time.tm_wday, 1);
+            break;
+
+        case TFO_WEEKDAY_SUN0:
+            append_number (result, time.tm_wday, 1);
+            break;
+
+        case TFO_WEEKDAY_ABBR:
+        case TFO_WEEKDAY_NAME:
+        case TFO_MONTH_ABBR:
+        case TFO_MONTH_NAME:
+        case TFO_AM_PM:
+            if (! c_locale)
             {
-                LogLog::getLogLog ()->error (
-                    LOG4CPLUS_TEXT("Error in strftime(): ")
-                    + convertIntegerToString (eno), true);
+                append_strftime (result, literals.c_str () + op.offset, time);
+                break;
             }
+
+            if (op.code == TFO_AM_PM)
+                result.append (time.tm_hour < 12
+                    ? LOG4CPLUS_TEXT ("AM") : LOG4CPLUS_TEXT ("PM"));
+            else if (op.code == TFO_MONTH_ABBR || op.code == TFO_MONTH_NAME)
+                append_name (result, month_names[time.tm_mon % 12],
+                    op.code == TFO_MONTH_ABBR);
+            else
+                append_name (result, weekday_names[time.tm_wday % 7],
+                op.code == TFO_WEEKDAY_ABBR);
+            break;
+
+        case TFO_TZ_OFFSET:
+        {
+            // Offset is the difference between broken-down time
+            // interpreted as UTC and the actual time.
+            long long const local_secs
+                = internal::days_from_civil (year, time.tm_mon + 1,
+                    time.tm_mday) * 86400
+                + time.tm_hour * 3600 + time.tm_min * 60 + time.tm_sec;
+            long long const offset = (local_secs - tv_sec) / 60;
+            long long const abs_offset = offset < 0 ? -offset : offset;
+            result.push_back (offset < 0
+                ? LOG4CPLUS_TEXT ('-') : LOG4CPLUS_TEXT ('+'));
+            append_number (result, abs_offset / 60, 2);
+            append_number (result, abs_offset % 60, 2);
+            break;
+        }
+
+        case TFO_EPOCH:
+            append_number (result, tv_sec, 1);
+            break;
+
+        case TFO_MILLIS:
+            append_number (result, tv_usec / 1000, 3);
+            break;
+
+        case TFO_MICROS:
+            append_number (result, tv_usec / 1000, 3);
+            result.push_back (LOG4CPLUS_TEXT ('.'));
+            append_number (result, tv_usec % 1000, 3);
+            break;
         }
     }
-    while (len == 0);
+}
+
+
+log4cplus::tstring
+TimeFormatter::format (Time const & the_time, bool use_gmtime) const
+{
+    log4cplus::tstring result;
+    append (result, the_time, use_gmtime);
+    return result;
+}
+
+
+log4cplus::tstring
+getFormattedTime(const log4cplus::tstring& fmt,
+    Time const & the_time, bool use_gmtime)
+{
+    if (fmt.empty () || fmt[0] == 0)
+        return log4cplus::tstring ();
+
+    // The most recently used format is kept compiled.
+    internal::gft_scratch_pad & gft_sp = internal::get_gft_scratch_pad ();
+    if (gft_sp.formatter.getFormat () != fmt)
+        gft_sp.formatter.setFormat (fmt);
+
+    return gft_sp.formatter.format (the_time, use_gmtime);
+}
+
+
+#if defined (LOG4CPLUS_WITH_UNIT_TESTS)
+CATCH_TEST_CASE ("TimeFormatter", "[timeformatter]")
+{
+    static time_t const times[] = {
+        0,
+        // 2000-02-29 00:00:00 UTC
+        951782400,
+        // 2009-02-13 23:31:30 UTC
+        1234567890,
+        // 2020-12-31 23:59:59 UTC
+        1609459199,
+        // 2023-11-14 22:13:20 UTC
+        1700000000,
+        // 2024-07-07 12:34:56 UTC
+        1720355696
+    };
+
+    CATCH_SECTION ("parity with strftime")
+    {
+        static tchar const * const formats[] = {
+            LOG4CPLUS_TEXT ("%Y-%m-%d %H:%M:%S"),
+            LOG4CPLUS_TEXT ("%C %y %e %I %j %u %w"),
+            LOG4CPLUS_TEXT ("%a %A %b %h %B %p"),
+            LOG4CPLUS_TEXT ("%z"),
+            LOG4CPLUS_TEXT ("%F %T %R %D"),
+            LOG4CPLUS_TEXT ("%n%t%%"),
+            LOG4CPLUS_TEXT ("%c|%x|%X|%Z|%U|%W"),
+            LOG4CPLUS_TEXT ("text %d.%m. text")
+        };
+
+        for (auto fmt : formats)
+            for (auto t : times)
+                for (bool use_gmtime : {true, false})
+                {
+                    tm time;
+                    if (use_gmtime)
+                        gmTime (&time, from_time_t (t));
+                    else
+                        localTime (&time, from_time_t (t));
+
+                    tchar buffer[256];
+                    std::size_t const len = tstrftime (buffer,
+                        sizeof (buffer) / sizeof (buffer[0]), fmt, &time);
+                    CATCH_REQUIRE (TimeFormatter (fmt).format (
+                            from_time_t (t), use_gmtime)
+                        == tstring (buffer, len));
+                }
+    }
+
+    CATCH_SECTION ("log4cplus specific specifiers")
+    {
+        Time const t = time_from_parts (1234567890, 12345);
+        TimeFormatter const formatter (LOG4CPLUS_TEXT ("%s %q %Q"));
+        CATCH_REQUIRE (formatter.format (t, true)
+            == LOG4CPLUS_TEXT ("1234567890 012 012.345"));
+        CATCH_REQUIRE (getFormattedTime (LOG4CPLUS_TEXT ("%s %q %Q"), t, true)
+            == LOG4CPLUS_TEXT ("1234567890 012 012.345"));
+    }
 
-    return tstring (gft_sp.buffer.begin (), gft_sp.buffer.begin () + len);
+    CATCH_SECTION ("trailing percent sign is kept")
+    {
+        CATCH_REQUIRE (TimeFormatter (LOG4CPLUS_TEXT ("%Y%")).format (
+                from_time_t (0), true)
+            == LOG4CPLUS_TEXT ("1970%"));
+    }
+
+    CATCH_SECTION ("specifiers passed to strftime()")
+    {
+        CATCH_REQUIRE (TimeFormatter (LOG4CPLUS_TEXT ("[%U]")).format (
+                from_time_t (0), true)
+            == LOG4CPLUS_TEXT ("[00]"));
+    }
 }
 
+#endif
+
 
 } // namespace log4cplus::helpers
@@ -0,0 +1,118 @@
+#include <log4cplus/socketappender.h>
+#include <log4cplus/helpers/datagramparser.h>
+#include <log4cplus/helpers/socket.h>
+#include <log4cplus/helpers/timehelper.h>
+#include <log4cplus/spi/loggingevent.h>
+#include <log4cplus/initializer.h>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+
+
+using namespace std;
+using namespace log4cplus;
+using namespace log4cplus::helpers;
+
+typedef helpers::chrono::high_resolution_clock hr_clock;
+typedef helpers::chrono::duration<double, std::ratio<1>> sec_dur_type;
+
+
+static
+std::string
+makeSocketDatagram ()
+{
+    spi::InternalLoggingEvent const ev (LOG4CPLUS_TEXT ("flood.socket"),
+        INFO_LOG_LEVEL, LOG4CPLUS_TEXT ("ndc"), MappedDiagnosticContextMap (),
+        LOG4CPLUS_TEXT ("Binary datagram sent by udpflood_test."),
+        LOG4CPLUS_TEXT ("1"), LOG4CPLUS_TEXT ("main"), now (),
+        LOG4CPLUS_TEXT (__FILE__), __LINE__);
+    SocketBuffer buffer (LOG4CPLUS_MAX_MESSAGE_SIZE);
+    convertToBuffer (buffer, ev, tstring ());
+    return std::string (buffer.getBuffer (), buffer.getSize ());
+}
+
+
+static
+std::string
+makeDatagram (std::string const & format)
+{
+    if (format == "syslog")
+        return "<14>1 2026-01-01T00:00:00.000Z localhost udpflood 1 - -"
+            " Syslog datagram sent by udpflood_test.";
+    else if (format == "log4j")
+        return "<log4j:event logger=\"flood.log4j\" level=\"INFO\""
+            " timestamp=\"1767225600000\" thread=\"1\">"
+            "<log4j:message>Log4j datagram sent by udpflood_test."
+            "</log4j:message><log4j:NDC></log4j:NDC>"
+            "<log4j:locationInfo class=\"\" file=\"main.cxx\" method=\"\""
+            " line=\"1\"/></log4j:event>";
+    else if (format == "socket")
+        return makeSocketDatagram ();
+    else
+        return std::string ();
+}
+
+
+int
+main (int argc, char * argv[])
+{
+    log4cplus::Initializer initializer;
+
+    if (argc < 3)
+    {
+        cout << "Usage: host port [count [syslog|log4j|socket]]\n"
+            << "Sends count (100000 by default) datagrams of each or the"
+            " given format to loggingserver started with UDP port.\n"
+            << flush;
+        return 1;
+    }
+
+    tstring const host = LOG4CPLUS_C_STR_TO_TSTRING (argv[1]);
+    unsigned short const port
+        = static_cast<unsigned short>(std::atoi (argv[2]));
+    long const count = argc >= 4 ? std::atol (argv[3]) : 100000;
+    char const * const all_formats[] = { "syslog", "log4j", "socket" };
+
+    Socket socket (host, port, true);
+    if (! socket.isOpen ())
+    {
+        cerr << "Cannot open UDP socket." << endl;
+        return 2;
+    }
+
+    for (char const * format : all_formats)
+    {
+        if (argc >= 5 && std::strcmp (argv[4], format) != 0)
+            continue;
+
+        std::string const datagram = makeDatagram (format);
+        spi::InternalLoggingEvent ev;
+
+        // Parse locally first to report cost of parsing alone.
+        hr_clock::time_point const parse_start = hr_clock::now ();
+        for (long i = 0; i != count; ++i)
+            parseDatagram (ev, datagram);
+        sec_dur_type const parse_time = hr_clock::now () - parse_start;
+
+        hr_clock::time_point const send_start = hr_clock::now ();
+        long sent = 0;
+        for (; sent != count; ++sent)
+            if (! socket.write (datagram))
+                break;
+        sec_dur_type const send_time = hr_clock::now () - send_start;
+
+        cout << format << ": parsed " << count / parse_time.count ()
+            << " datagrams/s, sent " << sent << " datagrams, "
+            << sent / send_time.count () << " datagrams/s" << endl;
+
+        if (sent != count)
+        {
+            cerr << "Sending failed, is loggingserver receiving on UDP port "
+                << port << "?" << endl;
+            return 2;
+        }
+    }
+
+    return 0;
+}